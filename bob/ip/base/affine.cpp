@@ -10,6 +10,11 @@
 
 #include "main.h"
 
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <type_traits>
+
 bob::extension::FunctionDoc s_scale = bob::extension::FunctionDoc(
   "scale",
   "Scales an image.",
@@ -19,27 +24,51 @@ bob::extension::FunctionDoc s_scale = bob::extension::FunctionDoc(
   "1. Given a source image and a scale factor, the scaled image is returned in the size :py:func:`bob.ip.base.scaled_output_shape`\n\n"
   "2. Given source and destination image, the source image is scaled such that it fits into the destination image.\n\n"
   "3. Same as 2., but additionally boolean masks will be read and filled with according values.\n\n"
+  "When downscaling with ``interpolation='area'``, each pixel of the scaled image is the average of all source pixels inside its footprint, weighted by the covered area. "
+  "This avoids aliasing without blurring the source image beforehand. "
+  "In this mode, the outer borders of source and scaled image are aligned, so that, e.g., downscaling by a factor of 0.5 averages blocks of 2x2 pixels; "
+  "a pixel of the scaled image is masked only when all source pixels inside its footprint are masked.\n\n"
   ".. note::\n\n  For 2. and 3., scale factors are computed for both directions independently. "
   "Factually, this means that the image **might be** stretched in either direction, i.e., the aspect ratio is **not** identical for the horizontal and vertical direction. "
   "Even for 1. this might apply, e.g., when ``src.shape * scaling_factor`` does not result in integral values."
 )
-.add_prototype("src, scaling_factor", "dst")
-.add_prototype("src, dst")
-.add_prototype("src, src_mask, dst, dst_mask")
+.add_prototype("src, scaling_factor, [interpolation]", "dst")
+.add_prototype("src, dst, [interpolation]")
+.add_prototype("src, src_mask, dst, dst_mask, [interpolation]")
 .add_parameter("src", "array_like (2D or 3D)", "The input image (gray or colored) that should be scaled")
-.add_parameter("dst", "array_like (2D or 3D, float)", "The resulting scaled gray or color image")
-.add_parameter("src_mask", "array_like (bool, 2D or 3D)", "An input mask of valid pixels before geometric normalization, must be of same size as ``src``")
-.add_parameter("dst_mask", "array_like (bool, 2D or 3D)", "The output mask of valid pixels after geometric normalization, must be of same size as ``dst``")
+.add_parameter("dst", "array_like (2D or 3D, float, float32 or uint8)", "The resulting scaled gray or color image; for ``uint8``, the values are rounded and saturated")
+.add_parameter("src_mask", "array_like (bool, 2D or 3D)", "An input mask of valid pixels before geometric normalization, must be of same size as ``src``; for 3D images, a 2D mask can be shared by all color planes")
+.add_parameter("dst_mask", "array_like (bool, 2D or 3D)", "The output mask of valid pixels after geometric normalization, must be of same size as ``dst``; for 3D images, a 2D mask can be shared by all color planes")
 .add_parameter("scaling_factor", "float", "the scaling factor that should be applied to the image; can be negative, but cannot be ``0.``")
+.add_parameter("interpolation", "str", "[default: ``'bilinear'``] The interpolation to use; possible values: ('bilinear', 'area')")
 .add_return("dst", "array_like (2D, float)", "The resulting scaled image")
 ;
 
-template <typename T, int D>
-static void scale_inner(PyBlitzArrayObject* input, PyBlitzArrayObject* input_mask, PyBlitzArrayObject* output, PyBlitzArrayObject* output_mask) {
-  if (input_mask && output_mask){
-    bob::ip::base::scale<T>(*PyBlitzArrayCxx_AsBlitz<T,D>(input), *PyBlitzArrayCxx_AsBlitz<bool,D>(input_mask), *PyBlitzArrayCxx_AsBlitz<double,D>(output), *PyBlitzArrayCxx_AsBlitz<bool,D>(output_mask));
+/** checks that the mask has the shape of the image, or of its last two dimensions for masks shared by all color planes */
+static bool _mask_fits(PyBlitzArrayObject* image, PyBlitzArrayObject* mask){
+  for (Py_ssize_t d = 1; d <= mask->ndim; ++d)
+    if (mask->shape[mask->ndim-d] != image->shape[image->ndim-d]) return false;
+  return true;
+}
+
+template <typename T, typename U, int D>
+static void scale_inner(PyBlitzArrayObject* input, PyBlitzArrayObject* input_mask, PyBlitzArrayObject* output, PyBlitzArrayObject* output_mask, bob::ip::base::Interpolation interpolation) {
+  if (input_mask && output_mask && D == 3 && input_mask->ndim == 2){
+    // color image with a shared mask
+    bob::ip::base::scale<T,U>(*PyBlitzArrayCxx_AsBlitz<T,3>(input), *PyBlitzArrayCxx_AsBlitz<bool,2>(input_mask), *PyBlitzArrayCxx_AsBlitz<U,3>(output), *PyBlitzArrayCxx_AsBlitz<bool,2>(output_mask), interpolation);
+  } else if (input_mask && output_mask){
+    bob::ip::base::scale<T,U>(*PyBlitzArrayCxx_AsBlitz<T,D>(input), *PyBlitzArrayCxx_AsBlitz<bool,D>(input_mask), *PyBlitzArrayCxx_AsBlitz<U,D>(output), *PyBlitzArrayCxx_AsBlitz<bool,D>(output_mask), interpolation);
   } else {
-    bob::ip::base::scale<T>(*PyBlitzArrayCxx_AsBlitz<T,D>(input), *PyBlitzArrayCxx_AsBlitz<double,D>(output));
+    bob::ip::base::scale<T,U>(*PyBlitzArrayCxx_AsBlitz<T,D>(input), *PyBlitzArrayCxx_AsBlitz<U,D>(output), interpolation);
+  }
+}
+
+template <typename T, int D>
+static void scale_inner1(PyBlitzArrayObject* input, PyBlitzArrayObject* input_mask, PyBlitzArrayObject* output, PyBlitzArrayObject* output_mask, bob::ip::base::Interpolation interpolation) {
+  switch (output->type_num){
+    case NPY_FLOAT32: scale_inner<T,float,D>(input, input_mask, output, output_mask, interpolation); break;
+    case NPY_UINT8:   scale_inner<T,uint8_t,D>(input, input_mask, output, output_mask, interpolation); break;
+    default:          scale_inner<T,double,D>(input, input_mask, output, output_mask, interpolation); break;
   }
 }
 
@@ -55,24 +84,25 @@ PyObject* PyBobIpBase_scale(PyObject*, PyObject* args, PyObject* kwargs) {
 
   PyBlitzArrayObject* src,* src_mask = 0,* dst = 0,* dst_mask = 0;
   double scale_factor = 0;
-  if (nargs == 4){
+  const char* interpolation = "bilinear";
+  if (nargs == 4 || nargs == 5){
     // with masks
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&O&O&O&", kwlist3, &PyBlitzArray_Converter, &src, &PyBlitzArray_Converter, &src_mask, &PyBlitzArray_OutputConverter, &dst, &PyBlitzArray_OutputConverter, &dst_mask)) return 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&O&O&O&|s", kwlist3, &PyBlitzArray_Converter, &src, &PyBlitzArray_Converter, &src_mask, &PyBlitzArray_OutputConverter, &dst, &PyBlitzArray_OutputConverter, &dst_mask, &interpolation)) return 0;
   }
-  else if (nargs == 2){
+  else if (nargs == 2 || nargs == 3){
     PyObject* k = Py_BuildValue("s", kwlist1[1]);
     auto k_ = make_safe(k);
     // check second parameter
-    if ((args && PyTuple_Size(args) == 2 && (PyInt_Check(PyTuple_GET_ITEM(args,1)) || PyFloat_Check(PyTuple_GET_ITEM(args,1)))) || (kwargs && PyDict_Contains(kwargs, k))){
+    if ((args && PyTuple_Size(args) >= 2 && (PyInt_Check(PyTuple_GET_ITEM(args,1)) || PyFloat_Check(PyTuple_GET_ITEM(args,1)))) || (kwargs && PyDict_Contains(kwargs, k))){
       // with scale
-      if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&d", kwlist1, &PyBlitzArray_Converter, &src, &scale_factor)) return 0;
+      if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&d|s", kwlist1, &PyBlitzArray_Converter, &src, &scale_factor, &interpolation)) return 0;
       if (!scale_factor){
         PyErr_SetString(PyExc_ValueError, "scaling with a scale factor of 0. is not supported.");
         return 0;
       }
     } else {
       // with input and output
-      if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&O&", kwlist2, &PyBlitzArray_Converter, &src, &PyBlitzArray_OutputConverter, &dst)) return 0;
+      if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&O&|s", kwlist2, &PyBlitzArray_Converter, &src, &PyBlitzArray_OutputConverter, &dst, &interpolation)) return 0;
     }
   }
   else{
@@ -93,8 +123,8 @@ PyObject* PyBobIpBase_scale(PyObject*, PyObject* args, PyObject* kwargs) {
       PyErr_Format(PyExc_TypeError, "scale: the src and dst array must have the same number of dimensions");
       return 0;
     }
-    if (dst->type_num != NPY_FLOAT64){
-      PyErr_Format(PyExc_TypeError, "scale: the dst array must be of type float64");
+    if (dst->type_num != NPY_FLOAT64 && dst->type_num != NPY_FLOAT32 && dst->type_num != NPY_UINT8){
+      PyErr_Format(PyExc_TypeError, "scale: the dst array must be of type float64, float32 or uint8");
       return 0;
     }
   } else {
@@ -121,15 +151,22 @@ PyObject* PyBobIpBase_scale(PyObject*, PyObject* args, PyObject* kwargs) {
     dst_ = make_safe(dst);
   }
 
-  if (src_mask && dst_mask && ((src_mask->ndim != src->ndim || src_mask->type_num != NPY_BOOL) || dst_mask->ndim != dst->ndim || dst_mask->type_num != NPY_BOOL)) {
-    PyErr_Format(PyExc_TypeError, "scale: the masks must be of boolean type and have the same dimensions as src or dst images.");
+  // 3D images can share a single 2D mask for all color planes
+  bool shared_mask = src_mask && dst_mask && src->ndim == 3 && src_mask->ndim == 2 && dst_mask->ndim == 2;
+  if (src_mask && dst_mask && ((!shared_mask && (src_mask->ndim != src->ndim || dst_mask->ndim != dst->ndim)) || src_mask->type_num != NPY_BOOL || dst_mask->type_num != NPY_BOOL)) {
+    PyErr_Format(PyExc_TypeError, "scale: the masks must be of boolean type and have the same dimensions as src or dst images (or be 2D for 3D images).");
+    return 0;
+  }
+  if (src_mask && dst_mask && (!_mask_fits(src, src_mask) || !_mask_fits(dst, dst_mask))) {
+    PyErr_Format(PyExc_ValueError, "scale: the masks must have the same shape as src or dst images (or as their last two dimensions for 3D images).");
     return 0;
   }
 
+  auto i = interpolation_from_string(interpolation);
   switch (src->type_num){
-    case NPY_UINT8:   if (src->ndim == 2) scale_inner<uint8_t,2>(src, src_mask, dst, dst_mask);  else scale_inner<uint8_t,3>(src, src_mask, dst, dst_mask); break;
-    case NPY_UINT16:  if (src->ndim == 2) scale_inner<uint16_t,2>(src, src_mask, dst, dst_mask); else scale_inner<uint16_t,3>(src, src_mask, dst, dst_mask); break;
-    case NPY_FLOAT64: if (src->ndim == 2) scale_inner<double,2>(src, src_mask, dst, dst_mask);   else scale_inner<double,3>(src, src_mask, dst, dst_mask); break;
+    case NPY_UINT8:   if (src->ndim == 2) scale_inner1<uint8_t,2>(src, src_mask, dst, dst_mask, i);  else scale_inner1<uint8_t,3>(src, src_mask, dst, dst_mask, i); break;
+    case NPY_UINT16:  if (src->ndim == 2) scale_inner1<uint16_t,2>(src, src_mask, dst, dst_mask, i); else scale_inner1<uint16_t,3>(src, src_mask, dst, dst_mask, i); break;
+    case NPY_FLOAT64: if (src->ndim == 2) scale_inner1<double,2>(src, src_mask, dst, dst_mask, i);   else scale_inner1<double,3>(src, src_mask, dst, dst_mask, i); break;
     default:
       PyErr_Format(PyExc_TypeError, "scale: src arrays of type %s are currently not supported", PyBlitzArray_TypenumAsString(src->type_num));
       return 0;
@@ -200,25 +237,41 @@ bob::extension::FunctionDoc s_rotate = bob::extension::FunctionDoc(
   "1. Given a source image and a rotation angle, the rotated image is returned in the size :py:func:`bob.ip.base.rotated_output_shape`\n\n"
   "2. Given source and destination image and the rotation angle, the source image is rotated and filled into the destination image.\n\n"
   "3. Same as 2., but additionally boolean masks will be read and filled with according values.\n\n"
+  "Optionally, the rotated image can be traversed in square tiles of ``tile_size`` pixels, so that the required source pixels of each tile stay in the cache. "
+  "The result is identical to the default row by row traversal. "
+  "Only for very large images, and mainly for angles close to 90 degrees, this might be faster.\n\n"
   ".. note::\n\n  Since the implementation uses a different interpolation style than before, results might *slightly* differ."
 )
-.add_prototype("src, rotation_angle", "dst")
-.add_prototype("src, dst, rotation_angle")
-.add_prototype("src, src_mask, dst, dst_mask, rotation_angle")
+.add_prototype("src, rotation_angle, [tile_size]", "dst")
+.add_prototype("src, dst, rotation_angle, [tile_size]")
+.add_prototype("src, src_mask, dst, dst_mask, rotation_angle, [tile_size]")
 .add_parameter("src", "array_like (2D or 3D)", "The input image (gray or colored) that should be rotated")
-.add_parameter("dst", "array_like (2D or 3D, float)", "The resulting scaled gray or color image, should be in size :py:func:`bob.ip.base.rotated_output_shape`")
-.add_parameter("src_mask", "array_like (bool, 2D or 3D)", "An input mask of valid pixels before geometric normalization, must be of same size as ``src``")
-.add_parameter("dst_mask", "array_like (bool, 2D or 3D)", "The output mask of valid pixels after geometric normalization, must be of same size as ``dst``")
+.add_parameter("dst", "array_like (2D or 3D, float, float32 or uint8)", "The resulting rotated gray or color image, should be in size :py:func:`bob.ip.base.rotated_output_shape`; for ``uint8``, the values are rounded and saturated")
+.add_parameter("src_mask", "array_like (bool, 2D or 3D)", "An input mask of valid pixels before geometric normalization, must be of same size as ``src``; for 3D images, a 2D mask can be shared by all color planes")
+.add_parameter("dst_mask", "array_like (bool, 2D or 3D)", "The output mask of valid pixels after geometric normalization, must be of same size as ``dst``; for 3D images, a 2D mask can be shared by all color planes")
 .add_parameter("rotation_angle", "float", "the rotation angle that should be applied to the image")
+.add_parameter("tile_size", "int", "[default: 0] If positive, the rotated image is computed in square tiles of this size (e.g. 64) instead of row by row")
 .add_return("dst", "array_like (2D, float)", "The resulting rotated image")
 ;
 
-template <typename T, int D>
-static void rotate_inner(PyBlitzArrayObject* input, PyBlitzArrayObject* input_mask, PyBlitzArrayObject* output, PyBlitzArrayObject* output_mask, double angle) {
-  if (input_mask && output_mask){
-    bob::ip::base::rotate<T>(*PyBlitzArrayCxx_AsBlitz<T,D>(input), *PyBlitzArrayCxx_AsBlitz<bool,D>(input_mask), *PyBlitzArrayCxx_AsBlitz<double,D>(output), *PyBlitzArrayCxx_AsBlitz<bool,D>(output_mask), angle);
+template <typename T, typename U, int D>
+static void rotate_inner(PyBlitzArrayObject* input, PyBlitzArrayObject* input_mask, PyBlitzArrayObject* output, PyBlitzArrayObject* output_mask, double angle, int tile_size) {
+  if (input_mask && output_mask && D == 3 && input_mask->ndim == 2){
+    // color image with a shared mask
+    bob::ip::base::rotate<T,U>(*PyBlitzArrayCxx_AsBlitz<T,3>(input), *PyBlitzArrayCxx_AsBlitz<bool,2>(input_mask), *PyBlitzArrayCxx_AsBlitz<U,3>(output), *PyBlitzArrayCxx_AsBlitz<bool,2>(output_mask), angle, tile_size);
+  } else if (input_mask && output_mask){
+    bob::ip::base::rotate<T,U>(*PyBlitzArrayCxx_AsBlitz<T,D>(input), *PyBlitzArrayCxx_AsBlitz<bool,D>(input_mask), *PyBlitzArrayCxx_AsBlitz<U,D>(output), *PyBlitzArrayCxx_AsBlitz<bool,D>(output_mask), angle, tile_size);
   } else {
-    bob::ip::base::rotate<T>(*PyBlitzArrayCxx_AsBlitz<T,D>(input), *PyBlitzArrayCxx_AsBlitz<double,D>(output), angle);
+    bob::ip::base::rotate<T,U>(*PyBlitzArrayCxx_AsBlitz<T,D>(input), *PyBlitzArrayCxx_AsBlitz<U,D>(output), angle, tile_size);
+  }
+}
+
+template <typename T, int D>
+static void rotate_inner1(PyBlitzArrayObject* input, PyBlitzArrayObject* input_mask, PyBlitzArrayObject* output, PyBlitzArrayObject* output_mask, double angle, int tile_size) {
+  switch (output->type_num){
+    case NPY_FLOAT32: rotate_inner<T,float,D>(input, input_mask, output, output_mask, angle, tile_size); break;
+    case NPY_UINT8:   rotate_inner<T,uint8_t,D>(input, input_mask, output, output_mask, angle, tile_size); break;
+    default:          rotate_inner<T,double,D>(input, input_mask, output, output_mask, angle, tile_size); break;
   }
 }
 
@@ -234,15 +287,25 @@ PyObject* PyBobIpBase_rotate(PyObject*, PyObject* args, PyObject* kwargs) {
 
   PyBlitzArrayObject* src,* src_mask = 0,* dst = 0,* dst_mask = 0;
   double angle = 0.;
+  int tile_size = 0;
+  PyObject* k = Py_BuildValue("s", "tile_size");
+  auto k_ = make_safe(k);
   switch (nargs){
     case 2: // src and angle; create the destination afterwards
-      if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&d", kwlist1, &PyBlitzArray_Converter, &src, &angle)) return 0;
+      if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&d|i", kwlist1, &PyBlitzArray_Converter, &src, &angle, &tile_size)) return 0;
       break;
-    case 3: // src, dst and angle
-      if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&O&d", kwlist2, &PyBlitzArray_Converter, &src, &PyBlitzArray_OutputConverter, &dst, &angle)) return 0;
+    case 3: // src, angle and tile size, or src, dst and angle
+      if ((args && PyTuple_Size(args) >= 2 && (PyInt_Check(PyTuple_GET_ITEM(args,1)) || PyFloat_Check(PyTuple_GET_ITEM(args,1)))) || (kwargs && PyDict_Contains(kwargs, k))){
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&d|i", kwlist1, &PyBlitzArray_Converter, &src, &angle, &tile_size)) return 0;
+        break;
+      }
+      // src, dst and angle: fall through
+    case 4: // src, dst, angle and tile size
+      if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&O&d|i", kwlist2, &PyBlitzArray_Converter, &src, &PyBlitzArray_OutputConverter, &dst, &angle, &tile_size)) return 0;
       break;
-    case 5: // src, dst and angle
-      if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&O&O&O&d", kwlist3, &PyBlitzArray_Converter, &src, &PyBlitzArray_Converter, &src_mask, &PyBlitzArray_OutputConverter, &dst, &PyBlitzArray_OutputConverter, &dst_mask, &angle)) return 0;
+    case 5: // src, src_mask, dst, dst_mask and angle
+    case 6: // src, src_mask, dst, dst_mask, angle and tile size
+      if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&O&O&O&d|i", kwlist3, &PyBlitzArray_Converter, &src, &PyBlitzArray_Converter, &src_mask, &PyBlitzArray_OutputConverter, &dst, &PyBlitzArray_OutputConverter, &dst_mask, &angle, &tile_size)) return 0;
       break;
     default:
       PyErr_Format(PyExc_ValueError, "rotate was called with a wrong number of arguments");
@@ -250,6 +313,8 @@ PyObject* PyBobIpBase_rotate(PyObject*, PyObject* args, PyObject* kwargs) {
   }
 
   auto src_ = make_safe(src), src_mask_ = make_xsafe(src_mask), dst_ = make_xsafe(dst), dst_mask_ = make_xsafe(dst_mask);
+  // the destination is returned, when it is created here
+  const bool return_dst = !dst;
 
   if (src->ndim != 2 && src->ndim != 3){
     PyErr_Format(PyExc_TypeError, "only 2D and 3D images can be scaled");
@@ -262,8 +327,8 @@ PyObject* PyBobIpBase_rotate(PyObject*, PyObject* args, PyObject* kwargs) {
       PyErr_Format(PyExc_TypeError, "rotate: the src and dst array must have the same number of dimensions");
       return 0;
     }
-    if (dst->type_num != NPY_FLOAT64){
-      PyErr_Format(PyExc_TypeError, "rotate: the dst array must be of type float64");
+    if (dst->type_num != NPY_FLOAT64 && dst->type_num != NPY_FLOAT32 && dst->type_num != NPY_UINT8){
+      PyErr_Format(PyExc_TypeError, "rotate: the dst array must be of type float64, float32 or uint8");
       return 0;
     }
   } else {
@@ -290,21 +355,27 @@ PyObject* PyBobIpBase_rotate(PyObject*, PyObject* args, PyObject* kwargs) {
     dst_ = make_safe(dst);
   }
 
-  if (src_mask && dst_mask && ((src_mask->ndim != src->ndim || src_mask->type_num != NPY_BOOL) || dst_mask->ndim != dst->ndim || dst_mask->type_num != NPY_BOOL)) {
-    PyErr_Format(PyExc_TypeError, "rotate: the masks must be of boolean type and have the same dimensions as src or dst images.");
+  // 3D images can share a single 2D mask for all color planes
+  bool shared_mask = src_mask && dst_mask && src->ndim == 3 && src_mask->ndim == 2 && dst_mask->ndim == 2;
+  if (src_mask && dst_mask && ((!shared_mask && (src_mask->ndim != src->ndim || dst_mask->ndim != dst->ndim)) || src_mask->type_num != NPY_BOOL || dst_mask->type_num != NPY_BOOL)) {
+    PyErr_Format(PyExc_TypeError, "rotate: the masks must be of boolean type and have the same dimensions as src or dst images (or be 2D for 3D images).");
+    return 0;
+  }
+  if (src_mask && dst_mask && (!_mask_fits(src, src_mask) || !_mask_fits(dst, dst_mask))) {
+    PyErr_Format(PyExc_ValueError, "rotate: the masks must have the same shape as src or dst images (or as their last two dimensions for 3D images).");
     return 0;
   }
 
   switch (src->type_num){
-    case NPY_UINT8:   if (src->ndim == 2) rotate_inner<uint8_t,2>(src, src_mask, dst, dst_mask, angle);  else rotate_inner<uint8_t,3>(src, src_mask, dst, dst_mask, angle); break;
-    case NPY_UINT16:  if (src->ndim == 2) rotate_inner<uint16_t,2>(src, src_mask, dst, dst_mask, angle); else rotate_inner<uint16_t,3>(src, src_mask, dst, dst_mask, angle); break;
-    case NPY_FLOAT64: if (src->ndim == 2) rotate_inner<double,2>(src, src_mask, dst, dst_mask, angle);   else rotate_inner<double,3>(src, src_mask, dst, dst_mask, angle); break;
+    case NPY_UINT8:   if (src->ndim == 2) rotate_inner1<uint8_t,2>(src, src_mask, dst, dst_mask, angle, tile_size);  else rotate_inner1<uint8_t,3>(src, src_mask, dst, dst_mask, angle, tile_size); break;
+    case NPY_UINT16:  if (src->ndim == 2) rotate_inner1<uint16_t,2>(src, src_mask, dst, dst_mask, angle, tile_size); else rotate_inner1<uint16_t,3>(src, src_mask, dst, dst_mask, angle, tile_size); break;
+    case NPY_FLOAT64: if (src->ndim == 2) rotate_inner1<double,2>(src, src_mask, dst, dst_mask, angle, tile_size);   else rotate_inner1<double,3>(src, src_mask, dst, dst_mask, angle, tile_size); break;
     default:
       PyErr_Format(PyExc_TypeError, "rotate: src arrays of type %s are currently not supported", PyBlitzArray_TypenumAsString(src->type_num));
       return 0;
   }
 
-  if (nargs == 2){
+  if (return_dst){
     return PyBlitzArray_AsNumpyArray(dst,0);
   }
 
@@ -497,3 +568,554 @@ PyObject* PyBobIpBase_extrapolateMask(PyObject*, PyObject* args, PyObject* kwarg
 
   BOB_CATCH_FUNCTION("in extrapolate_mask", 0)
 }
+
+
+// returns the index (..., y, x) of the last two dimensions of a numpy array; steals the references to the slices
+static PyObject* _index(PyObject* y, PyObject* x){
+  auto y_ = make_xsafe(y), x_ = make_xsafe(x);
+  if (!y || !x) return 0;
+  return Py_BuildValue("(OOO)", Py_Ellipsis, y, x);
+}
+
+// returns a view into the given numpy array, indexing the last two dimensions with the given slices; steals the references to the slices
+static PyObject* _view(PyObject* array, PyObject* y, PyObject* x){
+  PyObject* index = _index(y, x);
+  if (!index) return 0;
+  auto index_ = make_safe(index);
+  return PyObject_GetItem(array, index);
+}
+
+// returns a new slice object start:stop
+static PyObject* _slice(Py_ssize_t start, Py_ssize_t stop){
+  PyObject* start_ = Py_BuildValue("n", start),* stop_ = Py_BuildValue("n", stop);
+  auto _1 = make_xsafe(start_), _2 = make_xsafe(stop_);
+  if (!start_ || !stop_) return 0;
+  return PySlice_New(start_, stop_, Py_None);
+}
+
+// returns a new slice object ::-1
+static PyObject* _reversed_slice(){
+  PyObject* step = Py_BuildValue("n", (Py_ssize_t)-1);
+  if (!step) return 0;
+  auto step_ = make_safe(step);
+  return PySlice_New(Py_None, Py_None, step);
+}
+
+// converts an optional input parameter, which might be None
+static int _optional_input(PyObject* o, PyBlitzArrayObject** a){
+  *a = 0;
+  if (!o || o == Py_None) return 1;
+  return PyBlitzArray_Converter(o, a);
+}
+
+// converts an optional output parameter, which might be None
+static int _optional_output(PyObject* o, PyBlitzArrayObject** a){
+  *a = 0;
+  if (!o || o == Py_None) return 1;
+  return PyBlitzArray_OutputConverter(o, a);
+}
+
+// returns whether crop, shift, flip and flop process arrays of the given data type in C++; all other data types (e.g. float16) are processed with numpy
+static bool _native_type(const int type_num){
+  switch (type_num){
+    case NPY_BOOL:
+    case NPY_INT8: case NPY_INT16: case NPY_INT32: case NPY_INT64:
+    case NPY_UINT8: case NPY_UINT16: case NPY_UINT32: case NPY_UINT64:
+    case NPY_FLOAT32: case NPY_FLOAT64:
+    case NPY_COMPLEX64: case NPY_COMPLEX128:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// converts the fill_pattern to the data type of the image; raises a ValueError if the value cannot be represented
+static bool _fill_value(const char* name, PyObject* fill_pattern, bool& value){
+  const int r = PyObject_IsTrue(fill_pattern);
+  if (r < 0) return false;
+  value = r;
+  return true;
+}
+
+template <typename T>
+static typename std::enable_if<std::is_integral<T>::value, bool>::type _fill_value(const char* name, PyObject* fill_pattern, T& value){
+  if (!PyIndex_Check(fill_pattern)){
+    // floating point values are truncated, as in numpy
+    const double d = PyFloat_AsDouble(fill_pattern);
+    if (d == -1. && PyErr_Occurred()) return false;
+    if (!(d > (double)std::numeric_limits<T>::min() - 1. && d < (double)std::numeric_limits<T>::max() + 1.)){
+      PyErr_Format(PyExc_ValueError, "%s: the fill_pattern %g cannot be represented in the data type of src", name, d);
+      return false;
+    }
+    value = static_cast<T>(d);
+    return true;
+  }
+  // integral values are converted without loss of precision
+  PyObject* index = PyNumber_Index(fill_pattern);
+  if (!index) return false;
+  auto index_ = make_safe(index);
+  int overflow;
+  const long long v = PyLong_AsLongLongAndOverflow(index, &overflow);
+  if (v == -1 && PyErr_Occurred()) return false;
+  bool valid;
+  if (overflow > 0){
+    // only uint64 can hold values above the int64 range
+    const unsigned long long u = PyLong_AsUnsignedLongLong(index);
+    const bool error = u == (unsigned long long)-1 && PyErr_Occurred();
+    if (error) PyErr_Clear();
+    valid = !error && u <= (unsigned long long)std::numeric_limits<T>::max();
+    if (valid) value = static_cast<T>(u);
+  } else {
+    valid = !overflow && v >= (long long)std::numeric_limits<T>::min() && (v < 0 || (unsigned long long)v <= (unsigned long long)std::numeric_limits<T>::max());
+    if (valid) value = static_cast<T>(v);
+  }
+  if (!valid){
+    PyErr_Format(PyExc_ValueError, "%s: the integral fill_pattern is out of the range of the data type of src", name);
+    return false;
+  }
+  return true;
+}
+
+template <typename T>
+static typename std::enable_if<std::is_floating_point<T>::value, bool>::type _fill_value(const char* name, PyObject* fill_pattern, T& value){
+  const double d = PyFloat_AsDouble(fill_pattern);
+  if (d == -1. && PyErr_Occurred()) return false;
+  // infinity and NaN can be represented, but finite values must not overflow
+  if (std::isfinite(d) && std::abs(d) > (double)std::numeric_limits<T>::max()){
+    PyErr_Format(PyExc_ValueError, "%s: the fill_pattern %g cannot be represented in the data type of src", name, d);
+    return false;
+  }
+  value = static_cast<T>(d);
+  return true;
+}
+
+template <typename T>
+static bool _fill_value(const char* name, PyObject* fill_pattern, std::complex<T>& value){
+  const Py_complex c = PyComplex_AsCComplex(fill_pattern);
+  if (c.real == -1. && PyErr_Occurred()) return false;
+  if ((std::isfinite(c.real) && std::abs(c.real) > (double)std::numeric_limits<T>::max()) || (std::isfinite(c.imag) && std::abs(c.imag) > (double)std::numeric_limits<T>::max())){
+    PyErr_Format(PyExc_ValueError, "%s: the fill_pattern (%g%+gj) cannot be represented in the data type of src", name, c.real, c.imag);
+    return false;
+  }
+  value = std::complex<T>(static_cast<T>(c.real), static_cast<T>(c.imag));
+  return true;
+}
+
+template <typename T, int N>
+static bool crop_inner(const char* name, PyBlitzArrayObject* src, PyBlitzArrayObject* src_mask, PyBlitzArrayObject* dst, PyBlitzArrayObject* dst_mask, const blitz::TinyVector<int,2>& offset, PyObject* fill_pattern){
+  T fill = T(0);
+  if (fill_pattern && !_fill_value(name, fill_pattern, fill)) return false;
+  if (src_mask && dst_mask)
+    bob::ip::base::crop(*PyBlitzArrayCxx_AsBlitz<T,N>(src), *PyBlitzArrayCxx_AsBlitz<bool,N>(src_mask), *PyBlitzArrayCxx_AsBlitz<T,N>(dst), *PyBlitzArrayCxx_AsBlitz<bool,N>(dst_mask), offset, fill);
+  else
+    bob::ip::base::crop(*PyBlitzArrayCxx_AsBlitz<T,N>(src), *PyBlitzArrayCxx_AsBlitz<T,N>(dst), offset, fill);
+  return true;
+}
+
+template <int N>
+static bool crop_inner1(const char* name, PyBlitzArrayObject* src, PyBlitzArrayObject* src_mask, PyBlitzArrayObject* dst, PyBlitzArrayObject* dst_mask, const blitz::TinyVector<int,2>& offset, PyObject* fill_pattern){
+  switch (src->type_num){
+    case NPY_BOOL:       return crop_inner<bool,N>(name, src, src_mask, dst, dst_mask, offset, fill_pattern);
+    case NPY_INT8:       return crop_inner<int8_t,N>(name, src, src_mask, dst, dst_mask, offset, fill_pattern);
+    case NPY_INT16:      return crop_inner<int16_t,N>(name, src, src_mask, dst, dst_mask, offset, fill_pattern);
+    case NPY_INT32:      return crop_inner<int32_t,N>(name, src, src_mask, dst, dst_mask, offset, fill_pattern);
+    case NPY_INT64:      return crop_inner<int64_t,N>(name, src, src_mask, dst, dst_mask, offset, fill_pattern);
+    case NPY_UINT8:      return crop_inner<uint8_t,N>(name, src, src_mask, dst, dst_mask, offset, fill_pattern);
+    case NPY_UINT16:     return crop_inner<uint16_t,N>(name, src, src_mask, dst, dst_mask, offset, fill_pattern);
+    case NPY_UINT32:     return crop_inner<uint32_t,N>(name, src, src_mask, dst, dst_mask, offset, fill_pattern);
+    case NPY_UINT64:     return crop_inner<uint64_t,N>(name, src, src_mask, dst, dst_mask, offset, fill_pattern);
+    case NPY_FLOAT32:    return crop_inner<float,N>(name, src, src_mask, dst, dst_mask, offset, fill_pattern);
+    case NPY_FLOAT64:    return crop_inner<double,N>(name, src, src_mask, dst, dst_mask, offset, fill_pattern);
+    case NPY_COMPLEX64:  return crop_inner<std::complex<float>,N>(name, src, src_mask, dst, dst_mask, offset, fill_pattern);
+    case NPY_COMPLEX128: return crop_inner<std::complex<double>,N>(name, src, src_mask, dst, dst_mask, offset, fill_pattern);
+    default:
+      throw std::runtime_error((boost::format("src arrays of type %s are currently not supported") % PyBlitzArray_TypenumAsString(src->type_num)).str());
+  }
+}
+
+// crops arrays of data types that are not processed in C++ (see _native_type) with numpy, using numpy's conversion of the fill_pattern
+static bool _crop_numpy(PyObject* src, PyObject* dst, const blitz::TinyVector<int,2>& offset, const blitz::TinyVector<int,2>& size, PyObject* fill_pattern){
+  // the parts of src and dst that overlap
+  const int ndim = PyArray_NDIM(reinterpret_cast<PyArrayObject*>(src));
+  const npy_intp* shape = PyArray_DIMS(reinterpret_cast<PyArrayObject*>(src));
+  blitz::TinyVector<Py_ssize_t,2> src_first, dst_first, count;
+  for (int i = 0; i < 2; ++i){
+    src_first[i] = std::max(offset[i], 0);
+    dst_first[i] = std::max(-offset[i], 0);
+    count[i] = std::max<Py_ssize_t>(std::min<Py_ssize_t>(size[i] - dst_first[i], shape[ndim-2+i] - src_first[i]), 0);
+  }
+
+  PyObject* zero = Py_BuildValue("i", 0);
+  if (!zero) return false;
+  auto zero_ = make_safe(zero);
+  PyObject* r = PyObject_CallMethod(dst, const_cast<char*>("fill"), const_cast<char*>("O"), fill_pattern ? fill_pattern : zero);
+  if (!r) return false;
+  Py_DECREF(r);
+
+  PyObject* view = _view(src, _slice(src_first[0], src_first[0] + count[0]), _slice(src_first[1], src_first[1] + count[1]));
+  if (!view) return false;
+  auto view_ = make_safe(view);
+  PyObject* index = _index(_slice(dst_first[0], dst_first[0] + count[0]), _slice(dst_first[1], dst_first[1] + count[1]));
+  if (!index) return false;
+  auto index_ = make_safe(index);
+  return PyObject_SetItem(dst, index, view) >= 0;
+}
+
+// the implementation of crop and shift; without crop_size and dst, shift uses the size of src
+static PyObject* _crop(const char* name, PyObject* source, const blitz::TinyVector<int,2>& offset, PyObject* crop_size, PyObject* destination, PyObject* source_mask, PyObject* destination_mask, PyObject* fill_pattern, bool shift){
+  PyObject* array = PyArray_FROM_O(source);
+  if (!array) return 0;
+  auto array_ = make_safe(array);
+  const int ndim = PyArray_NDIM(reinterpret_cast<PyArrayObject*>(array));
+  if (ndim != 2 && ndim != 3){
+    PyErr_Format(PyExc_TypeError, "%s: the src must be 2D or 3D", name);
+    return 0;
+  }
+  const npy_intp* shape = PyArray_DIMS(reinterpret_cast<PyArrayObject*>(array));
+  const bool native = _native_type(PyArray_TYPE(reinterpret_cast<PyArrayObject*>(array)));
+
+  // dst is kept as numpy array for data types that are not processed in C++
+  const bool has_dst = destination && destination != Py_None;
+  PyBlitzArrayObject* dst = 0,* src_mask,* dst_mask;
+  if (native && !_optional_output(destination, &dst)) return 0;
+  auto dst_ = make_xsafe(dst);
+  if (has_dst && !native && !PyArray_Check(destination)){
+    PyErr_Format(PyExc_TypeError, "%s: dst must be a numpy.ndarray", name);
+    return 0;
+  }
+  Py_ssize_t dst_shape[3] = {0, 0, 0};
+  const int dst_ndim = !has_dst ? 0 : native ? dst->ndim : PyArray_NDIM(reinterpret_cast<PyArrayObject*>(destination));
+  if (dst_ndim != 2 && dst_ndim != 3 && has_dst){
+    PyErr_Format(PyExc_TypeError, "%s: dst must have the same number of dimensions, number of planes and data type as src", name);
+    return 0;
+  }
+  for (int i = 0; i < dst_ndim; ++i)
+    dst_shape[i] = native ? dst->shape[i] : PyArray_DIMS(reinterpret_cast<PyArrayObject*>(destination))[i];
+
+  if (!_optional_input(source_mask, &src_mask)) return 0;
+  auto src_mask_ = make_xsafe(src_mask);
+  if (!_optional_output(destination_mask, &dst_mask)) return 0;
+  auto dst_mask_ = make_xsafe(dst_mask);
+  if (!src_mask != !dst_mask){
+    PyErr_Format(PyExc_ValueError, "%s: either both src_mask and dst_mask need to be given, or none of them", name);
+    return 0;
+  }
+  const bool masks = src_mask && dst_mask;
+
+  // get the size of the cropped image
+  blitz::TinyVector<int,2> size;
+  if (crop_size && crop_size != Py_None){
+    if (!PyArg_ParseTuple(crop_size, "ii", &size[0], &size[1])) return 0;
+    if (has_dst && (size[0] != dst_shape[dst_ndim-2] || size[1] != dst_shape[dst_ndim-1])){
+      PyErr_Format(PyExc_RuntimeError, "%s: the crop_size (%d, %d) differs from the shape of dst", name, size[0], size[1]);
+      return 0;
+    }
+  } else if (has_dst){
+    size = blitz::TinyVector<int,2>(dst_shape[dst_ndim-2], dst_shape[dst_ndim-1]);
+  } else if (shift){
+    size = blitz::TinyVector<int,2>(shape[ndim-2], shape[ndim-1]);
+  } else {
+    PyErr_Format(PyExc_TypeError, "%s: either the crop_size or dst needs to be specified", name);
+    return 0;
+  }
+  if (size[0] < 0 || size[1] < 0){
+    PyErr_Format(PyExc_RuntimeError, "%s: the crop_size (%d, %d) must not be negative", name, size[0], size[1]);
+    return 0;
+  }
+
+  // when no copy is requested and the cropped area is inside the source image, return a view
+  if (!has_dst && !masks && offset[0] >= 0 && offset[1] >= 0 && offset[0] + size[0] <= shape[ndim-2] && offset[1] + size[1] <= shape[ndim-1]){
+    return _view(array, _slice(offset[0], offset[0] + size[0]), _slice(offset[1], offset[1] + size[1]));
+  }
+
+  if (has_dst && (dst_ndim != ndim || (ndim == 3 && dst_shape[0] != shape[0]))){
+    PyErr_Format(PyExc_TypeError, "%s: dst must have the same number of dimensions, number of planes and data type as src", name);
+    return 0;
+  }
+
+  if (masks){
+    if (src_mask->ndim != ndim || dst_mask->ndim != ndim || src_mask->type_num != NPY_BOOL || dst_mask->type_num != NPY_BOOL){
+      PyErr_Format(PyExc_TypeError, "%s: the masks must be of boolean type and have the same shape as src and dst", name);
+      return 0;
+    }
+  }
+
+  PyObject* result;
+  if (native){
+    PyBlitzArrayObject* src;
+    if (!PyBlitzArray_Converter(array, &src)) return 0;
+    auto src_ = make_safe(src);
+
+    if (dst){
+      if (dst->type_num != src->type_num){
+        PyErr_Format(PyExc_TypeError, "%s: dst must have the same number of dimensions, number of planes and data type as src", name);
+        return 0;
+      }
+    } else {
+      Py_ssize_t n[] = {src->shape[0], size[0], size[1]};
+      if (ndim == 2){
+        n[0] = size[0]; n[1] = size[1];
+      }
+      dst = reinterpret_cast<PyBlitzArrayObject*>(PyBlitzArray_SimpleNew(src->type_num, ndim, n));
+      if (!dst) return 0;
+      dst_ = make_safe(dst);
+    }
+
+    bool success = false;
+    switch (ndim){
+      case 2: success = crop_inner1<2>(name, src, masks ? src_mask : 0, dst, masks ? dst_mask : 0, offset, fill_pattern); break;
+      case 3: success = crop_inner1<3>(name, src, masks ? src_mask : 0, dst, masks ? dst_mask : 0, offset, fill_pattern); break;
+      default: break; // already handled
+    }
+    if (!success) return 0;
+    if (has_dst){
+      Py_INCREF(destination);
+      return destination;
+    }
+    return PyBlitzArray_AsNumpyArray(dst, 0);
+  }
+
+  // other data types are processed with numpy, only the masks are cropped in C++
+  PyArray_Descr* descr = PyArray_DESCR(reinterpret_cast<PyArrayObject*>(array));
+  if (has_dst){
+    if (!PyArray_EquivTypes(PyArray_DESCR(reinterpret_cast<PyArrayObject*>(destination)), descr)){
+      PyErr_Format(PyExc_TypeError, "%s: dst must have the same number of dimensions, number of planes and data type as src", name);
+      return 0;
+    }
+    result = destination;
+    Py_INCREF(result);
+  } else {
+    npy_intp n[] = {shape[0], size[0], size[1]};
+    if (ndim == 2){
+      n[0] = size[0]; n[1] = size[1];
+    }
+    Py_INCREF(descr);
+    result = PyArray_Empty(ndim, n, descr, 0);
+    if (!result) return 0;
+  }
+  auto result_ = make_safe(result);
+  if (!_crop_numpy(array, result, offset, size, fill_pattern)) return 0;
+  if (masks){
+    const bool success = ndim == 2
+      ? crop_inner<bool,2>(name, src_mask, 0, dst_mask, 0, offset, Py_False)
+      : crop_inner<bool,3>(name, src_mask, 0, dst_mask, 0, offset, Py_False);
+    if (!success) return 0;
+  }
+  Py_INCREF(result);
+  return result;
+}
+
+
+bob::extension::FunctionDoc s_crop = bob::extension::FunctionDoc(
+  "crop",
+  "Crops the given image ``src`` image to the given offset (might be negative) and to the given size (might be greater than ``src`` image).",
+  "Either ``crop_size`` or ``dst`` need to be specified. "
+  "When masks are given, they need to be of the same size as the ``src`` and ``dst`` parameters. "
+  "When crop regions are outside the image, the cropped image will contain ``fill_pattern`` and the mask will be set to ``False``.\n\n"
+  "Images of data types other than bool, (unsigned) integers, float32, float64, complex64 and complex128 (e.g., float16) are cropped with numpy, which converts the ``fill_pattern`` with its own casting rules.\n\n"
+  ".. note::\n\n  When neither ``dst`` nor masks are given and the cropped area lies inside ``src``, a view into ``src`` is returned, i.e., no data is copied. "
+  "Modifying the returned array will then modify ``src``; use ``crop(...).copy()`` to avoid that."
+)
+.add_prototype("src, crop_offset, [crop_size], [dst], [src_mask], [dst_mask], [fill_pattern]", "dst")
+.add_parameter("src", "array_like (2D or 3D)", "The source image to crop")
+.add_parameter("crop_offset", "(int, int)", "The position in ``src`` coordinates to start cropping; might be negative")
+.add_parameter("crop_size", "(int, int)", "The size of the cropped image; might be omitted when the ``dst`` is given")
+.add_parameter("dst", "array_like (2D or 3D)", "If given, the destination to crop ``src`` to; must have the same data type as ``src``")
+.add_parameter("src_mask", "array_like (bool, 2D or 3D)", "A mask that defines, where ``src`` is valid; must have the same shape as ``src``")
+.add_parameter("dst_mask", "array_like (bool, 2D or 3D)", "The mask that will define, where ``dst`` is valid; must have the same shape as ``dst``")
+.add_parameter("fill_pattern", "number", "[default: 0] The value to set outside the croppable area; a ValueError is raised if it cannot be represented in the data type of ``src``")
+.add_return("dst", "array_like (2D or 3D)", "The cropped image")
+;
+
+PyObject* PyBobIpBase_crop(PyObject*, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+  char** kwlist = s_crop.kwlist();
+
+  PyObject* src,* size = 0,* dst = 0,* src_mask = 0,* dst_mask = 0;
+  blitz::TinyVector<int,2> offset;
+  PyObject* fill_pattern = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O(ii)|OOOOO", kwlist, &src, &offset[0], &offset[1], &size, &dst, &src_mask, &dst_mask, &fill_pattern)){
+    s_crop.print_usage();
+    return 0;
+  }
+
+  return _crop("crop", src, offset, size, dst, src_mask, dst_mask, fill_pattern, false);
+
+  BOB_CATCH_FUNCTION("in crop", 0)
+}
+
+
+bob::extension::FunctionDoc s_shift = bob::extension::FunctionDoc(
+  "shift",
+  "Shifts the given image ``src`` image with the given offset (might be negative).",
+  "If ``dst`` is specified, the image is shifted into the ``dst`` image. "
+  "Ideally, ``dst`` should have the same size as ``src``, but other sizes work as well. "
+  "When ``dst`` is ``None`` (the default), it is created in the same size as ``src``. "
+  "When masks are given, they need to be of the same size as the ``src`` and ``dst`` parameters. "
+  "When shift to regions are outside the image, the shifted image will contain ``fill_pattern`` and the mask will be set to ``False``.\n\n"
+  ".. note::\n\n  When neither ``dst`` nor masks are given and the offset is ``(0, 0)``, a view into ``src`` is returned."
+)
+.add_prototype("src, offset, [dst], [src_mask], [dst_mask], [fill_pattern]", "dst")
+.add_parameter("src", "array_like (2D or 3D)", "The source image to shift")
+.add_parameter("offset", "(int, int)", "The position in ``src`` coordinates that will be shifted to the upper left corner of ``dst``; might be negative")
+.add_parameter("dst", "array_like (2D or 3D)", "If given, the destination to shift ``src`` to; must have the same data type as ``src``")
+.add_parameter("src_mask", "array_like (bool, 2D or 3D)", "A mask that defines, where ``src`` is valid; must have the same shape as ``src``")
+.add_parameter("dst_mask", "array_like (bool, 2D or 3D)", "The mask that will define, where ``dst`` is valid; must have the same shape as ``dst``")
+.add_parameter("fill_pattern", "number", "[default: 0] The value to set outside the shifted area; a ValueError is raised if it cannot be represented in the data type of ``src``")
+.add_return("dst", "array_like (2D or 3D)", "The shifted image")
+;
+
+PyObject* PyBobIpBase_shift(PyObject*, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+  char** kwlist = s_shift.kwlist();
+
+  PyObject* src,* dst = 0,* src_mask = 0,* dst_mask = 0;
+  blitz::TinyVector<int,2> offset;
+  PyObject* fill_pattern = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O(ii)|OOOO", kwlist, &src, &offset[0], &offset[1], &dst, &src_mask, &dst_mask, &fill_pattern)){
+    s_shift.print_usage();
+    return 0;
+  }
+
+  return _crop("shift", src, offset, 0, dst, src_mask, dst_mask, fill_pattern, true);
+
+  BOB_CATCH_FUNCTION("in shift", 0)
+}
+
+
+template <typename T, int N>
+static void flip_inner(PyBlitzArrayObject* src, PyBlitzArrayObject* dst, bool flop){
+  if (flop) bob::ip::base::flop(*PyBlitzArrayCxx_AsBlitz<T,N>(src), *PyBlitzArrayCxx_AsBlitz<T,N>(dst));
+  else bob::ip::base::flip(*PyBlitzArrayCxx_AsBlitz<T,N>(src), *PyBlitzArrayCxx_AsBlitz<T,N>(dst));
+}
+
+template <int N>
+static void flip_inner1(PyBlitzArrayObject* src, PyBlitzArrayObject* dst, bool flop){
+  switch (src->type_num){
+    case NPY_BOOL:       flip_inner<bool,N>(src, dst, flop); break;
+    case NPY_INT8:       flip_inner<int8_t,N>(src, dst, flop); break;
+    case NPY_INT16:      flip_inner<int16_t,N>(src, dst, flop); break;
+    case NPY_INT32:      flip_inner<int32_t,N>(src, dst, flop); break;
+    case NPY_INT64:      flip_inner<int64_t,N>(src, dst, flop); break;
+    case NPY_UINT8:      flip_inner<uint8_t,N>(src, dst, flop); break;
+    case NPY_UINT16:     flip_inner<uint16_t,N>(src, dst, flop); break;
+    case NPY_UINT32:     flip_inner<uint32_t,N>(src, dst, flop); break;
+    case NPY_UINT64:     flip_inner<uint64_t,N>(src, dst, flop); break;
+    case NPY_FLOAT32:    flip_inner<float,N>(src, dst, flop); break;
+    case NPY_FLOAT64:    flip_inner<double,N>(src, dst, flop); break;
+    case NPY_COMPLEX64:  flip_inner<std::complex<float>,N>(src, dst, flop); break;
+    case NPY_COMPLEX128: flip_inner<std::complex<double>,N>(src, dst, flop); break;
+    default:
+      throw std::runtime_error((boost::format("src arrays of type %s are currently not supported") % PyBlitzArray_TypenumAsString(src->type_num)).str());
+  }
+}
+
+// the implementation of flip and flop
+static PyObject* _flip(const char* name, PyObject* source, PyObject* destination, bool flop){
+  PyObject* array = PyArray_FROM_O(source);
+  if (!array) return 0;
+  auto array_ = make_safe(array);
+  const int ndim = PyArray_NDIM(reinterpret_cast<PyArrayObject*>(array));
+  if (ndim != 2 && ndim != 3){
+    PyErr_Format(PyExc_TypeError, "%s: the src must be 2D or 3D", name);
+    return 0;
+  }
+
+  // without dst, return a view with negative strides
+  if (!destination || destination == Py_None){
+    if (flop) return _view(array, PySlice_New(0, 0, 0), _reversed_slice());
+    return _view(array, _reversed_slice(), PySlice_New(0, 0, 0));
+  }
+
+  if (!_native_type(PyArray_TYPE(reinterpret_cast<PyArrayObject*>(array)))){
+    // numpy copies overlapping arrays correctly
+    if (!PyArray_Check(destination) || PyArray_NDIM(reinterpret_cast<PyArrayObject*>(destination)) != ndim || !PyArray_EquivTypes(PyArray_DESCR(reinterpret_cast<PyArrayObject*>(destination)), PyArray_DESCR(reinterpret_cast<PyArrayObject*>(array)))){
+      PyErr_Format(PyExc_TypeError, "%s: dst must have the same number of dimensions and data type as src", name);
+      return 0;
+    }
+    PyObject* view = flop ? _view(array, PySlice_New(0, 0, 0), _reversed_slice()) : _view(array, _reversed_slice(), PySlice_New(0, 0, 0));
+    if (!view) return 0;
+    auto view_ = make_safe(view);
+    if (PyObject_SetItem(destination, Py_Ellipsis, view) < 0) return 0;
+    Py_INCREF(destination);
+    return destination;
+  }
+
+  PyBlitzArrayObject* src,* dst;
+  if (!PyBlitzArray_Converter(array, &src)) return 0;
+  auto src_ = make_safe(src);
+  if (!PyBlitzArray_OutputConverter(destination, &dst)) return 0;
+  auto dst_ = make_safe(dst);
+
+  if (dst->ndim != src->ndim || dst->type_num != src->type_num){
+    PyErr_Format(PyExc_TypeError, "%s: dst must have the same number of dimensions and data type as src", name);
+    return 0;
+  }
+
+  switch (ndim){
+    case 2: flip_inner1<2>(src, dst, flop); break;
+    case 3: flip_inner1<3>(src, dst, flop); break;
+    default: break; // already handled
+  }
+
+  Py_INCREF(destination);
+  return destination;
+}
+
+bob::extension::FunctionDoc s_flip = bob::extension::FunctionDoc(
+  "flip",
+  "Flip a 2D or 3D array/image upside-down.",
+  "If given, the destination array ``dst`` should have the same size and type as the source array.\n\n"
+  ".. note::\n\n  When ``dst`` is not given, a view into ``src`` with negative strides is returned, i.e., no data is copied. "
+  "Modifying the returned array will then modify ``src``; use ``flip(src).copy()`` to avoid that."
+)
+.add_prototype("src, [dst]", "dst")
+.add_parameter("src", "array_like (2D or 3D)", "The source image to flip")
+.add_parameter("dst", "array_like (2D or 3D)", "If given, the destination to flip ``src`` to")
+.add_return("dst", "array_like (2D or 3D)", "The flipped image")
+;
+
+PyObject* PyBobIpBase_flip(PyObject*, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+  char** kwlist = s_flip.kwlist();
+
+  PyObject* src,* dst = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", kwlist, &src, &dst)){
+    s_flip.print_usage();
+    return 0;
+  }
+
+  return _flip("flip", src, dst, false);
+
+  BOB_CATCH_FUNCTION("in flip", 0)
+}
+
+bob::extension::FunctionDoc s_flop = bob::extension::FunctionDoc(
+  "flop",
+  "Flip a 2D or 3D array/image left-right.",
+  "If given, the destination array ``dst`` should have the same size and type as the source array.\n\n"
+  ".. note::\n\n  When ``dst`` is not given, a view into ``src`` with negative strides is returned, i.e., no data is copied. "
+  "Modifying the returned array will then modify ``src``; use ``flop(src).copy()`` to avoid that."
+)
+.add_prototype("src, [dst]", "dst")
+.add_parameter("src", "array_like (2D or 3D)", "The source image to flip")
+.add_parameter("dst", "array_like (2D or 3D)", "If given, the destination to flip ``src`` to")
+.add_return("dst", "array_like (2D or 3D)", "The flipped image")
+;
+
+PyObject* PyBobIpBase_flop(PyObject*, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+  char** kwlist = s_flop.kwlist();
+
+  PyObject* src,* dst = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", kwlist, &src, &dst)){
+    s_flop.print_usage();
+    return 0;
+  }
+
+  return _flip("flop", src, dst, true);
+
+  BOB_CATCH_FUNCTION("in flop", 0)
+}
@@ -64,5 +64,24 @@ bool bob::ip::base::FaceEyesNorm::operator!=(const bob::ip::base::FaceEyesNorm&
   return !(this->operator==(b));
 }
 
+void bob::ip::base::FaceEyesNorm::configure(
+    GeomNorm& geomNorm,
+    blitz::TinyVector<double,2>& center,
+    const blitz::TinyVector<double,2>& rightEye,
+    const blitz::TinyVector<double,2>& leftEye
+) const
+{
+  // Get angle to horizontal
+  double dy = leftEye[0] - rightEye[0], dx = leftEye[1] - rightEye[1];
+  double angle = std::atan2(dy, dx);
+  geomNorm.setRotationAngle(angle * 180. / M_PI - m_eyesAngle);
 
+  // Get scaling factor
+  geomNorm.setScalingFactor(m_eyesDistance / sqrt(_sqr(leftEye[0]-rightEye[0]) + _sqr(leftEye[1]-rightEye[1])));
 
+  // Get the center (of the eye centers segment)
+  center = blitz::TinyVector<double,2>(
+    (rightEye[0] + leftEye[0]) / 2.,
+    (rightEye[1] + leftEye[1]) / 2.
+  );
+}
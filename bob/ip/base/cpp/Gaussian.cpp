@@ -9,15 +9,19 @@
 
 
 #include <bob.ip.base/Gaussian.h>
+#include <bob.ip.base/Parallel.h>
+#include <bob.ip.base/Border.h>
 
 bob::ip::base::Gaussian::Gaussian(
   const size_t radius_y, const size_t radius_x,
   const double sigma_y, const double sigma_x,
-  const bob::sp::Extrapolation::BorderType border_type
+  const bob::sp::Extrapolation::BorderType border_type,
+  const GaussianMode mode
 ):
   m_radius_y(radius_y), m_radius_x(radius_x),
   m_sigma_y(sigma_y), m_sigma_x(sigma_x),
-  m_conv_border(border_type)
+  m_conv_border(border_type),
+  m_mode(mode)
 {
   computeKernel();
 }
@@ -27,12 +31,30 @@ bob::ip::base::Gaussian::Gaussian(const Gaussian& other)
 :
   m_radius_y(other.m_radius_y), m_radius_x(other.m_radius_x),
   m_sigma_y(other.m_sigma_y), m_sigma_x(other.m_sigma_x),
-  m_conv_border(other.m_conv_border)
+  m_conv_border(other.m_conv_border),
+  m_mode(other.m_mode)
 {
   computeKernel();
 }
 
 
+/**
+ * Computes the coefficients (B, b1/b0, b2/b0, b3/b0) of the recursive Gaussian filter of
+ * I.T. Young and L.J. van Vliet, "Recursive implementation of the Gaussian filter", Signal Processing 44, 1995
+ */
+static blitz::TinyVector<double,4> _iir_coefficients(const double sigma)
+{
+  // the approximation is only defined for sigma >= 0.5
+  const double s = std::max(sigma, 0.5);
+  const double q = s >= 2.5 ? 0.98711 * s - 0.96330 : 3.97156 - 4.14554 * sqrt(1. - 0.26891 * s);
+  const double q2 = q * q, q3 = q2 * q;
+  const double b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 + 0.422205 * q3;
+  const double b1 = (2.44413 * q + 2.85619 * q2 + 1.26661 * q3) / b0;
+  const double b2 = -(1.4281 * q2 + 1.26661 * q3) / b0;
+  const double b3 = 0.422205 * q3 / b0;
+  return blitz::TinyVector<double,4>(1. - (b1 + b2 + b3), b1, b2, b3);
+}
+
 void bob::ip::base::Gaussian::computeKernel()
 {
   m_kernel_y.resize(2 * m_radius_y + 1);
@@ -51,18 +73,24 @@ void bob::ip::base::Gaussian::computeKernel()
   }
   // Normalizes the kernel
   m_kernel_x /= blitz::sum(m_kernel_x);
+
+  // Computes the coefficients of the recursive filters
+  m_iir_y = _iir_coefficients(m_sigma_y);
+  m_iir_x = _iir_coefficients(m_sigma_x);
 }
 
 void bob::ip::base::Gaussian::reset(
   const size_t radius_y, const size_t radius_x,
   const double sigma_y, const double sigma_x,
-  const bob::sp::Extrapolation::BorderType border_type
+  const bob::sp::Extrapolation::BorderType border_type,
+  const GaussianMode mode
 ){
   m_radius_y = radius_y;
   m_radius_x = radius_x;
   m_sigma_y = sigma_y;
   m_sigma_x = sigma_x;
   m_conv_border = border_type;
+  m_mode = mode;
   computeKernel();
 }
 
@@ -75,6 +103,7 @@ bob::ip::base::Gaussian& bob::ip::base::Gaussian::operator=(const bob::ip::base:
     m_sigma_y = other.m_sigma_y;
     m_sigma_x = other.m_sigma_x;
     m_conv_border = other.m_conv_border;
+    m_mode = other.m_mode;
     computeKernel();
   }
   return *this;
@@ -84,7 +113,7 @@ bool bob::ip::base::Gaussian::operator==(const bob::ip::base::Gaussian& b) const
 {
   return (this->m_radius_y == b.m_radius_y && this->m_radius_x == b.m_radius_x &&
           this->m_sigma_y == b.m_sigma_y && this->m_sigma_x == b.m_sigma_x &&
-          this->m_conv_border == b.m_conv_border);
+          this->m_conv_border == b.m_conv_border && this->m_mode == b.m_mode);
 }
 
 bool bob::ip::base::Gaussian::operator!=(const bob::ip::base::Gaussian& b) const
@@ -92,35 +121,182 @@ bool bob::ip::base::Gaussian::operator!=(const bob::ip::base::Gaussian& b) const
   return !(this->operator==(b));
 }
 
-void bob::ip::base::Gaussian::filter_(const blitz::Array<double,2>& src, blitz::Array<double,2>& dst)
+bob::ip::base::Gaussian::Workspace& bob::ip::base::Gaussian::threadWorkspace()
 {
-  // Checks are postponed to the convolution function.
-  if(m_conv_border == bob::sp::Extrapolation::Zero)
-  {
-    m_tmp_int.resize(bob::sp::getConvSepOutputSize(src, m_kernel_y, 0, bob::sp::Conv::Same));
-    bob::sp::convSep(src, m_kernel_y, m_tmp_int, 0, bob::sp::Conv::Same);
-    bob::sp::convSep(m_tmp_int, m_kernel_x, dst, 1, bob::sp::Conv::Same);
+  static thread_local Workspace workspace;
+  return workspace;
+}
+
+void bob::ip::base::Gaussian::filter_(const blitz::Array<double,2>& src, blitz::Array<double,2>& dst, Workspace& workspace, const int threads) const
+{
+  filterTyped(src, dst, workspace, threads);
+}
+
+void bob::ip::base::Gaussian::filter_(const blitz::Array<float,2>& src, blitz::Array<float,2>& dst, Workspace& workspace, const int threads) const
+{
+  filterTyped(src, dst, workspace, threads);
+}
+
+template <typename T>
+void bob::ip::base::Gaussian::filterTyped(const blitz::Array<T,2>& src, blitz::Array<T,2>& dst, Workspace& workspace, const int threads) const
+{
+  bob::core::array::assertZeroBase(src);
+  bob::core::array::assertZeroBase(dst);
+  bob::core::array::assertSameShape(src, dst);
+
+  // the recursive filter is not defined for very small sigmas, where the (short) FIR kernel is used instead
+  // (the recursive filter reads all of src into the workspace before it writes dst, and hence can filter in place)
+  if (m_mode == GAUSSIAN_IIR && m_sigma_y >= 0.5 && m_sigma_x >= 0.5)
+    filterIIR(src, dst, workspace);
+  else if (_overlaps(src, dst)){
+    // each row of dst is written while the rows below it are still read from src (by this or another band),
+    // so that src is copied first when it shares its memory with dst, e.g., when filtering in place
+    _resize(workspace.src, src.extent(0), src.extent(1));
+    workspace.src = blitz::cast<double>(src);
+    filterFIR(workspace.src, dst, workspace, threads);
+  } else
+    filterFIR(src, dst, workspace, threads);
+}
+
+template <typename S, typename T>
+void bob::ip::base::Gaussian::filterFIR(const blitz::Array<S,2>& src, blitz::Array<T,2>& dst, Workspace& workspace, const int threads) const
+{
+  const int height = src.extent(0), width = src.extent(1);
+  const int radius_y = m_radius_y, radius_x = m_radius_x;
+  if (!height || !width) return;
+
+  // The borders are handled by remapping the indices instead of extrapolating the image:
+  // the source row (column) for each row (column) of the padded image
+  workspace.index_y.resize(height + 2*radius_y);
+  for (int y = 0; y < height + 2*radius_y; ++y)
+    workspace.index_y[y] = _border_index(y - radius_y, height, m_conv_border);
+  workspace.index_x.resize(width + 2*radius_x);
+  for (int x = 0; x < width + 2*radius_x; ++x)
+    workspace.index_x[x] = _border_index(x - radius_x, width, m_conv_border);
+
+  const double* kernel_y = m_kernel_y.data(),* kernel_x = m_kernel_x.data();
+  const S* src_data = src.data();
+  T* dst_data = dst.data();
+  const int src_sy = src.stride(0), src_sx = src.stride(1), dst_sy = dst.stride(0), dst_sx = dst.stride(1);
+  const int* index_y = &workspace.index_y[0],* index_x = &workspace.index_x[0];
+
+  // the rows are split into bands of (almost) equal size, and
+  // a single padded row per band holds the result of the convolution along the y-axis
+  const int bands = _thread_count(threads, height);
+  workspace.rows.resize(std::max<size_t>(workspace.rows.size(), bands));
+  _parallel_for(bands, bands, [&](int b){
+    std::vector<double>& buffer = workspace.rows[b];
+    buffer.resize(width + 2*radius_x);
+    double* row = &buffer[0];
+    double* center = row + radius_x;
+
+    for (int y = b * height / bands; y < (b+1) * height / bands; ++y){
+      // convolve along the y-axis
+      std::fill(center, center + width, 0.);
+      for (int k = 0; k <= 2*radius_y; ++k){
+        const int sy = index_y[y + k];
+        if (sy < 0) continue;
+        const double weight = kernel_y[2*radius_y - k];
+        const S* src_row = src_data + sy * src_sy;
+        if (src_sx == 1)
+          for (int x = 0; x < width; ++x) center[x] += weight * src_row[x];
+        else
+          for (int x = 0; x < width; ++x) center[x] += weight * src_row[x * src_sx];
+      }
+
+      // fill the border of the row
+      for (int x = 0; x < radius_x; ++x){
+        const int left = index_x[x], right = index_x[width + radius_x + x];
+        row[x] = left < 0 ? 0. : center[left];
+        center[width + x] = right < 0 ? 0. : center[right];
+      }
+
+      // convolve along the x-axis
+      T* dst_row = dst_data + y * dst_sy;
+      for (int x = 0; x < width; ++x){
+        double value = 0.;
+        for (int k = 0; k <= 2*radius_x; ++k)
+          value += kernel_x[2*radius_x - k] * row[x + k];
+        dst_row[x * dst_sx] = value;
+      }
+    }
+  });
+}
+
+template <typename T>
+void bob::ip::base::Gaussian::filterIIR(const blitz::Array<T,2>& src, blitz::Array<T,2>& dst, Workspace& workspace) const
+{
+  const int height = src.extent(0), width = src.extent(1);
+  if (!height || !width) return;
+
+  // The recursive filters are run over the image extended by 4 sigma on each side,
+  // where the Gaussian has decayed below 1e-4; the borders are handled by remapping the indices
+  const int border_y = (int)ceil(4. * m_sigma_y), border_x = (int)ceil(4. * m_sigma_x);
+  const int padded_height = height + 2*border_y, padded_width = width + 2*border_x;
+  workspace.index_y.resize(padded_height);
+  for (int y = 0; y < padded_height; ++y)
+    workspace.index_y[y] = _border_index(y - border_y, height, m_conv_border);
+  workspace.index_x.resize(padded_width);
+  for (int x = 0; x < padded_width; ++x)
+    workspace.index_x[x] = _border_index(x - border_x, width, m_conv_border);
+
+  const T* src_data = src.data();
+  T* dst_data = dst.data();
+  const int src_sy = src.stride(0), src_sx = src.stride(1), dst_sy = dst.stride(0), dst_sx = dst.stride(1);
+
+  // filter along the y-axis, row by row, into the padded image
+  _resize(workspace.columns, padded_height, width);
+  double* columns = workspace.columns.data();
+  const double By = m_iir_y(0), b1y = m_iir_y(1), b2y = m_iir_y(2), b3y = m_iir_y(3);
+  // forward pass; the rows before the padded image are initialized with the steady state of the first row
+  for (int y = 0; y < padded_height; ++y){
+    double* w = columns + y * width;
+    const int sy = workspace.index_y[y];
+    const T* src_row = src_data + sy * src_sy;
+    const double* w1 = y > 0 ? w - width : w;
+    const double* w2 = y > 1 ? w - 2*width : w1;
+    const double* w3 = y > 2 ? w - 3*width : w2;
+    for (int x = 0; x < width; ++x){
+      const double value = sy < 0 ? 0. : src_row[x * src_sx];
+      w[x] = y ? By * value + b1y * w1[x] + b2y * w2[x] + b3y * w3[x] : value;
+    }
   }
-  else
-  {
-    m_tmp_int1.resize(bob::sp::getConvSepOutputSize(src, m_kernel_y, 0, bob::sp::Conv::Full));
-    if(m_conv_border == bob::sp::Extrapolation::NearestNeighbour)
-      bob::sp::extrapolateNearest(src, m_tmp_int1);
-    else if(m_conv_border == bob::sp::Extrapolation::Circular)
-      bob::sp::extrapolateCircular(src, m_tmp_int1);
-    else
-      bob::sp::extrapolateMirror(src, m_tmp_int1);
-    m_tmp_int.resize(bob::sp::getConvSepOutputSize(m_tmp_int1, m_kernel_y, 0, bob::sp::Conv::Valid));
-    bob::sp::convSep(m_tmp_int1, m_kernel_y, m_tmp_int, 0, bob::sp::Conv::Valid);
-
-    m_tmp_int2.resize(bob::sp::getConvSepOutputSize(m_tmp_int, m_kernel_x, 1, bob::sp::Conv::Full));
-    if(m_conv_border == bob::sp::Extrapolation::NearestNeighbour)
-      bob::sp::extrapolateNearest(m_tmp_int, m_tmp_int2);
-    else if(m_conv_border == bob::sp::Extrapolation::Circular)
-      bob::sp::extrapolateCircular(m_tmp_int, m_tmp_int2);
-    else
-      bob::sp::extrapolateMirror(m_tmp_int, m_tmp_int2);
-    bob::sp::convSep(m_tmp_int2, m_kernel_x, dst, 1, bob::sp::Conv::Valid);
+  // backward pass, in place
+  for (int y = padded_height - 2; y >= 0; --y){
+    double* w = columns + y * width;
+    const double* w1 = w + width;
+    const double* w2 = y < padded_height - 2 ? w + 2*width : w1;
+    const double* w3 = y < padded_height - 3 ? w + 3*width : w2;
+    for (int x = 0; x < width; ++x)
+      w[x] = By * w[x] + b1y * w1[x] + b2y * w2[x] + b3y * w3[x];
   }
-}
 
+  // filter along the x-axis, using a single padded row
+  workspace.row.resize(padded_width);
+  double* row = &workspace.row[0];
+  double* center = row + border_x;
+  const double Bx = m_iir_x(0), b1x = m_iir_x(1), b2x = m_iir_x(2), b3x = m_iir_x(3);
+  for (int y = 0; y < height; ++y){
+    std::copy(columns + (y + border_y) * width, columns + (y + border_y + 1) * width, center);
+    for (int x = 0; x < border_x; ++x){
+      const int left = workspace.index_x[x], right = workspace.index_x[width + border_x + x];
+      row[x] = left < 0 ? 0. : center[left];
+      center[width + x] = right < 0 ? 0. : center[right];
+    }
+    // forward pass
+    double w1 = row[0], w2 = w1, w3 = w1;
+    for (int x = 0; x < padded_width; ++x){
+      const double w = Bx * row[x] + b1x * w1 + b2x * w2 + b3x * w3;
+      row[x] = w; w3 = w2; w2 = w1; w1 = w;
+    }
+    // backward pass
+    w1 = w2 = w3 = row[padded_width-1];
+    for (int x = padded_width - 1; x >= 0; --x){
+      const double w = Bx * row[x] + b1x * w1 + b2x * w2 + b3x * w3;
+      row[x] = w; w3 = w2; w2 = w1; w1 = w;
+    }
+    T* dst_row = dst_data + y * dst_sy;
+    for (int x = 0; x < width; ++x)
+      dst_row[x * dst_sx] = center[x];
+  }
+}
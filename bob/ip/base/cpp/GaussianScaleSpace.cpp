@@ -7,6 +7,8 @@
 
 #include <bob.ip.base/GaussianScaleSpace.h>
 
+#include <limits>
+
 bob::ip::base::GaussianScaleSpace::GaussianScaleSpace(
   const size_t height,
   const size_t width,
@@ -29,7 +31,6 @@ bob::ip::base::GaussianScaleSpace::GaussianScaleSpace(
   m_conv_border(border_type)
 {
   checkOctaveMin();
-  resetCache();
   resetGaussians();
 }
 
@@ -41,7 +42,6 @@ bob::ip::base::GaussianScaleSpace::GaussianScaleSpace(const GaussianScaleSpace&
   m_kernel_radius_factor(other.m_kernel_radius_factor),
   m_conv_border(other.m_conv_border)
 {
-  resetCache();
   resetGaussians();
 }
 
@@ -62,18 +62,11 @@ bob::ip::base::GaussianScaleSpace& bob::ip::base::GaussianScaleSpace::operator=(
     m_sigma0 = other.m_sigma0;
     m_kernel_radius_factor = other.m_kernel_radius_factor;
     m_conv_border = other.m_conv_border;
-    resetCache();
     resetGaussians();
   }
   return *this;
 }
 
-void bob::ip::base::GaussianScaleSpace::resetCache() const
-{
-  const blitz::TinyVector<int,3> shape = getOutputShape(m_octave_min);
-  m_cache_array0.resize(shape(1), shape(2));
-}
-
 bool bob::ip::base::GaussianScaleSpace::operator==(const bob::ip::base::GaussianScaleSpace& b) const
 {
   return (this->m_height == b.m_height && this->m_width == b.m_width &&
@@ -148,17 +141,92 @@ void bob::ip::base::GaussianScaleSpace::resetGaussians()
   }
 }
 
-void bob::ip::base::GaussianScaleSpace::allocateOutputPyramid(
-  std::vector<blitz::Array<double,3> >& dst) const
+void bob::ip::base::GaussianScaleSpace::processOctave(
+  std::vector<blitz::Array<double,3> >& dst, const size_t o, const int threads) const
+{
+  processOctaveTyped(dst, o, threads);
+}
+
+void bob::ip::base::GaussianScaleSpace::processOctave(
+  std::vector<blitz::Array<float,3> >& dst, const size_t o, const int threads) const
+{
+  processOctaveTyped(dst, o, threads);
+}
+
+template <typename U>
+void bob::ip::base::GaussianScaleSpace::processOctaveTyped(
+  std::vector<blitz::Array<U,3> >& dst, const size_t o, const int threads) const
+{
+  // the number of threads that may run at the same time, which are shared by all tasks below
+  const int n_threads = _thread_count(threads, std::numeric_limits<int>::max());
+
+  // the scales are accessed through views that do not share the reference
+  // counter of the octave, which is used by several threads (see _thread_plane)
+  auto smooth = [&](const size_t s, const int band_threads){
+    const blitz::Array<U,2> dst_prev = _thread_plane(dst[o], s-1);
+    blitz::Array<U,2> dst_cur = _thread_plane(dst[o], s);
+    m_gaussians[s]->filter_(dst_prev, dst_cur, Gaussian::threadWorkspace(), band_threads);
+  };
+
+  // the scales up to the one that seeds the next octave
+  for (size_t s=1; s<=m_n_intervals; ++s)
+    smooth(s, n_threads);
+
+  // the next octaves, which start from the downsampled scale that seeds them
+  auto next_octaves = [&](const int octave_threads){
+    // Copy from previous octave and downsample
+    const blitz::Array<U,2> dst_prev = _thread_plane(dst[o], m_n_intervals);
+    blitz::Array<U,2> dst_m1 = _thread_plane(dst[o+1], 0);
+    _downsample(dst_prev, dst_m1, 1);
+    processOctaveTyped(dst, o+1, octave_threads);
+  };
+
+  if (o+1 == m_n_octaves || n_threads == 1){
+    // the remaining scales of this octave, and the next octaves, one after the other
+    for (size_t s=m_n_intervals+1; s<m_n_intervals+3; ++s)
+      smooth(s, n_threads);
+    if (o+1 < m_n_octaves) next_octaves(n_threads);
+    return;
+  }
+
+  // the remaining scales of this octave, and the next octaves, at the same time;
+  // both tasks split the threads, since the next octaves (1/4 of the pixels, but all scales)
+  // cost about as much as the two remaining scales of this octave
+  const int next_threads = n_threads / 2, current_threads = n_threads - next_threads;
+  _parallel_for(2, 2, [&](int task){
+    if (task == 0) {
+      for (size_t s=m_n_intervals+1; s<m_n_intervals+3; ++s)
+        smooth(s, current_threads);
+    }
+    else
+      next_octaves(next_threads);
+  });
+}
+
+template <typename U>
+static void _allocate(const bob::ip::base::GaussianScaleSpace& gss,
+  std::vector<blitz::Array<U,3> >& dst)
 {
   dst.clear();
-  for (size_t i=0; i<m_n_octaves; ++i)
+  for (size_t i=0; i<gss.getNOctaves(); ++i)
   {
-    blitz::Array<double,3> dst_o(getOutputShape(m_octave_min+(int)i));
+    blitz::Array<U,3> dst_o(gss.getOutputShape(gss.getOctaveMin()+(int)i));
     dst.push_back(dst_o);
   }
 }
 
+void bob::ip::base::GaussianScaleSpace::allocateOutputPyramid(
+  std::vector<blitz::Array<double,3> >& dst) const
+{
+  _allocate(*this, dst);
+}
+
+void bob::ip::base::GaussianScaleSpace::allocateOutputPyramid(
+  std::vector<blitz::Array<float,3> >& dst) const
+{
+  _allocate(*this, dst);
+}
+
 const blitz::TinyVector<int,3> bob::ip::base::GaussianScaleSpace::getOutputShape(const int octave) const
 {
   // Is the octave index valid?n
@@ -14,12 +14,14 @@
 bob::ip::base::GeomNorm::GeomNorm(
     const double rotation_angle, const double scaling_factor,
     const blitz::TinyVector<int,2>& crop_size,
-    const blitz::TinyVector<double,2>& crop_offset
+    const blitz::TinyVector<double,2>& crop_offset,
+    const Interpolation interpolation
 ):
   m_rotation_angle(rotation_angle),
   m_scaling_factor(scaling_factor),
   m_crop_size(crop_size),
-  m_crop_offset(crop_offset)
+  m_crop_offset(crop_offset),
+  m_interpolation(interpolation)
 {
 }
 
@@ -27,7 +29,8 @@ bob::ip::base::GeomNorm::GeomNorm(const bob::ip::base::GeomNorm& other):
   m_rotation_angle(other.m_rotation_angle),
   m_scaling_factor(other.m_scaling_factor),
   m_crop_size(other.m_crop_size),
-  m_crop_offset(other.m_crop_offset)
+  m_crop_offset(other.m_crop_offset),
+  m_interpolation(other.m_interpolation)
 {
 }
 
@@ -44,6 +47,7 @@ bob::ip::base::GeomNorm::operator=(const bob::ip::base::GeomNorm& other)
     m_scaling_factor = other.m_scaling_factor;
     m_crop_size = other.m_crop_size;
     m_crop_offset = other.m_crop_offset;
+    m_interpolation = other.m_interpolation;
   }
   return *this;
 }
@@ -54,7 +58,8 @@ bob::ip::base::GeomNorm::operator==(const bob::ip::base::GeomNorm& b) const
   return m_rotation_angle == b.m_rotation_angle &&
          m_scaling_factor == b.m_scaling_factor &&
          m_crop_size[0] == b.m_crop_size[0] && m_crop_size[1] == b.m_crop_size[1] &&
-         m_crop_offset[0] == b.m_crop_offset[0] && m_crop_offset[1] == b.m_crop_offset[1];
+         m_crop_offset[0] == b.m_crop_offset[0] && m_crop_offset[1] == b.m_crop_offset[1] &&
+         m_interpolation == b.m_interpolation;
 }
 
 bool
@@ -14,14 +14,15 @@ bob::ip::base::MultiscaleRetinex::MultiscaleRetinex(
   const int size_min,
   const int size_step,
   const double sigma,
-  const bob::sp::Extrapolation::BorderType border_type
+  const bob::sp::Extrapolation::BorderType border_type,
+  const bool cascaded
 ):
   m_n_scales(n_scales),
   m_size_min(size_min),
   m_size_step(size_step),
   m_sigma(sigma),
   m_conv_border(border_type),
-  m_gaussians(new bob::ip::base::Gaussian[m_n_scales])
+  m_cascaded(cascaded)
 {
   computeKernels();
 }
@@ -34,7 +35,7 @@ bob::ip::base::MultiscaleRetinex::MultiscaleRetinex(const MultiscaleRetinex& oth
   m_size_step(other.m_size_step),
   m_sigma(other.m_sigma),
   m_conv_border(other.m_conv_border),
-  m_gaussians(new bob::ip::base::Gaussian[m_n_scales])
+  m_cascaded(other.m_cascaded)
 {
   computeKernels();
 }
@@ -42,6 +43,8 @@ bob::ip::base::MultiscaleRetinex::MultiscaleRetinex(const MultiscaleRetinex& oth
 
 void bob::ip::base::MultiscaleRetinex::computeKernels()
 {
+  m_gaussians.reset(new bob::ip::base::Gaussian[m_n_scales]);
+  m_increments.reset(new bob::ip::base::Gaussian[m_n_scales]);
   for( size_t s=0; s<m_n_scales; ++s)
   {
     // size of the kernel
@@ -50,6 +53,17 @@ void bob::ip::base::MultiscaleRetinex::computeKernels()
     double s_sigma = m_sigma * s_size / m_size_min;
     // Initialize the Gaussian
     m_gaussians[s].reset(s_size, s_size, s_sigma, s_sigma, m_conv_border);
+
+    // Initialize the Gaussian that smooths the previous scale to this one
+    if (s == 0 || m_size_step <= 0){
+      m_increments[s] = m_gaussians[s];
+    } else {
+      int p_size = s_size - m_size_step;
+      double p_sigma = m_sigma * p_size / m_size_min;
+      int i_size = (int)ceil(sqrt((double)s_size * s_size - (double)p_size * p_size));
+      double i_sigma = sqrt(s_sigma * s_sigma - p_sigma * p_sigma);
+      m_increments[s].reset(i_size, i_size, i_sigma, i_sigma, m_conv_border);
+    }
   }
 }
 
@@ -58,14 +72,15 @@ void bob::ip::base::MultiscaleRetinex::reset(
   const int size_min,
   const int size_step,
   const double sigma,
-  const bob::sp::Extrapolation::BorderType border_type
+  const bob::sp::Extrapolation::BorderType border_type,
+  const bool cascaded
 ){
   m_n_scales = n_scales;
-  m_gaussians.reset(new bob::ip::base::Gaussian[m_n_scales]);
   m_size_min = size_min;
   m_size_step = size_step;
   m_sigma = sigma;
   m_conv_border = border_type;
+  m_cascaded = cascaded;
   computeKernels();
 }
 
@@ -74,11 +89,11 @@ bob::ip::base::MultiscaleRetinex& bob::ip::base::MultiscaleRetinex::operator=(co
   if (this != &other)
   {
     m_n_scales = other.m_n_scales;
-    m_gaussians.reset(new bob::ip::base::Gaussian[m_n_scales]);
     m_size_min = other.m_size_min;
     m_size_step = other.m_size_step;
     m_sigma = other.m_sigma;
     m_conv_border = other.m_conv_border;
+    m_cascaded = other.m_cascaded;
     computeKernels();
   }
   return *this;
@@ -88,7 +103,7 @@ bool bob::ip::base::MultiscaleRetinex::operator==(const bob::ip::base::Multiscal
 {
   return (this->m_n_scales == b.m_n_scales && this->m_size_min== b.m_size_min &&
           this->m_size_step == b.m_size_step && this->m_sigma == b.m_sigma &&
-          this->m_conv_border == b.m_conv_border);
+          this->m_conv_border == b.m_conv_border && this->m_cascaded == b.m_cascaded);
 }
 
 bool bob::ip::base::MultiscaleRetinex::operator!=(const bob::ip::base::MultiscaleRetinex& b) const
@@ -96,3 +111,51 @@ bool bob::ip::base::MultiscaleRetinex::operator!=(const bob::ip::base::Multiscal
   return !(this->operator==(b));
 }
 
+
+bob::ip::base::MultiscaleRetinex::Workspace& bob::ip::base::MultiscaleRetinex::threadWorkspace()
+{
+  static thread_local Workspace workspace;
+  return workspace;
+}
+
+void bob::ip::base::MultiscaleRetinex::process_(const blitz::Array<double,2>& src, blitz::Array<double,2>& dst, Workspace& workspace, const int threads) const
+{
+  bob::core::array::assertZeroBase(src);
+  bob::core::array::assertZeroBase(dst);
+  bob::core::array::assertSameShape(src, dst);
+
+  const int height = src.extent(0), width = src.extent(1);
+  const int n_scales = m_n_scales;
+  if (workspace.smoothed.size() < m_n_scales){
+    workspace.smoothed.resize(m_n_scales);
+    workspace.gaussians.resize(m_n_scales);
+  }
+  for (int s = 0; s < n_scales; ++s)
+    _resize(workspace.smoothed[s], height, width);
+
+  if (m_cascaded && m_size_step > 0){
+    // smooth each scale from the previous one
+    for (int s = 0; s < n_scales; ++s)
+      m_increments[s].filter_(s ? workspace.smoothed[s-1] : src, workspace.smoothed[s], workspace.gaussians[0]);
+  } else {
+    // the scales are independent; each thread uses its own output and Gaussian workspace
+    _parallel_for(n_scales, threads, [&](int s){
+      m_gaussians[s].filter_(src, workspace.smoothed[s], workspace.gaussians[s]);
+    });
+  }
+
+  // accumulate the log differences, computing log(src+1) only once per pixel
+  std::vector<const double*> smoothed(n_scales);
+  for (int y = 0; y < height; ++y){
+    for (int s = 0; s < n_scales; ++s)
+      smoothed[s] = workspace.smoothed[s].data() + y * width;
+    const double* src_row = src.data() + y * src.stride(0);
+    double* dst_row = dst.data() + y * dst.stride(0);
+    for (int x = 0; x < width; ++x){
+      double sum = 0.;
+      for (int s = 0; s < n_scales; ++s)
+        sum += log(smoothed[s][x] + 1.);
+      dst_row[x * dst.stride(1)] = log(src_row[x * src.stride(1)] + 1.) - sum / n_scales;
+    }
+  }
+}
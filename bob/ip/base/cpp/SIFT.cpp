@@ -8,6 +8,10 @@
 #include <bob.core/assert.h>
 #include <algorithm>
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif // __AVX2__
+
 #include <bob.ip.base/SIFT.h>
 
 bob::ip::base::SIFT::SIFT(
@@ -22,7 +26,8 @@ bob::ip::base::SIFT::SIFT(
   const double edge_thres,
   const double norm_thres,
   const double kernel_radius_factor,
-  const bob::sp::Extrapolation::BorderType border_type
+  const bob::sp::Extrapolation::BorderType border_type,
+  const bool single_precision
 ):
   m_gss(new bob::ip::base::GaussianScaleSpace(height, width, n_intervals, n_octaves, octave_min, sigma_n, sigma0, kernel_radius_factor, border_type)),
   m_contrast_thres(contrast_thres),
@@ -32,7 +37,8 @@ bob::ip::base::SIFT::SIFT(
   m_descr_n_bins(8),
   m_descr_gaussian_window_size(m_descr_n_blocks/2.),
   m_descr_magnif(3.),
-  m_norm_eps(1e-10)
+  m_norm_eps(1e-10),
+  m_single_precision(single_precision)
 {
   updateEdgeEffThreshold();
   resetCache();
@@ -46,18 +52,13 @@ bob::ip::base::SIFT::SIFT(const bob::ip::base::SIFT& other)
   m_descr_n_blocks(other.m_descr_n_blocks),
   m_descr_n_bins(other.m_descr_n_bins),
   m_descr_gaussian_window_size(other.m_descr_gaussian_window_size),
-  m_descr_magnif(other.m_descr_magnif), m_norm_eps(other.m_norm_eps)
+  m_descr_magnif(other.m_descr_magnif), m_norm_eps(other.m_norm_eps),
+  m_single_precision(other.m_single_precision)
 {
   updateEdgeEffThreshold();
   resetCache();
-  // Update cache content
-  for (size_t i=0; i<m_gss_pyr.size(); ++i)
-  {
-    m_gss_pyr[i] = other.m_gss_pyr[i];
-    m_dog_pyr[i] = other.m_dog_pyr[i];
-    m_gss_pyr_grad_mag[i] = other.m_gss_pyr_grad_mag[i];
-    m_gss_pyr_grad_or[i] = other.m_gss_pyr_grad_or[i];
-  }
+  std::lock_guard<std::mutex> lock(other.m_mutex);
+  copyCache(other);
 }
 
 bob::ip::base::SIFT::~SIFT()
@@ -68,6 +69,8 @@ bob::ip::base::SIFT& bob::ip::base::SIFT::operator=(const bob::ip::base::SIFT& o
 {
   if (this != &other)
   {
+    std::lock(m_mutex, other.m_mutex);
+    std::lock_guard<std::mutex> lock(m_mutex, std::adopt_lock), other_lock(other.m_mutex, std::adopt_lock);
     m_gss.reset(new bob::ip::base::GaussianScaleSpace(*(other.m_gss)));
     m_contrast_thres = other.m_contrast_thres;
     m_edge_thres = other.m_edge_thres;
@@ -76,21 +79,29 @@ bob::ip::base::SIFT& bob::ip::base::SIFT::operator=(const bob::ip::base::SIFT& o
     m_descr_gaussian_window_size = other.m_descr_gaussian_window_size;
     m_descr_magnif = other.m_descr_magnif;
     m_norm_eps = other.m_norm_eps;
+    m_single_precision = other.m_single_precision;
     updateEdgeEffThreshold();
     m_norm_thres = other.m_norm_thres;
     resetCache();
-    // Update cache content
-    for (size_t i=0; i<m_gss_pyr.size(); ++i)
-    {
-      m_gss_pyr[i] = other.m_gss_pyr[i];
-      m_dog_pyr[i] = other.m_dog_pyr[i];
-      m_gss_pyr_grad_mag[i] = other.m_gss_pyr_grad_mag[i];
-      m_gss_pyr_grad_or[i] = other.m_gss_pyr_grad_or[i];
-    }
+    copyCache(other);
   }
   return *this;
 }
 
+/**
+ * Returns whether the two pyramids have the same number of octaves, and identical octaves
+ */
+template <typename U>
+static bool _is_equal(const std::vector<blitz::Array<U,3> >& a, const std::vector<blitz::Array<U,3> >& b)
+{
+  if (a.size() != b.size())
+    return false;
+  for (size_t i=0; i<a.size(); ++i)
+    if (!bob::core::array::isEqual(a[i], b[i]))
+      return false;
+  return true;
+}
+
 bool bob::ip::base::SIFT::operator==(const bob::ip::base::SIFT& b) const
 {
   if (*(this->m_gss) != *(b.m_gss) ||
@@ -102,31 +113,22 @@ bool bob::ip::base::SIFT::operator==(const bob::ip::base::SIFT& b) const
         this->m_descr_n_bins != b.m_descr_n_bins ||
         this->m_descr_gaussian_window_size != b.m_descr_gaussian_window_size ||
         this->m_descr_magnif != b.m_descr_magnif ||
-        this->m_norm_thres != b.m_norm_thres)
+        this->m_norm_thres != b.m_norm_thres ||
+        this->m_single_precision != b.m_single_precision)
     return false;
 
- if (this->m_gss_pyr.size() != b.m_gss_pyr.size() ||
-     this->m_dog_pyr.size() != b.m_dog_pyr.size() ||
-     this->m_gss_pyr_grad_mag.size() != b.m_gss_pyr_grad_mag.size() ||
-     this->m_gss_pyr_grad_or.size() != b.m_gss_pyr_grad_or.size() ||
-     this->m_gradient_maps.size() != b.m_gradient_maps.size())
+ if (this->m_gradient_maps.size() != b.m_gradient_maps.size())
     return false;
 
-  for (size_t i=0; i<m_gss_pyr.size(); ++i)
-    if (!bob::core::array::isEqual(this->m_gss_pyr[i], b.m_gss_pyr[i]))
-      return false;
-
-  for (size_t i=0; i<m_dog_pyr.size(); ++i)
-    if (!bob::core::array::isEqual(this->m_dog_pyr[i], b.m_dog_pyr[i]))
-      return false;
-
-  for (size_t i=0; i<m_gss_pyr_grad_mag.size(); ++i)
-    if (!bob::core::array::isEqual(this->m_gss_pyr_grad_mag[i], b.m_gss_pyr_grad_mag[i]))
-      return false;
-
-  for (size_t i=0; i<m_gss_pyr_grad_or.size(); ++i)
-    if (!bob::core::array::isEqual(this->m_gss_pyr_grad_or[i], b.m_gss_pyr_grad_or[i]))
-      return false;
+  if (!_is_equal(this->m_gss_pyr, b.m_gss_pyr) ||
+      !_is_equal(this->m_dog_pyr, b.m_dog_pyr) ||
+      !_is_equal(this->m_gss_pyr_grad_mag, b.m_gss_pyr_grad_mag) ||
+      !_is_equal(this->m_gss_pyr_grad_or, b.m_gss_pyr_grad_or) ||
+      !_is_equal(this->m_gss_pyr_float, b.m_gss_pyr_float) ||
+      !_is_equal(this->m_dog_pyr_float, b.m_dog_pyr_float) ||
+      !_is_equal(this->m_gss_pyr_grad_mag_float, b.m_gss_pyr_grad_mag_float) ||
+      !_is_equal(this->m_gss_pyr_grad_or_float, b.m_gss_pyr_grad_or_float))
+    return false;
 
   for (size_t i=0; i<m_gradient_maps.size(); ++i)
     if (*(this->m_gradient_maps[i]) != *(b.m_gradient_maps[i]))
@@ -146,75 +148,155 @@ const blitz::TinyVector<int,3> bob::ip::base::SIFT::getDescriptorShape() const
 }
 
 
+/**
+ * Allocates the DoG and gradient pyramids for the given Gaussian pyramid,
+ * and sets all pyramids to zero
+ */
+template <typename U>
+static void _allocate(std::vector<blitz::Array<U,3> >& gss, std::vector<blitz::Array<U,3> >& dog,
+  std::vector<blitz::Array<U,3> >& grad_mag, std::vector<blitz::Array<U,3> >& grad_or)
+{
+  for (size_t i=0; i<gss.size(); ++i)
+  {
+    dog.push_back(blitz::Array<U,3>(gss[i].extent(0)-1,
+      gss[i].extent(1), gss[i].extent(2)));
+    grad_mag.push_back(blitz::Array<U,3>(gss[i].extent(0)-3,
+      gss[i].extent(1), gss[i].extent(2)));
+    grad_or.push_back(blitz::Array<U,3>(gss[i].extent(0)-3,
+      gss[i].extent(1), gss[i].extent(2)));
+    gss[i] = 0.;
+    dog[i] = 0.;
+    grad_mag[i] = 0.;
+    grad_or[i] = 0.;
+  }
+}
+
+/**
+ * Copies the content of the src pyramid into the (allocated) dst pyramid
+ */
+template <typename U>
+static void _copy(const std::vector<blitz::Array<U,3> >& src, std::vector<blitz::Array<U,3> >& dst)
+{
+  for (size_t i=0; i<src.size(); ++i)
+    dst[i] = src[i];
+}
+
 void bob::ip::base::SIFT::resetCache()
 {
-  m_gss->allocateOutputPyramid(m_gss_pyr);
+  m_gss_pyr.clear();
   m_dog_pyr.clear();
   m_gss_pyr_grad_mag.clear();
   m_gss_pyr_grad_or.clear();
-  for (size_t i=0; i<m_gss_pyr.size(); ++i)
+  m_gss_pyr_float.clear();
+  m_dog_pyr_float.clear();
+  m_gss_pyr_grad_mag_float.clear();
+  m_gss_pyr_grad_or_float.clear();
+  if (m_single_precision)
+  {
+    m_gss->allocateOutputPyramid(m_gss_pyr_float);
+    _allocate(m_gss_pyr_float, m_dog_pyr_float, m_gss_pyr_grad_mag_float, m_gss_pyr_grad_or_float);
+  }
+  else
   {
-    m_dog_pyr.push_back(blitz::Array<double,3>(m_gss_pyr[i].extent(0)-1,
-      m_gss_pyr[i].extent(1), m_gss_pyr[i].extent(2)));
-    m_gss_pyr_grad_mag.push_back(blitz::Array<double,3>(m_gss_pyr[i].extent(0)-3,
-      m_gss_pyr[i].extent(1), m_gss_pyr[i].extent(2)));
-    m_gss_pyr_grad_or.push_back(blitz::Array<double,3>(m_gss_pyr[i].extent(0)-3,
-      m_gss_pyr[i].extent(1), m_gss_pyr[i].extent(2)));
+    m_gss->allocateOutputPyramid(m_gss_pyr);
+    _allocate(m_gss_pyr, m_dog_pyr, m_gss_pyr_grad_mag, m_gss_pyr_grad_or);
+  }
+
+  m_gradient_maps.clear();
+  for (int o=getOctaveMin(); o<=getOctaveMax(); ++o)
+  {
+    const blitz::TinyVector<int,3> shape = getGaussianOutputShape(o);
     m_gradient_maps.push_back(boost::shared_ptr<bob::ip::base::GradientMaps>(new
-      bob::ip::base::GradientMaps(m_gss_pyr[i].extent(1), m_gss_pyr[i].extent(2))));
-    m_gss_pyr[i] = 0.;
-    m_dog_pyr[i] = 0.;
-    m_gss_pyr_grad_mag[i] = 0.;
-    m_gss_pyr_grad_or[i] = 0.;
+      bob::ip::base::GradientMaps(shape(1), shape(2))));
   }
 }
 
+void bob::ip::base::SIFT::copyCache(const bob::ip::base::SIFT& other)
+{
+  _copy(other.m_gss_pyr, m_gss_pyr);
+  _copy(other.m_dog_pyr, m_dog_pyr);
+  _copy(other.m_gss_pyr_grad_mag, m_gss_pyr_grad_mag);
+  _copy(other.m_gss_pyr_grad_or, m_gss_pyr_grad_or);
+  _copy(other.m_gss_pyr_float, m_gss_pyr_float);
+  _copy(other.m_dog_pyr_float, m_dog_pyr_float);
+  _copy(other.m_gss_pyr_grad_mag_float, m_gss_pyr_grad_mag_float);
+  _copy(other.m_gss_pyr_grad_or_float, m_gss_pyr_grad_or_float);
+}
+
 const blitz::TinyVector<int,3> bob::ip::base::SIFT::getGaussianOutputShape(const int octave) const
 {
   return m_gss->getOutputShape(octave);
 }
 
-void bob::ip::base::SIFT::computeDog()
+/**
+ * Computes the Difference of Gaussians pyramid from the Gaussian pyramid
+ */
+template <typename U>
+static void _dog(const std::vector<blitz::Array<U,3> >& gss, std::vector<blitz::Array<U,3> >& dog)
 {
-  // Computes the Difference of Gaussians pyramid
   blitz::Range rall = blitz::Range::all();
-  for (size_t o=0; o<m_gss_pyr.size(); ++o)
-    for (size_t s=0; s<(size_t)(m_gss_pyr[o].extent(0)-1); ++s)
+  for (size_t o=0; o<gss.size(); ++o)
+    for (size_t s=0; s<(size_t)(gss[o].extent(0)-1); ++s)
     {
-      blitz::Array<double,2> dst_os = m_dog_pyr[o](s, rall, rall);
-      blitz::Array<double,2> src1 = m_gss_pyr[o](s, rall, rall);
-      blitz::Array<double,2> src2 = m_gss_pyr[o](s+1, rall, rall);
+      blitz::Array<U,2> dst_os = dog[o](s, rall, rall);
+      blitz::Array<U,2> src1 = gss[o](s, rall, rall);
+      blitz::Array<U,2> src2 = gss[o](s+1, rall, rall);
       dst_os = src2 - src1;
     }
 }
 
-void bob::ip::base::SIFT::computeGradient()
+void bob::ip::base::SIFT::computeDog()
+{
+  // Computes the Difference of Gaussians pyramid
+  if (m_single_precision)
+    _dog(m_gss_pyr_float, m_dog_pyr_float);
+  else
+    _dog(m_gss_pyr, m_dog_pyr);
+}
+
+/**
+ * Computes the gradient pyramids from the Gaussian pyramid
+ */
+template <typename U>
+static void _gradient(const std::vector<blitz::Array<U,3> >& gss_pyr, std::vector<blitz::Array<U,3> >& grad_mag,
+  std::vector<blitz::Array<U,3> >& grad_or, const std::vector<boost::shared_ptr<bob::ip::base::GradientMaps> >& gradient_maps)
 {
   blitz::Range rall = blitz::Range::all();
-  for (size_t i=0; i<m_gss_pyr.size(); ++i)
+  for (size_t i=0; i<gss_pyr.size(); ++i)
   {
-    blitz::Array<double,3>& gss = m_gss_pyr[i];
-    blitz::Array<double,3>& gmag = m_gss_pyr_grad_mag[i];
-    blitz::Array<double,3>& gor = m_gss_pyr_grad_or[i];
-    boost::shared_ptr<bob::ip::base::GradientMaps> gmap = m_gradient_maps[i];
+    const blitz::Array<U,3>& gss = gss_pyr[i];
+    blitz::Array<U,3>& gmag = grad_mag[i];
+    blitz::Array<U,3>& gor = grad_or[i];
+    boost::shared_ptr<bob::ip::base::GradientMaps> gmap = gradient_maps[i];
     for (int s=0; s<gmag.extent(0); ++s)
     {
-      blitz::Array<double,2> gss_s = gss(s+1, rall, rall);
-      blitz::Array<double,2> gmag_s = gmag(s, rall, rall);
-      blitz::Array<double,2> gor_s = gor(s, rall, rall);
+      blitz::Array<U,2> gss_s = gss(s+1, rall, rall);
+      blitz::Array<U,2> gmag_s = gmag(s, rall, rall);
+      blitz::Array<U,2> gor_s = gor(s, rall, rall);
       gmap->process(gss_s, gmag_s, gor_s);
     }
   }
 }
 
-void bob::ip::base::SIFT::computeDescriptor(const std::vector<boost::shared_ptr<bob::ip::base::GSSKeypoint> >& keypoints, blitz::Array<double,4>& dst) const
+void bob::ip::base::SIFT::computeGradient()
 {
-  blitz::Range rall = blitz::Range::all();
-  for (size_t k=0; k<keypoints.size(); ++k)
-  {
-    blitz::Array<double,3> dst_k = dst(k, rall, rall, rall);
+  if (m_single_precision)
+    _gradient(m_gss_pyr_float, m_gss_pyr_grad_mag_float, m_gss_pyr_grad_or_float, m_gradient_maps);
+  else
+    _gradient(m_gss_pyr, m_gss_pyr_grad_mag, m_gss_pyr_grad_or, m_gradient_maps);
+}
+
+void bob::ip::base::SIFT::computeDescriptor(const std::vector<boost::shared_ptr<bob::ip::base::GSSKeypoint> >& keypoints, blitz::Array<double,4>& dst, const int threads) const
+{
+  bob::core::array::assertZeroBase(dst);
+  bob::core::array::assertSameDimensionLength(dst.extent(0), keypoints.size());
+
+  // the descriptors are written through views that do not share the
+  // reference counter of dst, which is used by several threads (see _thread_slice)
+  _parallel_for(keypoints.size(), threads, [&](int k){
+    blitz::Array<double,3> dst_k = _thread_slice(dst, k);
     computeDescriptor(*(keypoints[k]), dst_k);
-  }
+  });
 }
 
 void bob::ip::base::SIFT::computeDescriptor(const bob::ip::base::GSSKeypoint& keypoint, blitz::Array<double,3>& dst) const
@@ -225,18 +307,126 @@ void bob::ip::base::SIFT::computeDescriptor(const bob::ip::base::GSSKeypoint& ke
   computeDescriptor(keypoint, keypoint_info, dst);
 }
 
+/**
+ * The scratch space of the descriptor computation, which is kept per thread,
+ * so that steady-state calls do not allocate memory
+ */
+struct DescriptorWorkspace {
+  std::vector<double> window_y; //< Gaussian window for each integer y-offset of the support
+  std::vector<double> window_x; //< Gaussian window for each integer x-offset of the support
+  std::vector<double> offset_x; //< x-offset of each column of the support wrt. the descriptor center
+  std::vector<double> mag; //< gradient magnitude of the current row
+  std::vector<double> ori; //< gradient orientation of the current row
+  std::vector<double> vote; //< weighted vote of each sample of the current row
+  std::vector<double> ry, rx, ro; //< interpolation weights of each sample of the current row
+  std::vector<int> bin; //< index of the first of the 2x2x2 histogram bins of each sample of the current row
+  std::vector<double> hist; //< padded histogram
+};
+
+static DescriptorWorkspace& _descriptor_workspace()
+{
+  static thread_local DescriptorWorkspace workspace;
+  return workspace;
+}
+
+/**
+ * Computes, for the n samples of a row of the descriptor support, the index
+ * of the first of the 2x2x2 histogram bins, the trilinear interpolation
+ * weights and the weighted vote. The normalized offset of a sample is
+ * (ny0 + ny_dx*dx, nx0 + nx_dx*dx), where dx is its x-offset.
+ * Samples whose bins are all outside of the descriptor get a zero vote into
+ * clamped bins, so that neither the samples nor the votes need branches.
+ * When compiled with AVX2 support (BOB_IP_BASE_AVX2=1 in setup.py), four samples
+ * are processed per iteration, and the remaining ones by the scalar loop.
+ */
+static void _descriptor_samples(DescriptorWorkspace& ws, const int n, const double window_y,
+  const double ny0, const double nx0, const double ny_dx, const double nx_dx,
+  const double orientation, const double bins_per_radian, const int n_blocks, const int n_bins)
+{
+  static const double two_pi = 2.*M_PI;
+  // range of the first spatial bin (before shifting by n_blocks/2), for
+  // which at least one of the two bins is inside of the descriptor
+  const double lo = -1 - n_blocks/2, hi = n_blocks - 1 - n_blocks/2;
+  // strides and offset of the padded histogram (see computeDescriptorTyped)
+  const int stride_x = n_bins+2, stride_y = (n_blocks+2)*stride_x;
+  const int offset = (n_blocks/2+1) * (stride_y+stride_x);
+
+  int i = 0;
+#ifdef __AVX2__
+  const __m256d v_two_pi = _mm256_set1_pd(two_pi), v_zero = _mm256_setzero_pd(), v_half = _mm256_set1_pd(0.5);
+  const __m256d v_orientation = _mm256_set1_pd(orientation), v_bins = _mm256_set1_pd(bins_per_radian);
+  const __m256d v_ny0 = _mm256_set1_pd(ny0), v_nx0 = _mm256_set1_pd(nx0), v_ny_dx = _mm256_set1_pd(ny_dx), v_nx_dx = _mm256_set1_pd(nx_dx);
+  const __m256d v_lo = _mm256_set1_pd(lo), v_hi = _mm256_set1_pd(hi), v_window = _mm256_set1_pd(window_y);
+  const __m128i v_stride_y = _mm_set1_epi32(stride_y), v_stride_x = _mm_set1_epi32(stride_x), v_offset = _mm_set1_epi32(offset);
+  for (; i + 4 <= n; i += 4){
+    // same order of operations as in the loop below
+    __m256d theta = _mm256_sub_pd(_mm256_loadu_pd(&ws.ori[i]), v_orientation);
+    theta = _mm256_add_pd(theta, _mm256_and_pd(_mm256_cmp_pd(theta, v_zero, _CMP_LT_OQ), v_two_pi));
+    theta = _mm256_add_pd(theta, _mm256_and_pd(_mm256_cmp_pd(theta, v_zero, _CMP_LT_OQ), v_two_pi));
+    theta = _mm256_sub_pd(theta, _mm256_and_pd(_mm256_cmp_pd(theta, v_two_pi, _CMP_GE_OQ), v_two_pi));
+    const __m256d dx = _mm256_loadu_pd(&ws.offset_x[i]);
+    const __m256d ny = _mm256_add_pd(v_ny0, _mm256_mul_pd(v_ny_dx, dx));
+    const __m256d nx = _mm256_add_pd(v_nx0, _mm256_mul_pd(v_nx_dx, dx));
+    const __m256d no = _mm256_mul_pd(theta, v_bins);
+    const __m256d fy = _mm256_floor_pd(_mm256_sub_pd(ny, v_half));
+    const __m256d fx = _mm256_floor_pd(_mm256_sub_pd(nx, v_half));
+    const __m256d fo = _mm256_floor_pd(no);
+    _mm256_storeu_pd(&ws.ry[i], _mm256_sub_pd(ny, _mm256_add_pd(fy, v_half)));
+    _mm256_storeu_pd(&ws.rx[i], _mm256_sub_pd(nx, _mm256_add_pd(fx, v_half)));
+    _mm256_storeu_pd(&ws.ro[i], _mm256_sub_pd(no, fo));
+    const __m256d cy = _mm256_min_pd(_mm256_max_pd(fy, v_lo), v_hi);
+    const __m256d cx = _mm256_min_pd(_mm256_max_pd(fx, v_lo), v_hi);
+    const __m256d inside = _mm256_and_pd(_mm256_cmp_pd(cy, fy, _CMP_EQ_OQ), _mm256_cmp_pd(cx, fx, _CMP_EQ_OQ));
+    const __m256d vote = _mm256_mul_pd(_mm256_mul_pd(v_window, _mm256_loadu_pd(&ws.window_x[i])), _mm256_loadu_pd(&ws.mag[i]));
+    _mm256_storeu_pd(&ws.vote[i], _mm256_and_pd(inside, vote));
+    const __m128i bin = _mm_add_epi32(_mm_add_epi32(v_offset, _mm256_cvtpd_epi32(fo)),
+      _mm_add_epi32(_mm_mullo_epi32(_mm256_cvtpd_epi32(cy), v_stride_y), _mm_mullo_epi32(_mm256_cvtpd_epi32(cx), v_stride_x)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&ws.bin[i]), bin);
+  }
+#endif // __AVX2__
+  for (; i < n; ++i){
+    // Angle between keypoint orientation and gradient orientation in [0, 2*pi)
+    double theta = ws.ori[i] - orientation;
+    theta += theta < 0. ? two_pi : 0.;
+    theta += theta < 0. ? two_pi : 0.;
+    theta -= theta >= two_pi ? two_pi : 0.;
+    // Normalized offset wrt. the keypoint orientation, offset and scale
+    const double ny = ny0 + ny_dx * ws.offset_x[i];
+    const double nx = nx0 + nx_dx * ws.offset_x[i];
+    const double no = theta * bins_per_radian;
+    // Indices of the first bins used in the interpolation (see computeDescriptorTyped)
+    const double fy = floor(ny - 0.5), fx = floor(nx - 0.5), fo = floor(no);
+    ws.ry[i] = ny - (fy + 0.5);
+    ws.rx[i] = nx - (fx + 0.5);
+    ws.ro[i] = no - fo;
+    const double cy = std::min(std::max(fy, lo), hi), cx = std::min(std::max(fx, lo), hi);
+    const double vote = window_y * ws.window_x[i] * ws.mag[i];
+    ws.vote[i] = cy == fy && cx == fx ? vote : 0.;
+    ws.bin[i] = offset + (int)fo + (int)cy * stride_y + (int)cx * stride_x;
+  }
+}
+
 void bob::ip::base::SIFT::computeDescriptor(const bob::ip::base::GSSKeypoint& keypoint, const bob::ip::base::GSSKeypointInfo& keypoint_info, blitz::Array<double,3>& dst) const
+{
+  if (m_single_precision)
+    computeDescriptorTyped(m_gss_pyr_grad_mag_float, m_gss_pyr_grad_or_float, keypoint, keypoint_info, dst);
+  else
+    computeDescriptorTyped(m_gss_pyr_grad_mag, m_gss_pyr_grad_or, keypoint, keypoint_info, dst);
+}
+
+template <typename U>
+void bob::ip::base::SIFT::computeDescriptorTyped(const std::vector<blitz::Array<U,3> >& grad_mag, const std::vector<blitz::Array<U,3> >& grad_or,
+  const bob::ip::base::GSSKeypoint& keypoint, const bob::ip::base::GSSKeypointInfo& keypoint_info, blitz::Array<double,3>& dst) const
 {
   // Check output dimensionality
   const blitz::TinyVector<int,3> shape = getDescriptorShape();
   bob::core::array::assertSameShape(dst, shape);
 
-  // Get gradient
-  blitz::Range rall = blitz::Range::all();
+  // Get gradient, through views that can be used by several threads at the same time (see _thread_plane)
   // Index scale has a -1, as the gradients are not computed for scale -1, Ns and Ns+1
   // but the provided index is the one, for which scale -1 corresponds to keypoint_info.s=0.
-  blitz::Array<double,2> gmag = m_gss_pyr_grad_mag[keypoint_info.o](keypoint_info.s-1,rall,rall);
-  blitz::Array<double,2> gor = m_gss_pyr_grad_or[keypoint_info.o](keypoint_info.s-1,rall,rall);
+  const blitz::Array<U,2> gmag = _thread_plane(grad_mag[keypoint_info.o], keypoint_info.s-1);
+  const blitz::Array<U,2> gor = _thread_plane(grad_or[keypoint_info.o], keypoint_info.s-1);
 
   // Dimensions of the image at the octave associated with the keypoint
   const int H = gmag.extent(0);
@@ -273,73 +463,92 @@ void bob::ip::base::SIFT::computeDescriptor(const bob::ip::base::GSSKeypoint& ke
   const int dxmin = std::max(-descr_radius,1-xci);
   const int dxmax = std::min(descr_radius,W-2-xci);
 
-  // Loop over the pixels
-  // Initializes descriptor to zero
-  dst = 0.;
-  for (int dyi=dymin; dyi<=dymax; ++dyi)
+  // The descriptor is accumulated row by row in a local histogram, which
+  // is padded by one block on each side, and by two orientation bins that
+  // are folded onto the first ones, so that the votes need no bounds checks
+  // (see _descriptor_samples)
+  const int n_blocks = m_descr_n_blocks, n_bins = m_descr_n_bins;
+  const int stride_x = n_bins+2, stride_y = (n_blocks+2)*stride_x;
+  DescriptorWorkspace& ws = _descriptor_workspace();
+  ws.hist.assign((n_blocks+2)*stride_y, 0.);
+  double* hist = &ws.hist[0];
+
+  if (dymin <= dymax && dxmin <= dxmax)
+  {
+    // The Gaussian window is separable in the (unrotated) offsets wrt. the
+    // descriptor center, and is tabulated for each integer offset
+    const double inv_hist_width = 1. / hist_width;
+    const int n = dxmax-dxmin+1;
+    ws.window_y.resize(dymax-dymin+1);
+    for (int dyi=dymin; dyi<=dymax; ++dyi)
+    {
+      const double dy = (yci + dyi - yc) * inv_hist_width;
+      ws.window_y[dyi-dymin] = exp(-dy*dy*window_factor);
+    }
+    ws.window_x.resize(n);
+    ws.offset_x.resize(n);
     for (int dxi=dxmin; dxi<=dxmax; ++dxi)
     {
-      // Current integer indices
-      int yi = yci + dyi;
-      int xi = xci + dxi;
-      // Values of the current gradient (magnitude and orientation)
-      double mag = gmag(yi,xi);
-      double ori = gor(yi,xi);
-      // Angle between keypoint orientation and gradient orientation
-      double theta = fmod(ori-keypoint.orientation, two_pi);
-      if (theta < 0.) theta += two_pi;
-      if (theta >= two_pi) theta -= two_pi;
-
-      // Current floating point offset wrt. descriptor center
-      double dy = yi - yc;
-      double dx = xi - xc;
-
-      // Normalized offset wrt. the keypoint orientation, offset and scale
-      double ny = (-sink*dx + cosk*dy) / hist_width;
-      double nx = ( cosk*dx + sink*dy) / hist_width;
-      double no = (theta / two_pi) * m_descr_n_bins;
-
-      // Gaussian weight for the current pixel
-      double window_value = exp(-(nx*nx+ny*ny)*window_factor);
-
-      // Indices of the first bin used in the interpolation
-      // Substract -0.5 before flooring such as the weight rbiny=0.5 when
-      // we are between the two centered pixels (assuming that DESCR_NBLOCKS
-      // is {equal to 4/even}), for which ny=0.
-      // (ny=0-> rbiny=0.5 -> (final) biny = DESCR_NBLOCKS/2-1 (which
-      // corresponds to the left centered pixel)
-      int biny = (int)floor(ny-0.5);
-      int binx = (int)floor(nx-0.5);
-      int bino = (int)floor(no);
-      double rbiny = ny - (biny + 0.5);
-      double rbinx = nx - (binx + 0.5);
-      double rbino = no - bino;
-      // Make indices start at 0
-      biny += m_descr_n_blocks/2;
-      binx += m_descr_n_blocks/2;
-
-      for (int dbiny=0; dbiny<2; ++dbiny)
+      const double dx = xci + dxi - xc;
+      ws.offset_x[dxi-dxmin] = dx;
+      ws.window_x[dxi-dxmin] = exp(-dx*dx*inv_hist_width*inv_hist_width*window_factor);
+    }
+    ws.mag.resize(n); ws.ori.resize(n);
+    ws.vote.resize(n); ws.ry.resize(n); ws.rx.resize(n); ws.ro.resize(n); ws.bin.resize(n);
+
+    // The keypoint orientation in [0, 2*pi)
+    double orientation = fmod(keypoint.orientation, two_pi);
+    if (orientation < 0.) orientation += two_pi;
+
+    const U* mag_data = gmag.data(),* ori_data = gor.data();
+    const int sy = gmag.stride(0), sx = gmag.stride(1);
+    for (int dyi=dymin; dyi<=dymax; ++dyi)
+    {
+      // Gradient (magnitude and orientation) of the current row
+      const int yi = yci + dyi;
+      const U* mag_row = mag_data + yi*sy + (xci+dxmin)*sx,* ori_row = ori_data + yi*sy + (xci+dxmin)*sx;
+      for (int i=0; i<n; ++i)
+      {
+        ws.mag[i] = mag_row[i*sx];
+        ws.ori[i] = ori_row[i*sx];
+      }
+
+      // Rotation of the offset wrt. the keypoint orientation and scale;
+      // the row offset dy is rotated once, and the samples add dx
+      const double dy = (yci + dyi - yc) * inv_hist_width;
+      _descriptor_samples(ws, n, ws.window_y[dyi-dymin], cosk*dy, sink*dy,
+        -sink*inv_hist_width, cosk*inv_hist_width, orientation, n_bins / two_pi, n_blocks, n_bins);
+
+      // Trilinear votes into the 2x2x2 bins of each sample
+      for (int i=0; i<n; ++i)
       {
-        int biny_ = biny+dbiny;
-        if (biny_ >= 0 && biny_ < (int)m_descr_n_blocks)
-        {
-          double wy = ( dbiny==0 ? fabs(1.-rbiny) : fabs(rbiny) );
-          for (int dbinx=0; dbinx<2; ++dbinx)
-          {
-            int binx_ = binx+dbinx;
-            if (binx_ >= 0 && binx_ < (int)m_descr_n_blocks)
-            {
-              double wx = ( dbinx==0 ? fabs(1.-rbinx) : fabs(rbinx) );
-              for (int dbino=0; dbino<2; ++dbino)
-              {
-                double wo = ( dbino==0 ? fabs(1.-rbino) : fabs(rbino) );
-                dst(biny_, binx_, (bino+dbino) % (int)m_descr_n_bins) += window_value * mag * wy * wx * wo;
-              }
-            }
-          }
-        }
+        double* h = hist + ws.bin[i];
+        const double ry = ws.ry[i], rx = ws.rx[i], ro = ws.ro[i];
+        const double w0 = ws.vote[i] * (1.-ry), w1 = ws.vote[i] * ry;
+        const double w00 = w0 * (1.-rx), w01 = w0 * rx, w10 = w1 * (1.-rx), w11 = w1 * rx;
+        h[0] += w00 * (1.-ro);
+        h[1] += w00 * ro;
+        h[stride_x] += w01 * (1.-ro);
+        h[stride_x+1] += w01 * ro;
+        h[stride_y] += w10 * (1.-ro);
+        h[stride_y+1] += w10 * ro;
+        h[stride_y+stride_x] += w11 * (1.-ro);
+        h[stride_y+stride_x+1] += w11 * ro;
       }
     }
+  }
+
+  // Copies the inner blocks of the histogram, and folds the padding
+  // orientation bins onto the first ones
+  for (int by=0; by<n_blocks; ++by)
+    for (int bx=0; bx<n_blocks; ++bx)
+    {
+      const double* h = hist + (by+1)*stride_y + (bx+1)*stride_x;
+      for (int bo=0; bo<n_bins; ++bo)
+        dst(by, bx, bo) = h[bo];
+      for (int bo=n_bins; bo<n_bins+2; ++bo)
+        dst(by, bx, bo % n_bins) += h[bo];
+    }
 
   // Normalization
   double norm = sqrt(blitz::sum(blitz::pow2(dst))) + m_norm_eps;
@@ -8,6 +8,7 @@
  */
 
 #include <bob.ip.base/SelfQuotientImage.h>
+#include <bob.ip.base/Parallel.h>
 
 bob::ip::base::SelfQuotientImage::SelfQuotientImage(
     const size_t n_scales,
@@ -95,3 +96,50 @@ bool bob::ip::base::SelfQuotientImage::operator!=(const bob::ip::base::SelfQuoti
   return !(this->operator==(b));
 }
 
+
+
+bob::ip::base::SelfQuotientImage::Workspace& bob::ip::base::SelfQuotientImage::threadWorkspace()
+{
+  static thread_local Workspace workspace;
+  return workspace;
+}
+
+void bob::ip::base::SelfQuotientImage::process_(const blitz::Array<double,2>& src, blitz::Array<double,2>& dst, Workspace& workspace, const int threads) const
+{
+  bob::core::array::assertZeroBase(src);
+  bob::core::array::assertZeroBase(dst);
+  bob::core::array::assertSameShape(src, dst);
+
+  const int height = src.extent(0), width = src.extent(1);
+  const int n_scales = m_n_scales;
+  if (workspace.smoothed.size() < m_n_scales) workspace.smoothed.resize(m_n_scales);
+  for (int s = 0; s < n_scales; ++s)
+    _resize(workspace.smoothed[s], height, width);
+
+  if (n_scales){
+    // extrapolate once with the largest kernel, and compute the integral image once
+    m_wgaussians[n_scales-1].extrapolate(src, workspace.src_extra, workspace.src_integral);
+    // the scales only read the shared data, and each writes into its own image;
+    // threads that are not required by the scales process bands of rows inside the scales
+    const int band_threads = std::max(1, _thread_count(threads, height) / n_scales);
+    _parallel_for(n_scales, threads, [&](int s){
+      m_wgaussians[s].filterExtrapolated(workspace.src_extra, workspace.src_integral, workspace.smoothed[s], band_threads);
+    });
+  }
+
+  // accumulate the log differences of all scales, computing log(src+1) only once per pixel
+  std::vector<const double*> smoothed(n_scales);
+  for (int y = 0; y < height; ++y){
+    for (int s = 0; s < n_scales; ++s)
+      smoothed[s] = workspace.smoothed[s].data() + y * width;
+    const double* src_row = src.data() + y * src.stride(0);
+    double* dst_row = dst.data() + y * dst.stride(0);
+    for (int x = 0; x < width; ++x){
+      const double log_src = log(src_row[x * src.stride(1)] + 1.);
+      double sum = 0.;
+      for (int s = 0; s < n_scales; ++s)
+        sum += log_src - log(smoothed[s][x] + 1.);
+      dst_row[x * dst.stride(1)] = sum / n_scales;
+    }
+  }
+}
@@ -9,6 +9,8 @@
 
 #include <bob.ip.base/TanTriggs.h>
 
+#include <algorithm>
+
 bob::ip::base::TanTriggs::TanTriggs(
   const double gamma,
   const double sigma0,
@@ -88,26 +90,52 @@ bool bob::ip::base::TanTriggs::operator!=(const bob::ip::base::TanTriggs& b) con
   return !(this->operator==(b));
 }
 
-void bob::ip::base::TanTriggs::performContrastEqualization(blitz::Array<double,2>& dst)
+bob::ip::base::TanTriggs::Workspace& bob::ip::base::TanTriggs::threadWorkspace()
 {
-  const double inv_alpha = 1./m_alpha;
-  const double wxh = dst.extent(0)*dst.extent(1);
+  static thread_local Workspace workspace;
+  return workspace;
+}
+
+void bob::ip::base::TanTriggs::performContrastEqualization(blitz::Array<double,2>& outer, blitz::Array<double,2>& dst) const
+{
+  const int height = dst.extent(0), width = dst.extent(1);
+  const double wxh = height * width;
+  double* dst_data = dst.data(),* outer_data = outer.data();
+  const int dst_sy = dst.stride(0), dst_sx = dst.stride(1), outer_sy = outer.stride(0), outer_sx = outer.stride(1);
 
   // first step: I:=I/mean(abs(I)^a)^(1/a)
-  blitz::Range dst_y( dst.lbound(0), dst.ubound(0)),
-               dst_x( dst.lbound(1), dst.ubound(1));
-  double norm_fact =
-    pow( sum( pow( fabs(dst(dst_y,dst_x)), m_alpha)) / wxh, inv_alpha);
-  dst(dst_y,dst_x) /= norm_fact;
+  // compute the difference of Gaussians, and keep abs(I)^a for the second step
+  double sum = 0.;
+  for (int y = 0; y < height; ++y){
+    double* d = dst_data + y * dst_sy,* o = outer_data + y * outer_sy;
+    for (int x = 0; x < width; ++x, d += dst_sx, o += outer_sx){
+      *d -= *o;
+      *o = pow(fabs(*d), m_alpha);
+      sum += *o;
+    }
+  }
+  const double inv_alpha = 1./m_alpha;
+  const double norm_fact1 = pow(sum / wxh, inv_alpha);
 
   // Second step: I:=I/mean(min(threshold,abs(I))^a)^(1/a)
-  const double threshold_alpha = pow( m_threshold, m_alpha );
-  norm_fact =  pow( sum( min( threshold_alpha,
-    pow( fabs(dst(dst_y,dst_x)), m_alpha))) / wxh, inv_alpha);
-  dst(dst_y,dst_x) /= norm_fact;
-
-  // Last step: I:= threshold * tanh( I / threshold )
-  dst(dst_y,dst_x) = m_threshold * tanh( dst(dst_y,dst_x) / m_threshold );
+  // with abs(I/n)^a = abs(I)^a / n^a
+  const double threshold_alpha = pow(m_threshold, m_alpha);
+  const double scale = wxh / sum;
+  sum = 0.;
+  for (int y = 0; y < height; ++y){
+    const double* o = outer_data + y * outer_sy;
+    for (int x = 0; x < width; ++x, o += outer_sx)
+      sum += std::min(threshold_alpha, *o * scale);
+  }
+  const double norm_fact2 = pow(sum / wxh, inv_alpha);
+
+  // Last step: I:= threshold * tanh( I / threshold ), applying both normalizations at once
+  const double factor = 1. / (norm_fact1 * norm_fact2 * m_threshold);
+  for (int y = 0; y < height; ++y){
+    double* d = dst_data + y * dst_sy;
+    for (int x = 0; x < width; ++x, d += dst_sx)
+      *d = m_threshold * tanh(*d * factor);
+  }
 }
 
 
@@ -138,6 +166,11 @@ void bob::ip::base::TanTriggs::computeDoG(double sigma0, double sigma1, size_t s
   const double inv_sum1 = 1. / blitz::sum(g1);
   m_kernel.resize( size, size);
   m_kernel = inv_sum0 * g0 - inv_sum1 * g1;
+
+  // The DoG filter is applied as the difference of two separable Gaussians
+  const size_t radius = size / 2;
+  m_gaussian0.reset(radius, radius, sigma0, sigma0, m_border_type);
+  m_gaussian1.reset(radius, radius, sigma1, sigma1, m_border_type);
 }
 
 
@@ -0,0 +1,163 @@
+/**
+ * @date Fri Oct 16 10:12:45 CEST 2026
+ * @author Manuel Guenther <manuel.guenther@idiap.ch>
+ *
+ * @brief This file implements a class storing a precomputed geometric normalization
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob.ip.base/WarpMap.h>
+#include <boost/format.hpp>
+#include <stdexcept>
+#include <algorithm>
+
+/**
+ * Computes the fixed-point weights of the two source pixels in one direction.
+ * The upper left pixel is clamped into the image, so that both pixels can always be read;
+ * pixels outside of the image get zero weight.
+ */
+static void _axis_weights(
+  const double position, const int extent, const int bits,
+  int& base, int32_t weights[2], bool positive[2], bool& outside
+){
+  const int one = 1 << bits;
+  const int o = std::floor(position);
+  const double m = position - o;
+  const int f = (int)std::floor(m * one + .5);
+
+  base = std::max(0, std::min(o, extent-2));
+  const int corners[2] = {o, o+1};
+  const int32_t fixed[2] = {one - f, f};
+  const double exact[2] = {1. - m, m};
+
+  weights[0] = weights[1] = 0;
+  positive[0] = positive[1] = false;
+  outside = false;
+  for (int i = 0; i < 2; ++i){
+    if (corners[i] >= 0 && corners[i] < extent){
+      weights[corners[i] - base] += fixed[i];
+      positive[corners[i] - base] = positive[corners[i] - base] || exact[i] > 0.;
+    } else if (exact[i] > 0.){
+      outside = true;
+    }
+  }
+}
+
+bob::ip::base::WarpMap::WarpMap(
+  const GeomNorm& geomNorm,
+  const blitz::TinyVector<int,2>& sourceShape,
+  const blitz::TinyVector<double,2>& center
+):
+  m_sourceShape(sourceShape)
+{
+  init(geomNorm, center);
+}
+
+bob::ip::base::WarpMap::WarpMap(
+  const FaceEyesNorm& faceEyesNorm,
+  const blitz::TinyVector<int,2>& sourceShape,
+  const blitz::TinyVector<double,2>& rightEye,
+  const blitz::TinyVector<double,2>& leftEye
+):
+  m_sourceShape(sourceShape)
+{
+  // configure a copy of the GeomNorm object, so that the given object is left untouched
+  GeomNorm geomNorm(*faceEyesNorm.getGeomNorm());
+  blitz::TinyVector<double,2> center;
+  faceEyesNorm.configure(geomNorm, center, rightEye, leftEye);
+  init(geomNorm, center);
+}
+
+bob::ip::base::WarpMap::WarpMap(const WarpMap& other)
+:
+  m_sourceShape(other.m_sourceShape),
+  m_stepX(other.m_stepX),
+  m_stepY(other.m_stepY),
+  m_offsets(bob::core::array::ccopy(other.m_offsets)),
+  m_weights(bob::core::array::ccopy(other.m_weights)),
+  m_flags(bob::core::array::ccopy(other.m_flags))
+{
+}
+
+bob::ip::base::WarpMap& bob::ip::base::WarpMap::operator=(const bob::ip::base::WarpMap& other)
+{
+  if (this != &other)
+  {
+    m_sourceShape = other.m_sourceShape;
+    m_stepX = other.m_stepX;
+    m_stepY = other.m_stepY;
+    m_offsets.reference(bob::core::array::ccopy(other.m_offsets));
+    m_weights.reference(bob::core::array::ccopy(other.m_weights));
+    m_flags.reference(bob::core::array::ccopy(other.m_flags));
+  }
+  return *this;
+}
+
+bool bob::ip::base::WarpMap::operator==(const bob::ip::base::WarpMap& b) const
+{
+  return m_sourceShape[0] == b.m_sourceShape[0] && m_sourceShape[1] == b.m_sourceShape[1] &&
+         bob::core::array::isEqual(m_offsets, b.m_offsets) &&
+         bob::core::array::isEqual(m_weights, b.m_weights) &&
+         bob::core::array::isEqual(m_flags, b.m_flags);
+}
+
+bool bob::ip::base::WarpMap::operator!=(const bob::ip::base::WarpMap& b) const
+{
+  return !(this->operator==(b));
+}
+
+void bob::ip::base::WarpMap::init(const GeomNorm& geomNorm, const blitz::TinyVector<double,2>& center)
+{
+  if (m_sourceShape[0] < 1 || m_sourceShape[1] < 1) {
+    boost::format m("WarpMap: the source shape (%d, %d) must not be empty");
+    m % m_sourceShape[0] % m_sourceShape[1];
+    throw std::runtime_error(m.str());
+  }
+
+  const blitz::TinyVector<int,2>& size = geomNorm.getCropSize();
+  m_offsets.resize(size);
+  m_weights.resize(size[0], size[1], 4);
+  m_flags.resize(size);
+
+  m_stepX = m_sourceShape[1] > 1 ? 1 : 0;
+  m_stepY = m_sourceShape[0] > 1 ? m_sourceShape[1] : 0;
+
+  // get the source positions exactly as the transform does
+  blitz::TinyVector<double,2> origin, col_step, row_step;
+  _source_steps(
+    center, geomNorm.getCropOffset(),
+    blitz::TinyVector<double,2>(geomNorm.getScalingFactor(), geomNorm.getScalingFactor()),
+    geomNorm.getRotationAngle(),
+    origin, col_step, row_step
+  );
+
+  int by, bx;
+  int32_t wy[2], wx[2];
+  bool py[2], px[2], outside_y, outside_x;
+  for (int y = 0; y < size[0]; ++y){
+    double source_y = origin[0], source_x = origin[1];
+    for (int x = 0; x < size[1]; ++x){
+      _axis_weights(source_y, m_sourceShape[0], WEIGHT_BITS, by, wy, py, outside_y);
+      _axis_weights(source_x, m_sourceShape[1], WEIGHT_BITS, bx, wx, px, outside_x);
+
+      m_offsets(y,x) = by * m_sourceShape[1] + bx;
+      m_weights(y,x,0) = wy[0] * wx[0];
+      m_weights(y,x,1) = wy[0] * wx[1];
+      m_weights(y,x,2) = wy[1] * wx[0];
+      m_weights(y,x,3) = wy[1] * wx[1];
+      m_flags(y,x) =
+          (py[0] && px[0] ? 1 : 0) |
+          (py[0] && px[1] ? 2 : 0) |
+          (py[1] && px[0] ? 4 : 0) |
+          (py[1] && px[1] ? 8 : 0) |
+          (outside_y || outside_x ? 16 : 0);
+
+      // go to the next source pixel in the row
+      source_y += col_step[0];
+      source_x += col_step[1];
+    }
+    // shift the origin to the next line
+    origin += row_step;
+  }
+}
@@ -12,6 +12,7 @@
 #include <stdexcept>
 #include <bob.ip.base/IntegralImage.h>
 #include <bob.ip.base/WeightedGaussian.h>
+#include <bob.ip.base/Parallel.h>
 
 
 bob::ip::base::WeightedGaussian::WeightedGaussian(
@@ -44,7 +45,6 @@ bob::ip::base::WeightedGaussian::WeightedGaussian(const WeightedGaussian& other)
 void bob::ip::base::WeightedGaussian::computeKernel()
 {
   m_kernel.resize(2 * m_radius_y + 1, 2 * m_radius_x + 1);
-  m_kernel_weighted.resize(2 * m_radius_y + 1, 2 * m_radius_x + 1);
   // Computes the kernel
   const double inv_sigma_y = 1.0 / (m_sigma_y*m_sigma_y);
   const double inv_sigma_x = 1.0 / (m_sigma_x*m_sigma_x);
@@ -95,71 +95,111 @@ bool bob::ip::base::WeightedGaussian::operator!=(const bob::ip::base::WeightedGa
   return !(this->operator==(b));
 }
 
-void bob::ip::base::WeightedGaussian::filter_(const blitz::Array<double,2>& src, blitz::Array<double,2>& dst)
+bob::ip::base::WeightedGaussian::Workspace& bob::ip::base::WeightedGaussian::threadWorkspace()
+{
+  static thread_local Workspace workspace;
+  return workspace;
+}
+
+void bob::ip::base::WeightedGaussian::filter_(const blitz::Array<double,2>& src, blitz::Array<double,2>& dst, Workspace& workspace, const int threads) const
 {
-  // Checks input
-  bob::core::array::assertZeroBase(src);
-  bob::core::array::assertZeroBase(dst);
   bob::core::array::assertSameShape(src, dst);
-  if(src.extent(0)<m_kernel.extent(0)) {
-    boost::format m("The convolutional kernel has the first dimension larger than the corresponding one of the array to process (%d > %d). Our convolution code does not allows. You could try to revert the order of the two arrays.");
-    m % src.extent(0) % m_kernel.extent(0);
-    throw std::runtime_error(m.str());
-  }
-  if(src.extent(1)<m_kernel.extent(1)) {
-    boost::format m("The convolutional kernel has the second dimension larger than the corresponding one of the array to process (%d > %d). Our convolution code does not allows. You could try to revert the order of the two arrays.");
-    m % src.extent(1) % m_kernel.extent(1);
-    throw std::runtime_error(m.str());
-  }
+  extrapolate(src, workspace.src_extra, workspace.src_integral);
+  filterExtrapolated(workspace.src_extra, workspace.src_integral, dst, threads);
+}
+
+void bob::ip::base::WeightedGaussian::extrapolate(const blitz::Array<double,2>& src, blitz::Array<double,2>& src_extra, blitz::Array<double,2>& src_integral) const
+{
+  bob::core::array::assertZeroBase(src);
 
   // 1/ Extrapolation of src
   // Resize temporary extrapolated src array
-  blitz::TinyVector<int,2> shape = src.shape();
-  shape(0) += 2 * (int)m_radius_y;
-  shape(1) += 2 * (int)m_radius_x;
-  m_src_extra.resize(shape);
+  _resize(src_extra, src.extent(0) + 2 * (int)m_radius_y, src.extent(1) + 2 * (int)m_radius_x);
 
   // Extrapolate
   if(m_conv_border == bob::sp::Extrapolation::Zero)
-    bob::sp::extrapolateZero(src, m_src_extra);
+    bob::sp::extrapolateZero(src, src_extra);
   else if(m_conv_border == bob::sp::Extrapolation::NearestNeighbour)
-    bob::sp::extrapolateNearest(src, m_src_extra);
+    bob::sp::extrapolateNearest(src, src_extra);
   else if(m_conv_border == bob::sp::Extrapolation::Circular)
-    bob::sp::extrapolateCircular(src, m_src_extra);
+    bob::sp::extrapolateCircular(src, src_extra);
   else
-    bob::sp::extrapolateMirror(src, m_src_extra);
+    bob::sp::extrapolateMirror(src, src_extra);
 
   // 2/ Integral image then mean values
-  shape += 1;
-  m_src_integral.resize(shape);
-  bob::ip::base::integral(m_src_extra, m_src_integral, true);
-
-  // 3/ Convolution
-  double n_elem = m_kernel.numElements();
-  for(int y=0; y<src.extent(0); ++y)
-    for(int x=0; x<src.extent(1); ++x)
-    {
-      // Computes the threshold associated to the current location
-      // Integral image is used to speed up the process
-      blitz::Array<double,2> src_slice = m_src_extra(
-        blitz::Range(y,y+2*(int)m_radius_y), blitz::Range(x,x+2*(int)m_radius_x));
-      double threshold = (m_src_integral(y,x) +
-          m_src_integral(y+2*(int)m_radius_y+1,x+2*(int)m_radius_x+1) -
-          m_src_integral(y,x+2*(int)m_radius_x+1) -
-          m_src_integral(y+2*(int)m_radius_y+1,x)
-        ) / n_elem;
-      // Computes the weighted Gaussian kernel at this location
-      // a/ M1 is the set of pixels whose values are above the threshold
-      if( blitz::sum(src_slice >= threshold) >= n_elem/2.)
-        m_kernel_weighted = blitz::where(src_slice >= threshold, m_kernel, 0.);
-      // b/ M1 is the set of pixels whose values are below the threshold
-      else
-        m_kernel_weighted = blitz::where(src_slice < threshold, m_kernel, 0.);
-      // Normalizes the kernel
-      m_kernel_weighted /= blitz::sum(m_kernel_weighted);
-      // Convolves: This is indeed not a real convolution but a multiplication,
-      // as it seems that the authors aim at exclusively using the M1 part
-      dst(y,x) = blitz::sum(src_slice * m_kernel_weighted);
-    }
+  _resize(src_integral, src_extra.extent(0) + 1, src_extra.extent(1) + 1);
+  bob::ip::base::integral(src_extra, src_integral, true);
 }
 
+void bob::ip::base::WeightedGaussian::filterExtrapolated(const blitz::Array<double,2>& src_extra, const blitz::Array<double,2>& src_integral, blitz::Array<double,2>& dst, const int threads) const
+{
+  // Checks input
+  bob::core::array::assertZeroBase(src_extra);
+  bob::core::array::assertZeroBase(src_integral);
+  bob::core::array::assertZeroBase(dst);
+  if(dst.extent(0)<m_kernel.extent(0)) {
+    boost::format m("The convolutional kernel has the first dimension larger than the corresponding one of the array to process (%d > %d). Our convolution code does not allows. You could try to revert the order of the two arrays.");
+    m % dst.extent(0) % m_kernel.extent(0);
+    throw std::runtime_error(m.str());
+  }
+  if(dst.extent(1)<m_kernel.extent(1)) {
+    boost::format m("The convolutional kernel has the second dimension larger than the corresponding one of the array to process (%d > %d). Our convolution code does not allows. You could try to revert the order of the two arrays.");
+    m % dst.extent(1) % m_kernel.extent(1);
+    throw std::runtime_error(m.str());
+  }
+  // the offset of our windows in the (possibly larger) extrapolated image
+  const int offset_y = (src_extra.extent(0) - dst.extent(0)) / 2 - (int)m_radius_y;
+  const int offset_x = (src_extra.extent(1) - dst.extent(1)) / 2 - (int)m_radius_x;
+  if (offset_y < 0 || offset_x < 0 || src_integral.extent(0) != src_extra.extent(0) + 1 || src_integral.extent(1) != src_extra.extent(1) + 1) {
+    boost::format m("The extrapolated image of shape (%d, %d) is too small for images of shape (%d, %d) and kernels of radius (%d, %d), or the integral image does not match.");
+    m % src_extra.extent(0) % src_extra.extent(1) % dst.extent(0) % dst.extent(1) % m_radius_y % m_radius_x;
+    throw std::runtime_error(m.str());
+  }
+
+  // 3/ Convolution, in bands of rows that are distributed over the threads
+  const int height = dst.extent(0), width = dst.extent(1);
+  const int kernel_height = m_kernel.extent(0), kernel_width = m_kernel.extent(1);
+  const int extra_sy = src_extra.stride(0), extra_sx = src_extra.stride(1);
+  const int integral_sy = src_integral.stride(0), integral_sx = src_integral.stride(1);
+  const double* kernel = m_kernel.data();
+  const double* extra = src_extra.data() + offset_y * extra_sy + offset_x * extra_sx;
+  const double* integral = src_integral.data() + offset_y * integral_sy + offset_x * integral_sx;
+  double* dst_data = dst.data();
+  const int dst_sy = dst.stride(0), dst_sx = dst.stride(1);
+  const double n_elem = m_kernel.numElements();
+  const int band = 8;
+
+  _parallel_for((height + band - 1) / band, threads, [&](int b){
+    for(int y = b * band; y < std::min(height, (b+1) * band); ++y){
+      const double* integral_top = integral + y * integral_sy;
+      const double* integral_bottom = integral + (y + kernel_height) * integral_sy;
+      for(int x = 0; x < width; ++x)
+      {
+        // Computes the threshold associated to the current location
+        // Integral image is used to speed up the process
+        const double threshold = (integral_top[x * integral_sx] + integral_bottom[(x + kernel_width) * integral_sx] - integral_top[(x + kernel_width) * integral_sx] - integral_bottom[x * integral_sx]) / n_elem;
+        // Computes, in a single pass over the window, the number of pixels above the threshold,
+        // and the kernel weights and weighted pixel values of the pixels below [0] and above [1] the threshold
+        int n_above = 0;
+        double weight[2] = {0., 0.}, value[2] = {0., 0.};
+        for(int i = 0; i < kernel_height; ++i){
+          const double* window = extra + (y + i) * extra_sy + x * extra_sx;
+          const double* kernel_row = kernel + i * kernel_width;
+          for(int j = 0; j < kernel_width; ++j){
+            const double pixel = window[j * extra_sx];
+            const int above = pixel >= threshold;
+            n_above += above;
+            weight[above] += kernel_row[j];
+            value[above] += kernel_row[j] * pixel;
+          }
+        }
+        // M1 is the set of pixels whose values are above the threshold, if these are the majority,
+        // or the set of pixels whose values are below the threshold otherwise.
+        // This is indeed not a real convolution but a multiplication with the kernel normalized on M1,
+        // as it seems that the authors aim at exclusively using the M1 part
+        const int m1 = n_above >= n_elem/2. ? 1 : 0;
+        dst_data[y * dst_sy + x * dst_sx] = value[m1] / weight[m1];
+      }
+    }
+  });
+}
@@ -8,6 +8,7 @@
  */
 
 #include <bob.core/array_copy.h>
+#include <bob.core/assert.h>
 #include <bob.core/cast.h>
 #include <bob.ip.base/Wiener.h>
 #include <complex>
@@ -16,11 +17,7 @@ bob::ip::base::Wiener::Wiener(const blitz::Array<double,2>& Ps, const double Pn,
 : m_Ps(bob::core::array::ccopy(Ps)),
   m_variance_threshold(variance_threshold),
   m_Pn(Pn),
-  m_W(m_Ps.extent(0),m_Ps.extent(1)),
-  m_fft(m_Ps.extent(0),m_Ps.extent(1)),
-  m_ifft(m_Ps.extent(0),m_Ps.extent(1)),
-  m_buffer1(m_Ps.extent(0),m_Ps.extent(1)),
-  m_buffer2(m_Ps.extent(0),m_Ps.extent(1))
+  m_W(m_Ps.extent(0),m_Ps.extent(1))
 {
   computeW();
 }
@@ -29,10 +26,7 @@ bob::ip::base::Wiener::Wiener(const blitz::TinyVector<int,2>& size, const double
 : m_Ps(size),
   m_variance_threshold(variance_threshold),
   m_Pn(Pn),
-  m_W(size),
-  m_fft(size[0], size[1]),
-  m_ifft(size[0], size[1]),
-  m_buffer1(0,0), m_buffer2(0,0)
+  m_W(size)
 {
   m_Ps = 1.;
   computeW();
@@ -48,12 +42,9 @@ bob::ip::base::Wiener::Wiener(const bob::ip::base::Wiener& other)
 : m_Ps(bob::core::array::ccopy(other.m_Ps)),
   m_variance_threshold(other.m_variance_threshold),
   m_Pn(other.m_Pn),
-  m_W(bob::core::array::ccopy(other.m_W)),
-  m_fft(other.m_fft),
-  m_ifft(other.m_ifft),
-  m_buffer1(m_Ps.extent(0),m_Ps.extent(1)),
-  m_buffer2(m_Ps.extent(0),m_Ps.extent(1))
+  m_W(bob::core::array::ccopy(other.m_W))
 {
+  computeHalfW();
 }
 
 bob::ip::base::Wiener::Wiener(bob::io::base::HDF5File& config){
@@ -67,10 +58,7 @@ bob::ip::base::Wiener& bob::ip::base::Wiener::operator=(const bob::ip::base::Wie
     m_Pn = other.m_Pn;
     m_variance_threshold = other.m_variance_threshold;
     m_W.reference(bob::core::array::ccopy(other.m_W));
-    m_fft.setShape(m_Ps.extent(0),m_Ps.extent(1));
-    m_ifft.setShape(m_Ps.extent(0),m_Ps.extent(1));
-    m_buffer1.resize(m_Ps.shape());
-    m_buffer2.resize(m_Ps.shape());
+    computeHalfW();
   }
   return *this;
 }
@@ -99,19 +87,13 @@ void bob::ip::base::Wiener::load(bob::io::base::HDF5File& config){
   m_Pn = config.read<double>("Pn");
   m_variance_threshold = config.read<double>("variance_threshold");
   m_W.reference(config.readArray<double,2>("W"));
-  m_fft.setShape(m_Ps.extent(0),m_Ps.extent(1));
-  m_ifft.setShape(m_Ps.extent(0),m_Ps.extent(1));
-  m_buffer1.resize(m_Ps.shape());
-  m_buffer2.resize(m_Ps.shape());
+  computeHalfW();
 }
 
 void bob::ip::base::Wiener::resize(const blitz::TinyVector<int,2>& size){
   m_Ps.resizeAndPreserve(size);
   m_W.resizeAndPreserve(size);
-  m_fft.setShape(size[0], size[1]);
-  m_ifft.setShape(size[0], size[1]);
-  m_buffer1.resizeAndPreserve(size);
-  m_buffer2.resizeAndPreserve(size);
+  computeHalfW();
 }
 
 void bob::ip::base::Wiener::save(bob::io::base::HDF5File& config) const{
@@ -122,52 +104,130 @@ void bob::ip::base::Wiener::save(bob::io::base::HDF5File& config) const{
 }
 
 void bob::ip::base::Wiener::train(const blitz::Array<double,3>& ar){
-  // Data is checked now and conforms, just proceed w/o any further checks.
-  const size_t n_samples = ar.extent(0);
-  const size_t height = ar.extent(1);
-  const size_t width = ar.extent(2);
+  WienerTrainer trainer(blitz::TinyVector<int,2>(ar.extent(1), ar.extent(2)));
+  trainer.add(ar);
+  train(trainer);
+}
 
+void bob::ip::base::Wiener::train(const WienerTrainer& trainer){
   // resize with the new dimensions
-  resize(blitz::TinyVector<int,2>(height, width));
-
-  // Loads the data
-  blitz::Array<double,3> data(height, width, n_samples);
-  blitz::Array<std::complex<double>,2> sample_fft(height, width);
-  blitz::Range all = blitz::Range::all();
-  for (size_t i=0; i<n_samples; ++i) {
-    blitz::Array<double,2> sample = ar(i,all,all);
-    blitz::Array<std::complex<double>,2> sample_c = bob::core::array::cast<std::complex<double> >(sample);
-    m_fft(sample_c, sample_fft);
-    data(all,all,i) = blitz::abs(sample_fft);
-  }
-  // Computes the mean of the training data
-  blitz::Array<double,2> tmp(height,width);
-  blitz::thirdIndex k;
-  tmp = blitz::mean(data,k);
-  // Removes the mean from the data
-  for (size_t i=0; i<n_samples; ++i) {
-    data(all,all,i) -= tmp;
-  }
-  // Computes power of 2 values
-  data *= data;
-  // Sums to get the variance
-  tmp = blitz::sum(data,k) / n_samples;
+  resize(trainer.getSize());
 
   // sets the Wiener filter with the results:
-  setPs(tmp);
+  setPs(trainer.getVariance());
 }
 
 void bob::ip::base::Wiener::computeW(){
   // W = 1 / (1 + Pn / Ps_thresholded)
   m_W = 1. / (1. + m_Pn / m_Ps);
+  computeHalfW();
+}
+
+void bob::ip::base::Wiener::computeHalfW(){
+  const int height = m_W.extent(0), width = m_W.extent(1), half = width / 2;
+  m_W_half.resize(0, 0);
+  m_twiddle.clear();
+  if (width < 2 || width % 2) return;
+
+  // the spectrum of a real image is only filtered in the same way as the full spectrum,
+  // when W is symmetric; W is not stored (or computed) in the same way for both halves,
+  // so that a relative difference in the order of numerical precision is accepted
+  for (int y = 0; y < height; ++y)
+    for (int x = 0; x < width; ++x)
+      if (!bob::core::isClose(m_W(y,x), m_W((height - y) % height, (width - x) % width), 1e-10, 1e-14))
+        return;
+
+  m_W_half.resize(height, half + 1);
+  m_W_half = m_W(blitz::Range::all(), blitz::Range(0, half));
+  m_twiddle.resize(half + 1);
+  for (int x = 0; x <= half; ++x)
+    m_twiddle[x] = std::polar(1., -2. * M_PI * x / width);
+}
+
+
+bob::ip::base::Wiener::Workspace& bob::ip::base::Wiener::threadWorkspace(){
+  static thread_local Workspace workspace;
+  return workspace;
+}
+
+/**
+ * Sets the shape of the given FFT, unless it already has that shape
+ */
+template <typename FFT>
+static void _set_shape(FFT& fft, const int height, const int width){
+  if ((int)fft.getHeight() != height || (int)fft.getWidth() != width) fft.setShape(height, width);
+}
+
+static void _resize(blitz::Array<std::complex<double>,2>& array, const int height, const int width){
+  if (array.extent(0) != height || array.extent(1) != width) array.resize(height, width);
+}
+
+void bob::ip::base::Wiener::filter_(const blitz::Array<double,2>& input, blitz::Array<double,2>& output, Workspace& workspace) const{
+  if (m_W_half.size())
+    filterReal(input, output, workspace);
+  else
+    filterComplex(input, output, workspace);
 }
 
+void bob::ip::base::Wiener::filterComplex(const blitz::Array<double,2>& input, blitz::Array<double,2>& output, Workspace& workspace) const{
+  const int height = m_W.extent(0), width = m_W.extent(1);
+  _set_shape(workspace.fft, height, width);
+  _set_shape(workspace.ifft, height, width);
+  _resize(workspace.signal, height, width);
+  _resize(workspace.spectrum, height, width);
 
-void bob::ip::base::Wiener::filter_(const blitz::Array<double,2>& input, blitz::Array<double,2>& output) const{
-  m_fft(bob::core::array::cast<std::complex<double> >(input), m_buffer1);
-  m_buffer1 *= m_W;
-  m_ifft(m_buffer1, m_buffer2);
-  output = blitz::abs(m_buffer2);
+  for (int y = 0; y < height; ++y)
+    for (int x = 0; x < width; ++x)
+      workspace.signal(y,x) = input(y,x);
+  workspace.fft(workspace.signal, workspace.spectrum);
+  workspace.spectrum *= m_W;
+  workspace.ifft(workspace.spectrum, workspace.signal);
+  for (int y = 0; y < height; ++y)
+    for (int x = 0; x < width; ++x)
+      output(y,x) = std::abs(workspace.signal(y,x));
+}
+
+void bob::ip::base::Wiener::filterReal(const blitz::Array<double,2>& input, blitz::Array<double,2>& output, Workspace& workspace) const{
+  const int height = m_W.extent(0), half = m_W.extent(1) / 2;
+  _set_shape(workspace.fft, height, half);
+  _set_shape(workspace.ifft, height, half);
+  _resize(workspace.signal, height, half);
+  _resize(workspace.spectrum, height, half);
+  blitz::Array<std::complex<double>,2>& packed = workspace.signal;
+  blitz::Array<std::complex<double>,2>& spectrum = workspace.spectrum;
+  const std::complex<double> i(0., 1.);
+
+  // pack the even and odd columns into the real and imaginary parts, and transform them at once
+  for (int y = 0; y < height; ++y)
+    for (int x = 0; x < half; ++x)
+      packed(y,x) = std::complex<double>(input(y,2*x), input(y,2*x+1));
+  workspace.fft(packed, spectrum);
+
+  // the spectrum of the input at the frequency (y,x) with x in [0, half], split from the packed spectrum Z:
+  // the spectra of the even and odd columns are E = (Z(y,x) + Z*(-y,-x)) / 2 and O = (Z(y,x) - Z*(-y,-x)) / 2i
+  auto input_spectrum = [&](const int y, const int x){
+    const std::complex<double> z = spectrum(y, x % half), z_mirror = std::conj(spectrum((height - y) % height, (half - x % half) % half));
+    return 0.5 * (z + z_mirror) - 0.5 * i * m_twiddle[x] * (z - z_mirror);
+  };
+
+  // filter the spectrum and pack it again, using the symmetry of the spectrum of the (real) result:
+  // the spectrum at frequency (y, x + half) is the conjugate of the spectrum at (-y, half - x)
+  for (int y = 0; y < height; ++y){
+    const int y_mirror = (height - y) % height;
+    for (int x = 0; x < half; ++x){
+      const std::complex<double> low = m_W_half(y, x) * input_spectrum(y, x);
+      const std::complex<double> high = std::conj(m_W_half(y_mirror, half - x) * input_spectrum(y_mirror, half - x));
+      packed(y,x) = 0.5 * (low + high) + 0.5 * i * std::conj(m_twiddle[x]) * (low - high);
+    }
+  }
+
+  // transform back, and unpack the even and odd columns
+  workspace.ifft(packed, spectrum);
+  for (int y = 0; y < height; ++y)
+    for (int x = 0; x < half; ++x){
+      output(y,2*x) = std::abs(spectrum(y,x).real());
+      output(y,2*x+1) = std::abs(spectrum(y,x).imag());
+    }
 }
 
 void bob::ip::base::Wiener::filter(const blitz::Array<double,2>& input, blitz::Array<double,2>& output) const{
@@ -194,6 +254,19 @@ void bob::ip::base::Wiener::filter(const blitz::Array<double,2>& input, blitz::A
   filter_(input, output);
 }
 
+void bob::ip::base::Wiener::filter(const blitz::Array<double,3>& input, blitz::Array<double,3>& output, const int threads) const{
+  bob::core::array::assertSameShape(input, output);
+  if (m_W.extent(0) != input.extent(1) || m_W.extent(1) != input.extent(2)) { //checks input
+    boost::format m("shape of the input images (%d, %d) is not compatible with internal weight matrix (%d, %d)");
+    m % input.extent(1) % input.extent(2) % m_W.extent(0) % m_W.extent(1);
+    throw std::runtime_error(m.str());
+  }
+  _parallel_for(input.extent(0), threads, [&](int i){
+    blitz::Array<double,2> dst = _thread_plane(output, i);
+    filter_(_thread_plane(input, i), dst, threadWorkspace());
+  });
+}
+
 void bob::ip::base::Wiener::setVarianceThreshold(const double variance_threshold){
   m_variance_threshold = variance_threshold;
   applyVarianceThreshold();
@@ -218,3 +291,106 @@ void bob::ip::base::Wiener::setPs(const blitz::Array<double,2>& Ps){
 void bob::ip::base::Wiener::applyVarianceThreshold(){
   m_Ps = blitz::where(m_Ps < m_variance_threshold, m_variance_threshold, m_Ps);
 }
+
+
+bob::ip::base::WienerTrainer::WienerTrainer(const blitz::TinyVector<int,2>& size)
+: m_count(0),
+  m_mean(size),
+  m_m2(size),
+  m_fft(size[0], size[1]),
+  m_signal(size),
+  m_spectrum(size)
+{
+  reset();
+}
+
+bob::ip::base::WienerTrainer::WienerTrainer(const bob::ip::base::WienerTrainer& other)
+: m_count(other.m_count),
+  m_mean(bob::core::array::ccopy(other.m_mean)),
+  m_m2(bob::core::array::ccopy(other.m_m2)),
+  m_fft(other.m_fft),
+  m_signal(other.m_signal.shape()),
+  m_spectrum(other.m_spectrum.shape())
+{
+}
+
+bob::ip::base::WienerTrainer& bob::ip::base::WienerTrainer::operator=(const bob::ip::base::WienerTrainer& other){
+  if (this != &other)
+  {
+    m_count = other.m_count;
+    m_mean.reference(bob::core::array::ccopy(other.m_mean));
+    m_m2.reference(bob::core::array::ccopy(other.m_m2));
+    m_fft.setShape(m_mean.extent(0), m_mean.extent(1));
+    m_signal.resize(m_mean.shape());
+    m_spectrum.resize(m_mean.shape());
+  }
+  return *this;
+}
+
+void bob::ip::base::WienerTrainer::reset(){
+  m_count = 0;
+  m_mean = 0.;
+  m_m2 = 0.;
+}
+
+void bob::ip::base::WienerTrainer::add(const blitz::Array<double,2>& sample){
+  bob::core::array::assertSameShape(sample, m_mean);
+  const int height = m_mean.extent(0), width = m_mean.extent(1);
+  for (int y = 0; y < height; ++y)
+    for (int x = 0; x < width; ++x)
+      m_signal(y,x) = sample(y,x);
+  m_fft(m_signal, m_spectrum);
+
+  // Welford's update of mean and sum of squared differences
+  ++m_count;
+  const double inv_count = 1. / m_count;
+  for (int y = 0; y < height; ++y)
+    for (int x = 0; x < width; ++x){
+      const double value = std::abs(m_spectrum(y,x));
+      const double delta = value - m_mean(y,x);
+      m_mean(y,x) += delta * inv_count;
+      m_m2(y,x) += delta * (value - m_mean(y,x));
+    }
+}
+
+void bob::ip::base::WienerTrainer::add(const blitz::Array<double,3>& samples, const int threads){
+  const int n_samples = samples.extent(0);
+  const int n_parts = _thread_count(threads, n_samples);
+  if (n_parts == 1){
+    for (int i = 0; i < n_samples; ++i)
+      add(_thread_plane(samples, i));
+    return;
+  }
+
+  // accumulate consecutive parts of the samples in separate trainers, and merge them in order
+  std::vector<WienerTrainer> parts(n_parts, WienerTrainer(getSize()));
+  _parallel_for(n_parts, n_parts, [&](int p){
+    for (int i = p * n_samples / n_parts; i < (p+1) * n_samples / n_parts; ++i)
+      parts[p].add(_thread_plane(samples, i));
+  });
+  for (int p = 0; p < n_parts; ++p)
+    merge(parts[p]);
+}
+
+void bob::ip::base::WienerTrainer::merge(const bob::ip::base::WienerTrainer& other){
+  bob::core::array::assertSameShape(other.m_mean, m_mean);
+  if (!other.m_count) return;
+  // combine mean and sum of squared differences of both parts, see:
+  // T.F. Chan, G.H. Golub and R.J. LeVeque, "Updating formulae and a pairwise algorithm for computing sample variances", 1979
+  const double count = m_count + other.m_count;
+  const double weight = other.m_count / count, weight2 = m_count * weight;
+  for (int y = 0; y < m_mean.extent(0); ++y)
+    for (int x = 0; x < m_mean.extent(1); ++x){
+      const double delta = other.m_mean(y,x) - m_mean(y,x);
+      m_mean(y,x) += delta * weight;
+      m_m2(y,x) += other.m_m2(y,x) + delta * delta * weight2;
+    }
+  m_count += other.m_count;
+}
+
+blitz::Array<double,2> bob::ip::base::WienerTrainer::getVariance() const{
+  if (!m_count) throw std::runtime_error("the variance cannot be computed, since no training images have been added");
+  blitz::Array<double,2> variance(m_m2.shape());
+  variance = m_m2 / m_count;
+  return variance;
+}
@@ -344,7 +344,7 @@ static auto extract = bob::extension::FunctionDoc(
 .add_prototype("input, output, right_eye, left_eye")
 .add_prototype("input, input_mask, output, output_mask, right_eye, left_eye")
 .add_parameter("input", "array_like (2D or 3D)", "The input image to which FaceEyesNorm should be applied")
-.add_parameter("output", "array_like (2D or 3D, float)", "The output image, which must be of size :py:attr:`crop_size`")
+.add_parameter("output", "array_like (2D or 3D, float, float32 or uint8)", "The output image, which must be of size :py:attr:`crop_size`; for ``uint8``, the values are rounded and saturated")
 .add_parameter("right_eye", "(float, float)", "The position of the right eye (or another landmark) in ``input`` image coordinates.")
 .add_parameter("left_eye", "(float, float)", "The position of the left eye (or another landmark) in ``input`` image coordinates.")
 .add_parameter("input_mask", "array_like (2D, bool)", "An input mask of valid pixels before geometric normalization, must be of same size as ``input``")
@@ -352,28 +352,33 @@ static auto extract = bob::extension::FunctionDoc(
 .add_return("output", "array_like(2D or 3D, float)", "The resulting normalized face image, which is of size :py:attr:`crop_size`")
 ;
 
-template <typename T>
+template <typename T, typename U>
 static void extract_inner(PyBobIpBaseFaceEyesNormObject* self, PyBlitzArrayObject* input, PyBlitzArrayObject* input_mask, PyBlitzArrayObject* output, PyBlitzArrayObject* output_mask, const blitz::TinyVector<double,2>& right, const blitz::TinyVector<double,2>& left){
   if (input->ndim == 3){
-    auto a = blitz::Range::all();
-    for (int i = 0; i < input->shape[0]; ++i){
-      const blitz::Array<T,2> in = (*PyBlitzArrayCxx_AsBlitz<T,3>(input))(i,a,a);
-      blitz::Array<double,2> out = (*PyBlitzArrayCxx_AsBlitz<double,3>(output))(i,a,a);
-      if (input_mask && output_mask){
-        self->cxx->extract(in, *PyBlitzArrayCxx_AsBlitz<bool,2>(input_mask), out, *PyBlitzArrayCxx_AsBlitz<bool,2>(output_mask), right, left);
-      } else {
-        self->cxx->extract(in, out, right, left);
-      }
+    // all color planes are processed at once
+    if (input_mask && output_mask){
+      self->cxx->extract(*PyBlitzArrayCxx_AsBlitz<T,3>(input), *PyBlitzArrayCxx_AsBlitz<bool,2>(input_mask), *PyBlitzArrayCxx_AsBlitz<U,3>(output), *PyBlitzArrayCxx_AsBlitz<bool,2>(output_mask), right, left);
+    } else {
+      self->cxx->extract(*PyBlitzArrayCxx_AsBlitz<T,3>(input), *PyBlitzArrayCxx_AsBlitz<U,3>(output), right, left);
     }
   } else {
     if (input_mask && output_mask){
-      self->cxx->extract(*PyBlitzArrayCxx_AsBlitz<T,2>(input), *PyBlitzArrayCxx_AsBlitz<bool,2>(input_mask), *PyBlitzArrayCxx_AsBlitz<double,2>(output), *PyBlitzArrayCxx_AsBlitz<bool,2>(output_mask), right, left);
+      self->cxx->extract(*PyBlitzArrayCxx_AsBlitz<T,2>(input), *PyBlitzArrayCxx_AsBlitz<bool,2>(input_mask), *PyBlitzArrayCxx_AsBlitz<U,2>(output), *PyBlitzArrayCxx_AsBlitz<bool,2>(output_mask), right, left);
     } else {
-      self->cxx->extract(*PyBlitzArrayCxx_AsBlitz<T,2>(input), *PyBlitzArrayCxx_AsBlitz<double,2>(output), right, left);
+      self->cxx->extract(*PyBlitzArrayCxx_AsBlitz<T,2>(input), *PyBlitzArrayCxx_AsBlitz<U,2>(output), right, left);
     }
   }
 }
 
+template <typename T>
+static void extract_inner1(PyBobIpBaseFaceEyesNormObject* self, PyBlitzArrayObject* input, PyBlitzArrayObject* input_mask, PyBlitzArrayObject* output, PyBlitzArrayObject* output_mask, const blitz::TinyVector<double,2>& right, const blitz::TinyVector<double,2>& left){
+  switch (output->type_num){
+    case NPY_FLOAT32: extract_inner<T,float>(self, input, input_mask, output, output_mask, right, left); break;
+    case NPY_UINT8:   extract_inner<T,uint8_t>(self, input, input_mask, output, output_mask, right, left); break;
+    default:          extract_inner<T,double>(self, input, input_mask, output, output_mask, right, left); break;
+  }
+}
+
 static PyObject* PyBobIpBaseFaceEyesNorm_extract(PyBobIpBaseFaceEyesNormObject* self, PyObject* args, PyObject* kwargs) {
   BOB_TRY
   char** kwlist1 = extract.kwlist(0);
@@ -434,9 +439,9 @@ static PyObject* PyBobIpBaseFaceEyesNorm_extract(PyBobIpBaseFaceEyesNormObject*
       PyErr_Format(PyExc_TypeError, "'%s' the 'output' array must have the same number of dimensions as 'input' (2D or 3D)", Py_TYPE(self)->tp_name);
       return 0;
     }
-    if (output->type_num != NPY_FLOAT64){
+    if (output->type_num != NPY_FLOAT64 && output->type_num != NPY_FLOAT32 && output->type_num != NPY_UINT8){
       extract.print_usage();
-      PyErr_Format(PyExc_TypeError, "'%s': the 'output' array must be of type float64", Py_TYPE(self)->tp_name);
+      PyErr_Format(PyExc_TypeError, "'%s': the 'output' array must be of type float64, float32 or uint8", Py_TYPE(self)->tp_name);
       return 0;
     }
   } else {
@@ -467,9 +472,9 @@ static PyObject* PyBobIpBaseFaceEyesNorm_extract(PyBobIpBaseFaceEyesNormObject*
 
   // finally, process the data
   switch (input->type_num){
-    case NPY_UINT8:   extract_inner<uint8_t>(self, input, input_mask, output, output_mask, right, left); break;
-    case NPY_UINT16:  extract_inner<uint16_t>(self, input, input_mask, output, output_mask, right, left); break;
-    case NPY_FLOAT64: extract_inner<double>(self, input, input_mask, output, output_mask, right, left); break;
+    case NPY_UINT8:   extract_inner1<uint8_t>(self, input, input_mask, output, output_mask, right, left); break;
+    case NPY_UINT16:  extract_inner1<uint16_t>(self, input, input_mask, output, output_mask, right, left); break;
+    case NPY_FLOAT64: extract_inner1<double>(self, input, input_mask, output, output_mask, right, left); break;
     default:
       PyErr_Format(PyExc_TypeError, "`%s' input array of type %s are currently not supported", Py_TYPE(self)->tp_name, PyBlitzArray_TypenumAsString(input->type_num));
       extract.print_usage();
@@ -485,6 +490,157 @@ static PyObject* PyBobIpBaseFaceEyesNorm_extract(PyBobIpBaseFaceEyesNormObject*
   BOB_CATCH_MEMBER("cannot extract face from image", 0)
 }
 
+static auto extractBatch = bob::extension::FunctionDoc(
+  "extract_batch",
+  "This function extracts and normalizes a batch of facial images in parallel",
+  "Each gray image is normalized as in :py:meth:`extract`, using the eye positions in the according row of ``eyes``. "
+  "The images are distributed over the given number of threads, which run without holding the global interpreter lock.\n\n"
+  ".. note::\n\n  In contrast to :py:meth:`extract`, the :py:attr:`last_angle`, :py:attr:`last_scale` and :py:attr:`last_offset` are not updated.",
+  true
+)
+.add_prototype("inputs, eyes, [output], [threads]", "output")
+.add_parameter("inputs", "array_like (3D) or [array_like (2D)]", "A stack of gray images, or a list of gray images of the same data type, which might differ in size")
+.add_parameter("eyes", "array_like (2D, float)", "The positions of the eyes (or other landmarks) in ``inputs`` image coordinates, one row ``(right_y, right_x, left_y, left_x)`` for each image")
+.add_parameter("output", "array_like (3D, float, float32 or uint8)", "The normalized faces, which must be of size ``(len(inputs), crop_size[0], crop_size[1])``; for ``uint8``, the values are rounded and saturated")
+.add_parameter("threads", "int", "[default: 1] The number of threads to use; ``0`` uses one thread per CPU core")
+.add_return("output", "array_like(3D, float)", "The resulting normalized face images, which are of size :py:attr:`crop_size`")
+;
+
+template <typename T, typename U>
+static void extract_batch_inner(PyBobIpBaseFaceEyesNormObject* self, PyObject* inputs, PyBlitzArrayObject* eyes, PyBlitzArrayObject* output, int threads){
+  // get the C++ arrays while holding the GIL
+  std::vector<blitz::Array<T,2> > images;
+  if (PyTuple_Check(inputs)){
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(inputs); ++i)
+      images.push_back(*PyBlitzArrayCxx_AsBlitz<T,2>(reinterpret_cast<PyBlitzArrayObject*>(PyTuple_GET_ITEM(inputs, i))));
+  } else {
+    const blitz::Array<T,3> stack = *PyBlitzArrayCxx_AsBlitz<T,3>(reinterpret_cast<PyBlitzArrayObject*>(inputs));
+    for (int i = 0; i < stack.extent(0); ++i)
+      images.push_back(stack(i, blitz::Range::all(), blitz::Range::all()));
+  }
+  const blitz::Array<double,2> positions = *PyBlitzArrayCxx_AsBlitz<double,2>(eyes);
+  blitz::Array<U,3> faces = *PyBlitzArrayCxx_AsBlitz<U,3>(output);
+
+  // release the GIL while normalizing; exceptions are re-thrown after it has been re-acquired
+  std::exception_ptr error;
+  Py_BEGIN_ALLOW_THREADS
+  try {
+    self->cxx->extract(images, faces, positions, threads);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  Py_END_ALLOW_THREADS
+  if (error) std::rethrow_exception(error);
+}
+
+template <typename T>
+static void extract_batch_inner1(PyBobIpBaseFaceEyesNormObject* self, PyObject* inputs, PyBlitzArrayObject* eyes, PyBlitzArrayObject* output, int threads){
+  switch (output->type_num){
+    case NPY_FLOAT32: extract_batch_inner<T,float>(self, inputs, eyes, output, threads); break;
+    case NPY_UINT8:   extract_batch_inner<T,uint8_t>(self, inputs, eyes, output, threads); break;
+    default:          extract_batch_inner<T,double>(self, inputs, eyes, output, threads); break;
+  }
+}
+
+static PyObject* PyBobIpBaseFaceEyesNorm_extractBatch(PyBobIpBaseFaceEyesNormObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+  char** kwlist = extractBatch.kwlist();
+
+  PyObject* list;
+  PyBlitzArrayObject* eyes,* output = 0;
+  int threads = 1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO&|O&i", kwlist, &list, &PyBlitzArray_Converter, &eyes, &PyBlitzArray_OutputConverter, &output, &threads)){
+    extractBatch.print_usage();
+    return 0;
+  }
+  auto eyes_ = make_safe(eyes), output_ = make_xsafe(output);
+
+  // get the input images, either as a 3D stack, or as a tuple of converted 2D images
+  PyObject* inputs;
+  Py_ssize_t count;
+  int type_num;
+  if (PyList_Check(list) || PyTuple_Check(list)){
+    count = PySequence_Size(list);
+    inputs = PyTuple_New(count);
+    for (Py_ssize_t i = 0; i < count; ++i){
+      PyBlitzArrayObject* image;
+      if (!PyBlitzArray_Converter(PySequence_Fast_GET_ITEM(list, i), &image)){
+        Py_DECREF(inputs);
+        PyErr_Format(PyExc_TypeError, "`%s' extract_batch cannot convert the given input image at index %d in the list", Py_TYPE(self)->tp_name, (int)i);
+        return 0;
+      }
+      // the tuple steals the reference
+      PyTuple_SET_ITEM(inputs, i, reinterpret_cast<PyObject*>(image));
+    }
+  } else {
+    PyBlitzArrayObject* stack;
+    if (!PyBlitzArray_Converter(list, &stack)) return 0;
+    inputs = reinterpret_cast<PyObject*>(stack);
+    count = stack->ndim == 3 ? stack->shape[0] : 0;
+  }
+  auto inputs_ = make_safe(inputs);
+
+  // check the input images
+  if (PyTuple_Check(inputs)){
+    type_num = count ? reinterpret_cast<PyBlitzArrayObject*>(PyTuple_GET_ITEM(inputs, 0))->type_num : NPY_FLOAT64;
+    for (Py_ssize_t i = 0; i < count; ++i){
+      auto image = reinterpret_cast<PyBlitzArrayObject*>(PyTuple_GET_ITEM(inputs, i));
+      if (image->ndim != 2 || image->type_num != type_num){
+        extractBatch.print_usage();
+        PyErr_Format(PyExc_TypeError, "`%s' extract_batch requires all input images to be 2D and of the same data type, but in index %d it is not", Py_TYPE(self)->tp_name, (int)i);
+        return 0;
+      }
+    }
+  } else {
+    auto stack = reinterpret_cast<PyBlitzArrayObject*>(inputs);
+    if (stack->ndim != 3){
+      extractBatch.print_usage();
+      PyErr_Format(PyExc_TypeError, "`%s' extract_batch requires a 3D stack or a list of 2D images", Py_TYPE(self)->tp_name);
+      return 0;
+    }
+    type_num = stack->type_num;
+  }
+
+  if (eyes->ndim != 2 || eyes->type_num != NPY_FLOAT64){
+    extractBatch.print_usage();
+    PyErr_Format(PyExc_TypeError, "`%s' extract_batch requires the eye positions to be a 2D array of type float", Py_TYPE(self)->tp_name);
+    return 0;
+  }
+
+  if (output){
+    if (output->ndim != 3){
+      extractBatch.print_usage();
+      PyErr_Format(PyExc_TypeError, "`%s' extract_batch requires a 3D output array", Py_TYPE(self)->tp_name);
+      return 0;
+    }
+    if (output->type_num != NPY_FLOAT64 && output->type_num != NPY_FLOAT32 && output->type_num != NPY_UINT8){
+      extractBatch.print_usage();
+      PyErr_Format(PyExc_TypeError, "'%s': the 'output' array must be of type float64, float32 or uint8", Py_TYPE(self)->tp_name);
+      return 0;
+    }
+  } else {
+    // create output in the desired dimensions
+    auto shape = self->cxx->getCropSize();
+    Py_ssize_t n[] = {count, shape[0], shape[1]};
+    output = reinterpret_cast<PyBlitzArrayObject*>(PyBlitzArray_SimpleNew(NPY_FLOAT64, 3, n));
+    output_ = make_safe(output);
+  }
+
+  // finally, extract the faces
+  switch (type_num){
+    case NPY_UINT8:   extract_batch_inner1<uint8_t>(self, inputs, eyes, output, threads); break;
+    case NPY_UINT16:  extract_batch_inner1<uint16_t>(self, inputs, eyes, output, threads); break;
+    case NPY_FLOAT64: extract_batch_inner1<double>(self, inputs, eyes, output, threads); break;
+    default:
+      extractBatch.print_usage();
+      PyErr_Format(PyExc_TypeError, "`%s' extracts only from images of types uint8, uint16 or float, and not from %s", Py_TYPE(self)->tp_name, PyBlitzArray_TypenumAsString(type_num));
+      return 0;
+  }
+
+  return PyBlitzArray_AsNumpyArray(output, 0);
+  BOB_CATCH_MEMBER("cannot extract faces from images", 0)
+}
+
 static PyMethodDef PyBobIpBaseFaceEyesNorm_methods[] = {
   {
     extract.name(),
@@ -492,6 +648,12 @@ static PyMethodDef PyBobIpBaseFaceEyesNorm_methods[] = {
     METH_VARARGS|METH_KEYWORDS,
     extract.doc()
   },
+  {
+    extractBatch.name(),
+    (PyCFunction)PyBobIpBaseFaceEyesNorm_extractBatch,
+    METH_VARARGS|METH_KEYWORDS,
+    extractBatch.doc()
+  },
   {0} /* Sentinel */
 };
 
@@ -18,18 +18,23 @@ bob::extension::FunctionDoc s_median = bob::extension::FunctionDoc(
   "This function performs a median filtering of the given ``src`` image with the given radius and writes the result to the given ``dst`` image. "
   "Both gray-level and color images are supported, and the input and output datatype must be identical.\n\n"
   "Median filtering iterates with a mask of size ``(2*radius[0]+1, 2*radius[1]+1)`` over the input image. "
-  "For each input region, the pixels under the mask are sorted and the median value (the middle element of the sorted list) is written into the ``dst`` image. "
-  "Therefore, the ``dst`` is smaller than the ``src`` image, i.e., by ``2*radius`` pixels."
+  "For each input region, the median value of the pixels under the mask (the middle element of the sorted list) is written into the ``dst`` image. "
+  "Therefore, the ``dst`` is smaller than the ``src`` image, i.e., by ``2*radius`` pixels.\n\n"
+  "For ``uint8`` images, the median is computed with sliding histograms in constant time per pixel, independent of the radius [Perreault2007]_; "
+  "for ``uint16`` images, the median is computed with a sliding histogram along each row [Huang1979]_. "
+  "For ``float64`` images, the pixels of each region are sorted. "
+  "The rows of the image are split into bands, which are processed by the given number of threads."
 )
-.add_prototype("src, radius, [dst]", "dst")
+.add_prototype("src, radius, [dst], [threads]", "dst")
 .add_parameter("src", "array_like (2D or 3D)", "The source image to filter, might be a gray level image or a color image")
 .add_parameter("radius", "(int, int)", "The radius of the median filter; the final filter will have the size ``(2*radius[0]+1, 2*radius[1]+1)``")
 .add_parameter("dst", "array_like (2D or 3D)", "The median-filtered image to write; need to be of size ``src.shape - 2*radius``; if not specified, it will be created")
+.add_parameter("threads", "int", "[default: 1] The number of threads to use; ``0`` uses one thread per CPU core")
 .add_return("dst", "array_like (2D or 3D)", "The median-filtered image; the same as the ``dst`` parameter, if specified")
 ;
 
-template <typename T, int D> PyObject* inner_median(PyBlitzArrayObject* src, PyBlitzArrayObject* dst, const blitz::TinyVector<int,2>& radius) {
-  bob::ip::base::medianFilter(*PyBlitzArrayCxx_AsBlitz<T, D>(src), *PyBlitzArrayCxx_AsBlitz<T, D>(dst), radius);
+template <typename T, int D> PyObject* inner_median(PyBlitzArrayObject* src, PyBlitzArrayObject* dst, const blitz::TinyVector<int,2>& radius, int threads) {
+  bob::ip::base::medianFilter(*PyBlitzArrayCxx_AsBlitz<T, D>(src), *PyBlitzArrayCxx_AsBlitz<T, D>(dst), radius, threads);
   return PyBlitzArray_AsNumpyArray(dst, 0);
 }
 
@@ -40,8 +45,9 @@ PyObject* PyBobIpBase_median(PyObject*, PyObject* args, PyObject* kwargs) {
 
   PyBlitzArrayObject* src,* dst = 0;
   blitz::TinyVector<int,2> radius;
+  int threads = 1;
 
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&(ii)|O&", kwlist, &PyBlitzArray_Converter, &src, &radius[0], &radius[1], &PyBlitzArray_OutputConverter, &dst)) return 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&(ii)|O&i", kwlist, &PyBlitzArray_Converter, &src, &radius[0], &radius[1], &PyBlitzArray_OutputConverter, &dst, &threads)) return 0;
 
   auto src_ = make_safe(src), dst_ = make_xsafe(dst);
 
@@ -67,9 +73,9 @@ PyObject* PyBobIpBase_median(PyObject*, PyObject* args, PyObject* kwargs) {
 
   // compute the median
   switch (src->type_num){
-    case NPY_UINT8:   if (src->ndim == 2) return inner_median<uint8_t,2>(src, dst, radius);  else return inner_median<uint8_t,3>(src, dst, radius);
-    case NPY_UINT16:  if (src->ndim == 2) return inner_median<uint16_t,2>(src, dst, radius); else return inner_median<uint16_t,3>(src, dst, radius);
-    case NPY_FLOAT16: if (src->ndim == 2) return inner_median<double,2>(src, dst, radius);   else return inner_median<double,3>(src, dst, radius);
+    case NPY_UINT8:   if (src->ndim == 2) return inner_median<uint8_t,2>(src, dst, radius, threads);  else return inner_median<uint8_t,3>(src, dst, radius, threads);
+    case NPY_UINT16:  if (src->ndim == 2) return inner_median<uint16_t,2>(src, dst, radius, threads); else return inner_median<uint16_t,3>(src, dst, radius, threads);
+    case NPY_FLOAT64: if (src->ndim == 2) return inner_median<double,2>(src, dst, radius, threads);   else return inner_median<double,3>(src, dst, radius, threads);
     default:
       PyErr_Format(PyExc_ValueError, "'median' of %s arrays is currently not supported, only uint8, uint16 or float64 arrays are", PyBlitzArray_TypenumAsString(src->type_num));
       return 0;
@@ -86,12 +92,19 @@ bob::extension::FunctionDoc s_sobel = bob::extension::FunctionDoc(
   "The two filter are given as: \n\n"
   ".. math:: S_y =  \\left\\lgroup\\begin{array}{ccc} -1 & -2 & -1 \\\\ 0 & 0 & 0 \\\\ 1 & 2 & 1 \\end{array}\\right\\rgroup \\qquad S_x = \\left\\lgroup\\begin{array}{ccc} -1 & 0 & 1 \\\\ -2 & 0 & 2 \\\\ -1 & 0 & 1 \\end{array}\\right\\rgroup\n\n"
   "If given, the dst array should have the expected type (numpy.float64) and two layers of the same size as the input image. "
-  "Finally, the result of the vertical filter will be put into the first layer of ``dst[0]``, while the result of the horizontal filter will be written to ``dst[1]``."
+  "Finally, the result of the vertical filter will be put into the first layer of ``dst[0]``, while the result of the horizontal filter will be written to ``dst[1]``.\n\n"
+  "Both filters are computed in a single pass over the image. "
+  "Since the filters are convolved, i.e., flipped, both results have the opposite sign of the image gradient. "
+  "If the ``magnitude`` and/or ``orientation`` arrays are given, the gradient magnitude (using the given ``norm``) and orientation are computed in the same pass. "
+  "The orientation is the direction of the image gradient in range :math:`[-\\pi, \\pi]`, i.e., ``arctan2(-dst[0], -dst[1])``, which is the convention of ``numpy.arctan2(*numpy.gradient(src))``."
 )
-.add_prototype("src, [border], [dst]", "dst")
+.add_prototype("src, [border], [dst], [magnitude], [orientation], [norm]", "dst")
 .add_parameter("src", "array_like (2D, float)", "The source image to filter")
-.add_parameter("border", ":py:class:`bob.sp.BorderType`", "[default: ``bob.sp.BorderType.Mirror``] The extrapolation method used by the convolution at the border")
+.add_parameter("border", ":py:class:`bob.sp.BorderType`", "[default: ``bob.sp.BorderType.Mirror``] The extrapolation method used by the convolution at the border; ``Constant`` is not supported")
 .add_parameter("dst", "array_like (3D, float)", "The Sobel-filtered image to write; need to be of size ``[2] + src.shape``; if not specified, it will be created")
+.add_parameter("magnitude", "array_like (2D, float)", "If given, the gradient magnitude will be written into this array, which needs to have the same shape as ``src``")
+.add_parameter("orientation", "array_like (2D, float)", "If given, the gradient orientation ``arctan2(-dst[0], -dst[1])`` will be written into this array, which needs to have the same shape as ``src``")
+.add_parameter("norm", "str", "[default: ``'l2'``] The norm used to compute the ``magnitude``; possible values are ``'l2'`` (:math:`\\sqrt{d_y^2 + d_x^2}`) and ``'l1'`` (:math:`|d_y| + |d_x|`)")
 .add_return("dst", "array_like (3D, float)", "The Sobel-filtered image; the same as the ``dst`` parameter, if specified")
 ;
 
@@ -100,12 +113,13 @@ PyObject* PyBobIpBase_sobel(PyObject*, PyObject* args, PyObject* kwargs) {
 
   char** kwlist = s_sobel.kwlist();
 
-  PyBlitzArrayObject* src,* dst = 0;
+  PyBlitzArrayObject* src,* dst = 0,* magnitude = 0,* orientation = 0;
   bob::sp::Extrapolation::BorderType border = bob::sp::Extrapolation::Mirror;
+  const char* norm = "l2";
 
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|O&O&", kwlist, &PyBlitzArray_Converter, &src, &PyBobSpExtrapolationBorder_Converter, &border, &PyBlitzArray_OutputConverter, &dst)) return 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|O&O&O&O&s", kwlist, &PyBlitzArray_Converter, &src, &PyBobSpExtrapolationBorder_Converter, &border, &PyBlitzArray_OutputConverter, &dst, &PyBlitzArray_OutputConverter, &magnitude, &PyBlitzArray_OutputConverter, &orientation, &norm)) return 0;
 
-  auto src_ = make_safe(src), dst_ = make_xsafe(dst);
+  auto src_ = make_safe(src), dst_ = make_xsafe(dst), magnitude_ = make_xsafe(magnitude), orientation_ = make_xsafe(orientation);
 
   if (src->ndim != 2 || src->type_num != NPY_FLOAT64){
     PyErr_Format(PyExc_TypeError, "'sobel' : 'src' must be 2D and of type float, but it is %dD and of type %s.", (int)src->ndim, PyBlitzArray_TypenumAsString(src->type_num));
@@ -121,9 +135,20 @@ PyObject* PyBobIpBase_sobel(PyObject*, PyObject* args, PyObject* kwargs) {
     dst = reinterpret_cast<PyBlitzArrayObject*>(PyBlitzArray_SimpleNew(NPY_FLOAT64, 3, n));
     dst_ = make_safe(dst);
   }
+  if (magnitude && (magnitude->ndim != 2 || magnitude->type_num != NPY_FLOAT64)){
+    PyErr_Format(PyExc_TypeError, "'sobel' : 'magnitude' must be 2D and of type float, but it is %dD and of type %s.", (int)magnitude->ndim, PyBlitzArray_TypenumAsString(magnitude->type_num));
+    return 0;
+  }
+  if (orientation && (orientation->ndim != 2 || orientation->type_num != NPY_FLOAT64)){
+    PyErr_Format(PyExc_TypeError, "'sobel' : 'orientation' must be 2D and of type float, but it is %dD and of type %s.", (int)orientation->ndim, PyBlitzArray_TypenumAsString(orientation->type_num));
+    return 0;
+  }
 
   // perform Sobel filtering
-  bob::ip::base::sobel(*PyBlitzArrayCxx_AsBlitz<double,2>(src), *PyBlitzArrayCxx_AsBlitz<double,3>(dst), border);
+  if (magnitude || orientation)
+    bob::ip::base::sobel(*PyBlitzArrayCxx_AsBlitz<double,2>(src), *PyBlitzArrayCxx_AsBlitz<double,3>(dst), magnitude ? PyBlitzArrayCxx_AsBlitz<double,2>(magnitude) : 0, orientation ? PyBlitzArrayCxx_AsBlitz<double,2>(orientation) : 0, border, sobel_norm_from_string(norm));
+  else
+    bob::ip::base::sobel(*PyBlitzArrayCxx_AsBlitz<double,2>(src), *PyBlitzArrayCxx_AsBlitz<double,3>(dst), border);
 
   return PyBlitzArray_AsNumpyArray(dst, 0);
 
@@ -23,14 +23,16 @@ static auto Gaussian_doc = bob::extension::ClassDoc(
     "Constructs a new Gaussian filter",
     "The Gaussian kernel is generated in both directions independently, using the given standard deviation and the given radius, where the size of the kernels is actually ``2*radius+1``. "
     "When the radius is not given or negative, it will be automatically computed ad ``3*sigma``.\n\n"
-    ".. note::\n\n  Since the Gaussian smoothing is done by convolution, a larger radius will lead to longer execution time.",
+    ".. note::\n\n  Since the Gaussian smoothing is done by convolution, a larger radius will lead to longer execution time. "
+    "For large ``sigma``, use ``mode='iir'``, whose execution time does not depend on ``sigma``.",
     true
   )
-  .add_prototype("sigma, [radius], [border]","")
+  .add_prototype("sigma, [radius], [border], [mode]","")
   .add_prototype("gaussian", "")
   .add_parameter("sigma", "(double, double)", "The standard deviation of the Gaussian along the y- and x-axes in pixels")
   .add_parameter("radius", "(int, int)", "[default: (-1, -1) -> ``3*sigma`` ] The radius of the Gaussian in both directions -- the size of the kernel is ``2*radius+1``")
   .add_parameter("border", ":py:class:`bob.sp.BorderType`", "[default: ``bob.sp.BorderType.Mirror``] The extrapolation method used by the convolution at the border")
+  .add_parameter("mode", "str", "[default: ``'fir'``] The implementation of the smoothing, see :py:attr:`mode`; possible values: ('fir', 'iir')")
   .add_parameter("gaussian", ":py:class:`bob.ip.base.Gaussian`", "The Gaussian object to use for copy-construction")
 );
 
@@ -57,15 +59,16 @@ static int PyBobIpBaseGaussian_init(PyBobIpBaseGaussianObject* self, PyObject* a
   blitz::TinyVector<double,2> sigma;
   blitz::TinyVector<int,2> radius (-1, -1);
   bob::sp::Extrapolation::BorderType border = bob::sp::Extrapolation::Mirror;
+  const char* mode = "fir";
 
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "(dd)|(ii)O&", kwlist1, &sigma[0], &sigma[1], &radius[0], &radius[1], &PyBobSpExtrapolationBorder_Converter, &border)){
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "(dd)|(ii)O&s", kwlist1, &sigma[0], &sigma[1], &radius[0], &radius[1], &PyBobSpExtrapolationBorder_Converter, &border, &mode)){
     Gaussian_doc.print_usage();
     return -1;
   }
   // set the radius
   for (int i = 0; i < 2; ++i) if (radius[i] < 0) radius[i] = std::max(int(sigma[i] * 3 + 0.5), 1);
 
-  self->cxx.reset(new bob::ip::base::Gaussian(radius[0], radius[1], sigma[0], sigma[1], border));
+  self->cxx.reset(new bob::ip::base::Gaussian(radius[0], radius[1], sigma[0], sigma[1], border, gaussian_mode_from_string(mode)));
   return 0;
 
   BOB_CATCH_MEMBER("cannot create Gaussian", -1)
@@ -172,6 +175,34 @@ int PyBobIpBaseGaussian_setBorder(PyBobIpBaseGaussianObject* self, PyObject* val
   BOB_CATCH_MEMBER("border could not be set", -1)
 }
 
+static auto mode = bob::extension::VariableDoc(
+  "mode",
+  "str",
+  "The implementation of the smoothing, ``'fir'`` or ``'iir'``, with read and write access",
+  "In ``'fir'`` mode, the image is convolved with the (truncated) Gaussian kernels :py:attr:`kernel_y` and :py:attr:`kernel_x`, which costs ``2*radius+1`` operations per pixel and direction. "
+  "In ``'iir'`` mode, the recursive filter of Young and van Vliet is used instead, which approximates the non-truncated Gaussian with a constant number of operations per pixel, independent of :py:attr:`sigma`; the :py:attr:`radius` is ignored. "
+  "The image is extrapolated by ``4*sigma`` pixels at each border.\n\n"
+  "The recursive filter is an approximation: its impulse response deviates from the Gaussian by up to 10% of the peak for ``sigma`` around 1, and by less than 5% for ``sigma >= 3``. "
+  "For natural or random images, the deviation from ``'fir'`` mode with a radius of ``5*sigma`` is below 1% of the image range for ``sigma >= 3`` (about 1.5% with ``bob.sp.BorderType.Zero``), and decreases with larger ``sigma``. "
+  "For ``sigma < 0.5``, the ``'fir'`` implementation is always used."
+);
+PyObject* PyBobIpBaseGaussian_getMode(PyBobIpBaseGaussianObject* self, void*){
+  BOB_TRY
+  return Py_BuildValue("s", gaussian_mode_to_string(self->cxx->getMode()));
+  BOB_CATCH_MEMBER("mode could not be read", 0)
+}
+int PyBobIpBaseGaussian_setMode(PyBobIpBaseGaussianObject* self, PyObject* value, void*){
+  BOB_TRY
+  const char* m;
+  if (!PyArg_Parse(value, "s", &m)){
+    PyErr_Format(PyExc_RuntimeError, "%s %s expects a str", Py_TYPE(self)->tp_name, mode.name());
+    return -1;
+  }
+  self->cxx->setMode(gaussian_mode_from_string(m));
+  return 0;
+  BOB_CATCH_MEMBER("mode could not be set", -1)
+}
+
 static auto kernelY = bob::extension::VariableDoc(
   "kernel_y",
   "array_like (1D, float)",
@@ -216,6 +247,13 @@ static PyGetSetDef PyBobIpBaseGaussian_getseters[] = {
       border.doc(),
       0
     },
+    {
+      mode.name(),
+      (getter)PyBobIpBaseGaussian_getMode,
+      (setter)PyBobIpBaseGaussian_setMode,
+      mode.doc(),
+      0
+    },
     {
       kernelY.name(),
       (getter)PyBobIpBaseGaussian_getKernelY,
@@ -757,11 +757,12 @@ static auto allocateOutput = bob::extension::FunctionDoc(
   0,
   true
 )
-.add_prototype("", "pyramid")
+.add_prototype("[dtype]", "pyramid")
+.add_parameter("dtype", ":py:class:`numpy.dtype`", "[default: ``numpy.float64``] The data type of the pyramid, either ``numpy.float64`` or ``numpy.float32``; the latter halves the memory of the pyramid")
 .add_return("pyramid", "[array_like(3D, float)]", "A list of output arrays in the size required to call :py:func`process`")
 ;
 
-static PyObject* _allocate(PyBobIpBaseGaussianScaleSpaceObject* self){
+static PyObject* _allocate(PyBobIpBaseGaussianScaleSpaceObject* self, int type_num = NPY_FLOAT64){
 
   // get the number of octaves to process
   Py_ssize_t size = self->cxx->getOctaveMax()+1;
@@ -772,7 +773,7 @@ static PyObject* _allocate(PyBobIpBaseGaussianScaleSpaceObject* self){
     // allocate memory for the current octave in the desired size
     const blitz::TinyVector<int,3> shape = self->cxx->getOutputShape(i);
     Py_ssize_t o[] = {shape[0], shape[1], shape[2]};
-    PyObject* array = PyBlitzArray_SimpleNew(NPY_FLOAT64, 3, o);
+    PyObject* array = PyBlitzArray_SimpleNew(type_num, 3, o);
     PyList_SET_ITEM(list, i, PyBlitzArray_NUMPY_WRAP(array));
   }
 
@@ -782,11 +783,17 @@ static PyObject* _allocate(PyBobIpBaseGaussianScaleSpaceObject* self){
 static PyObject* PyBobIpBaseGaussianScaleSpace_allocateOutput(PyBobIpBaseGaussianScaleSpaceObject* self, PyObject* args, PyObject* kwargs) {
   BOB_TRY
 
-  char* kwlist[] = {0};
+  char** kwlist = allocateOutput.kwlist();
 
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "", kwlist)) return 0;
+  int type_num = NPY_FLOAT64;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O&", kwlist, &PyBlitzArray_TypenumConverter, &type_num)) return 0;
+
+  if (type_num != NPY_FLOAT64 && type_num != NPY_FLOAT32){
+    PyErr_Format(PyExc_TypeError, "`%s' allocate_output can only allocate pyramids of type float64 or float32, not %s", Py_TYPE(self)->tp_name, PyBlitzArray_TypenumAsString(type_num));
+    return 0;
+  }
 
-  return _allocate(self);
+  return _allocate(self, type_num);
 
   BOB_CATCH_MEMBER("cannot allocate output", 0)
 }
@@ -794,19 +801,40 @@ static PyObject* PyBobIpBaseGaussianScaleSpace_allocateOutput(PyBobIpBaseGaussia
 static auto process = bob::extension::FunctionDoc(
   "process",
   "Computes a Gaussian Pyramid for an input 2D image",
-  "If given, the results are put in the output ``dst``, which output should already be allocated and of the correct size (using the :py:func:`allocate_output` method).\n\n"
+  "If given, the results are put in the output ``dst``, which output should already be allocated and of the correct size (using the :py:func:`allocate_output` method). "
+  "The pyramid is computed in single precision, if the arrays in ``dst`` are of type ``numpy.float32``.\n\n"
   ".. note::\n\n  The `__call__` function is an alias for this method.",
   true
 )
-.add_prototype("src, [dst]", "dst")
+.add_prototype("src, [dst], [threads]", "dst")
 .add_parameter("src", "array_like (2D)", "The input image which should be processed")
-.add_parameter("dst", "[array_like (3D, float)]", "The Gaussian pyramid that should have been allocated with :py:func:`allocate_output`")
+.add_parameter("dst", "[array_like (3D, float)]", "The Gaussian pyramid that should have been allocated with :py:func:`allocate_output`; all arrays must be either of type float64 or float32")
+.add_parameter("threads", "int", "[default: 1] The maximum number of threads that run at the same time, which smooth bands of rows and compute the next octave while the current one is finished; ``0`` uses one thread per CPU core")
 .add_return("dst", "[array_like (3D, float)]", "The resulting Gaussian pyramid, if given it will be the same as the ``dst`` parameter")
 ;
 
-template <typename T>
-static void process_inner(PyBobIpBaseGaussianScaleSpaceObject* self, PyBlitzArrayObject* input, std::vector<blitz::Array<double,3>>& dst){
-  self->cxx->process(*PyBlitzArrayCxx_AsBlitz<T,2>(input), dst);
+template <typename T, typename U>
+static void process_inner(PyBobIpBaseGaussianScaleSpaceObject* self, PyBlitzArrayObject* input, std::vector<blitz::Array<U,3>>& dst, const int threads){
+  self->cxx->process(*PyBlitzArrayCxx_AsBlitz<T,2>(input), dst, threads);
+}
+
+template <typename U>
+static bool process_outer(PyBobIpBaseGaussianScaleSpaceObject* self, PyBlitzArrayObject* src, const std::vector<PyBlitzArrayObject*>& arrays, const int threads){
+  // reference the output arrays
+  std::vector<blitz::Array<U,3>> output(arrays.size());
+  for (size_t i = 0; i < arrays.size(); ++i)
+    output[i].reference(*PyBlitzArrayCxx_AsBlitz<U,3>(arrays[i]));
+
+  switch (src->type_num){
+    case NPY_UINT8:   process_inner<uint8_t>(self, src, output, threads); break;
+    case NPY_UINT16:  process_inner<uint16_t>(self, src, output, threads); break;
+    case NPY_FLOAT64: process_inner<double>(self, src, output, threads); break;
+    default:
+      process.print_usage();
+      PyErr_Format(PyExc_TypeError, "`%s' processes only images of types uint8, uint16 or float, and not %s", Py_TYPE(self)->tp_name, PyBlitzArray_TypenumAsString(src->type_num));
+      return false;
+  }
+  return true;
 }
 
 static PyObject* PyBobIpBaseGaussianScaleSpace_process(PyBobIpBaseGaussianScaleSpaceObject* self, PyObject* args, PyObject* kwargs) {
@@ -815,8 +843,9 @@ static PyObject* PyBobIpBaseGaussianScaleSpace_process(PyBobIpBaseGaussianScaleS
 
   PyBlitzArrayObject* src;
   PyObject* dst = 0;
+  int threads = 1;
 
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|O!", kwlist, &PyBlitzArray_Converter, &src, &PyList_Type, &dst)) return 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|O!i", kwlist, &PyBlitzArray_Converter, &src, &PyList_Type, &dst, &threads)) return 0;
 
   auto src_ = make_safe(src);
   auto dst_ = make_xsafe(dst);
@@ -841,7 +870,8 @@ static PyObject* PyBobIpBaseGaussianScaleSpace_process(PyBobIpBaseGaussianScaleS
   }
 
   // convert output to list of arrays
-  std::vector<blitz::Array<double,3>> output(size);
+  std::vector<PyBlitzArrayObject*> arrays(size);
+  std::vector<boost::shared_ptr<PyBlitzArrayObject>> arrays_(size);
   for (Py_ssize_t i = 0; i < size; ++i){
     // get array
     PyBlitzArrayObject* array = 0;
@@ -849,26 +879,18 @@ static PyObject* PyBobIpBaseGaussianScaleSpace_process(PyBobIpBaseGaussianScaleS
       PyErr_Format(PyExc_TypeError, "'%s' process cannot convert the given dst array at index %d in the list",  Py_TYPE(self)->tp_name, (int)i);
       return 0;
     }
+    arrays[i] = array;
+    arrays_[i] = make_safe(array);
     // check array
-    auto array_ = make_safe(array);
-    if (array->type_num != NPY_FLOAT64 || array->ndim != 3){
-      PyErr_Format(PyExc_TypeError, "'%s' the dst arrays for the process function must be 3D and of type float, but in index %d it is not",  Py_TYPE(self)->tp_name, (int)i);
+    if ((array->type_num != NPY_FLOAT64 && array->type_num != NPY_FLOAT32) || array->type_num != arrays[0]->type_num || array->ndim != 3){
+      PyErr_Format(PyExc_TypeError, "'%s' the dst arrays for the process function must be 3D and all of type float64 or all of type float32, but in index %d it is not",  Py_TYPE(self)->tp_name, (int)i);
       return 0;
     }
-    // reference array
-    output[i].reference(*PyBlitzArrayCxx_AsBlitz<double,3>(array));
   }
 
   // finally, extract the features
-  switch (src->type_num){
-    case NPY_UINT8:   process_inner<uint8_t>(self, src, output); break;
-    case NPY_UINT16:  process_inner<uint16_t>(self, src, output); break;
-    case NPY_FLOAT64: process_inner<double>(self, src, output); break;
-    default:
-      process.print_usage();
-      PyErr_Format(PyExc_TypeError, "`%s' processes only images of types uint8, uint16 or float, and not %s", Py_TYPE(self)->tp_name, PyBlitzArray_TypenumAsString(src->type_num));
-      return 0;
-  }
+  const bool ok = arrays[0]->type_num == NPY_FLOAT32 ? process_outer<float>(self, src, arrays, threads) : process_outer<double>(self, src, arrays, threads);
+  if (!ok) return 0;
 
   return Py_BuildValue("O", dst);
 
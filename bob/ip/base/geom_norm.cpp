@@ -27,12 +27,13 @@ static auto GeomNorm_doc = bob::extension::ClassDoc(
     ".. warning:: The behavior of the landmark rotation has changed from Bob version 1.x, where the landmarks were mistakenly rotated mathematically positive.",
     true
   )
-  .add_prototype("rotation_angle, scaling_factor, crop_size, crop_offset", "")
+  .add_prototype("rotation_angle, scaling_factor, crop_size, crop_offset, [interpolation]", "")
   .add_prototype("other", "")
   .add_parameter("rotation_angle", "float", "The rotation angle **in degrees** that should be applied")
   .add_parameter("scaling_factor", "float", "The scale factor to apply")
   .add_parameter("crop_size", "(int, int)", "The resolution of the processed images")
   .add_parameter("crop_offset", "(float, float)", "The transformation offset in the processed images")
+  .add_parameter("interpolation", "str", "[default: ``'bilinear'``] The interpolation to use, see :py:attr:`interpolation`; possible values: ('bilinear', 'area')")
   .add_parameter("other", ":py:class:`GeomNorm`", "Another GeomNorm object to copy")
 );
 
@@ -67,12 +68,13 @@ static int PyBobIpBaseGeomNorm_init(PyBobIpBaseGeomNormObject* self, PyObject* a
   double scale, angle;
   blitz::TinyVector<int,2> size;
   blitz::TinyVector<double,2> offset;
+  const char* interpolation = "bilinear";
   // more than one parameter; check the second one
-  if (!(PyArg_ParseTupleAndKeywords(args, kwargs, "dd(ii)(dd)", kwlist1, &angle, &scale, &size[0], &size[1], &offset[0], &offset[1]))){
+  if (!(PyArg_ParseTupleAndKeywords(args, kwargs, "dd(ii)(dd)|s", kwlist1, &angle, &scale, &size[0], &size[1], &offset[0], &offset[1], &interpolation))){
     GeomNorm_doc.print_usage();
     return -1;
   }
-  self->cxx.reset(new bob::ip::base::GeomNorm(angle, scale, size, offset));
+  self->cxx.reset(new bob::ip::base::GeomNorm(angle, scale, size, offset, interpolation_from_string(interpolation)));
   return 0;
 
   BOB_CATCH_MEMBER("cannot create GeomNorm object", -1)
@@ -196,6 +198,32 @@ int PyBobIpBaseGeomNorm_setCropOffset(PyBobIpBaseGeomNormObject* self, PyObject*
   BOB_CATCH_MEMBER("crop_offset could not be set", -1)
 }
 
+static auto interpolation = bob::extension::VariableDoc(
+  "interpolation",
+  "str",
+  "The interpolation used to compute the processed image, with read and write access",
+  "Possible values are:\n\n"
+  "* ``'bilinear'``: bi-linear interpolation of the four closest source pixels\n"
+  "* ``'area'``: when downscaling, each processed pixel is the average of all source pixels inside its footprint, weighted by the covered area, which avoids aliasing without blurring the image beforehand; "
+  "a processed pixel is masked only when its whole footprint is masked\n\n"
+  "With rotation, the ``'area'`` interpolation first averages the image to about the resolution of the processed image and then applies the rotation with bi-linear interpolation."
+);
+PyObject* PyBobIpBaseGeomNorm_getInterpolation(PyBobIpBaseGeomNormObject* self, void*){
+  BOB_TRY
+  return Py_BuildValue("s", interpolation_to_string(self->cxx->getInterpolation()));
+  BOB_CATCH_MEMBER("interpolation could not be read", 0)
+}
+int PyBobIpBaseGeomNorm_setInterpolation(PyBobIpBaseGeomNormObject* self, PyObject* value, void*){
+  BOB_TRY
+  if (!PyString_Check(value)){
+    PyErr_Format(PyExc_RuntimeError, "%s %s expects an str", Py_TYPE(self)->tp_name, interpolation.name());
+    return -1;
+  }
+  self->cxx->setInterpolation(interpolation_from_string(PyString_AS_STRING(value)));
+  return 0;
+  BOB_CATCH_MEMBER("interpolation could not be set", -1)
+}
+
 static PyGetSetDef PyBobIpBaseGeomNorm_getseters[] = {
     {
       angle.name(),
@@ -225,6 +253,13 @@ static PyGetSetDef PyBobIpBaseGeomNorm_getseters[] = {
       cropOffset.doc(),
       0
     },
+    {
+      interpolation.name(),
+      (getter)PyBobIpBaseGeomNorm_getInterpolation,
+      (setter)PyBobIpBaseGeomNorm_setInterpolation,
+      interpolation.doc(),
+      0
+    },
     {0}  /* Sentinel */
 };
 
@@ -244,33 +279,45 @@ static auto process = bob::extension::FunctionDoc(
 .add_prototype("input, input_mask, output, output_mask, center")
 .add_prototype("position, center", "transformed")
 .add_parameter("input", "array_like (2D or 3D)", "The input image to which GeomNorm should be applied")
-.add_parameter("output", "array_like (2D or 3D, float)", "The output image, which must be of size :py:attr:`crop_size`")
+.add_parameter("output", "array_like (2D or 3D, float, float32 or uint8)", "The output image, which must be of size :py:attr:`crop_size`; for ``uint8``, the values are rounded and saturated")
 .add_parameter("center", "(float, float)", "The transformation center in the given image; this will be placed to :py:attr:`crop_offset` in the output image")
-.add_parameter("input_mask", "array_like (bool, 2D or 3D)", "An input mask of valid pixels before geometric normalization, must be of same size as ``input``")
-.add_parameter("output_mask", "array_like (bool, 2D or 3D)", "The output mask of valid pixels after geometric normalization, must be of same size as ``output``")
+.add_parameter("input_mask", "array_like (bool, 2D or 3D)", "An input mask of valid pixels before geometric normalization, must be of same size as ``input``; for 3D images, a 2D mask can be shared by all color planes")
+.add_parameter("output_mask", "array_like (bool, 2D or 3D)", "The output mask of valid pixels after geometric normalization, must be of same size as ``output``; for 3D images, a 2D mask can be shared by all color planes")
 .add_parameter("position", "(float, float)", "A position in input image space that will be transformed to output image space (might be outside of the crop area)")
 .add_return("transformed", "uint16", "The resulting GeomNorm code at the given position in the image")
 ;
 
-template <typename T,int N>
+template <typename T, typename U, int N>
 static PyObject* process_inner(PyBobIpBaseGeomNormObject* self, PyBlitzArrayObject* input, PyBlitzArrayObject* input_mask, PyBlitzArrayObject* output, PyBlitzArrayObject* output_mask, const blitz::TinyVector<double,2>& offset){
-  if (input_mask && output_mask){
-    self->cxx->process(*PyBlitzArrayCxx_AsBlitz<T,N>(input), *PyBlitzArrayCxx_AsBlitz<bool,N>(input_mask), *PyBlitzArrayCxx_AsBlitz<double,N>(output), *PyBlitzArrayCxx_AsBlitz<bool,N>(output_mask), offset);
+  if (input_mask && output_mask && N == 3 && input_mask->ndim == 2){
+    // color image with a shared mask
+    self->cxx->process(*PyBlitzArrayCxx_AsBlitz<T,3>(input), *PyBlitzArrayCxx_AsBlitz<bool,2>(input_mask), *PyBlitzArrayCxx_AsBlitz<U,3>(output), *PyBlitzArrayCxx_AsBlitz<bool,2>(output_mask), offset);
+  } else if (input_mask && output_mask){
+    self->cxx->process(*PyBlitzArrayCxx_AsBlitz<T,N>(input), *PyBlitzArrayCxx_AsBlitz<bool,N>(input_mask), *PyBlitzArrayCxx_AsBlitz<U,N>(output), *PyBlitzArrayCxx_AsBlitz<bool,N>(output_mask), offset);
   } else {
-    self->cxx->process(*PyBlitzArrayCxx_AsBlitz<T,N>(input), *PyBlitzArrayCxx_AsBlitz<double,N>(output), offset);
+    self->cxx->process(*PyBlitzArrayCxx_AsBlitz<T,N>(input), *PyBlitzArrayCxx_AsBlitz<U,N>(output), offset);
   }
   Py_RETURN_NONE;
 }
 
-template <typename T>
+template <typename T, typename U>
 static PyObject* process_inner1(PyBobIpBaseGeomNormObject* self, PyBlitzArrayObject* input, PyBlitzArrayObject* input_mask, PyBlitzArrayObject* output, PyBlitzArrayObject* output_mask, const blitz::TinyVector<double,2>& offset){
   switch (input->ndim){
-    case 2: return process_inner<T,2>(self, input, input_mask, output, output_mask, offset);
-    case 3: return process_inner<T,3>(self, input, input_mask, output, output_mask, offset);
+    case 2: return process_inner<T,U,2>(self, input, input_mask, output, output_mask, offset);
+    case 3: return process_inner<T,U,3>(self, input, input_mask, output, output_mask, offset);
     default: return 0;// already handled
   }
 }
 
+template <typename T>
+static PyObject* process_inner2(PyBobIpBaseGeomNormObject* self, PyBlitzArrayObject* input, PyBlitzArrayObject* input_mask, PyBlitzArrayObject* output, PyBlitzArrayObject* output_mask, const blitz::TinyVector<double,2>& offset){
+  switch (output->type_num){
+    case NPY_FLOAT32: return process_inner1<T,float>(self, input, input_mask, output, output_mask, offset);
+    case NPY_UINT8:   return process_inner1<T,uint8_t>(self, input, input_mask, output, output_mask, offset);
+    default:          return process_inner1<T,double>(self, input, input_mask, output, output_mask, offset);
+  }
+}
+
 static PyObject* PyBobIpBaseGeomNorm_process(PyBobIpBaseGeomNormObject* self, PyObject* args, PyObject* kwargs) {
   BOB_TRY
   char** kwlist1 = process.kwlist(0);
@@ -331,15 +378,16 @@ static PyObject* PyBobIpBaseGeomNorm_process(PyBobIpBaseGeomNormObject* self, Py
     process.print_usage();
     return 0;
   }
-  if (output->type_num != NPY_FLOAT64){
-    PyErr_Format(PyExc_TypeError, "`%s' processes only output arrays of type float", Py_TYPE(self)->tp_name);
+  if (output->type_num != NPY_FLOAT64 && output->type_num != NPY_FLOAT32 && output->type_num != NPY_UINT8){
+    PyErr_Format(PyExc_TypeError, "`%s' processes only output arrays of type float64, float32 or uint8", Py_TYPE(self)->tp_name);
     process.print_usage();
     return 0;
   }
 
   if (input_mask && output_mask){
-    if (input_mask->ndim != input->ndim || output_mask->ndim != output->ndim){
-      PyErr_Format(PyExc_TypeError, "`%s' masks must have the same shape as the input matrix", Py_TYPE(self)->tp_name);
+    bool shared_mask = input->ndim == 3 && input_mask->ndim == 2 && output_mask->ndim == 2;
+    if (!shared_mask && (input_mask->ndim != input->ndim || output_mask->ndim != output->ndim)){
+      PyErr_Format(PyExc_TypeError, "`%s' masks must have the same shape as the input matrix, or be 2D for 3D images", Py_TYPE(self)->tp_name);
       process.print_usage();
       return 0;
     }
@@ -352,9 +400,9 @@ static PyObject* PyBobIpBaseGeomNorm_process(PyBobIpBaseGeomNormObject* self, Py
 
   // finally, process the data
   switch (input->type_num){
-    case NPY_UINT8:   return process_inner1<uint8_t>(self, input, input_mask, output, output_mask, center);
-    case NPY_UINT16:  return process_inner1<uint16_t>(self, input, input_mask, output, output_mask, center);
-    case NPY_FLOAT64: return process_inner1<double>(self, input, input_mask, output, output_mask, center);
+    case NPY_UINT8:   return process_inner2<uint8_t>(self, input, input_mask, output, output_mask, center);
+    case NPY_UINT16:  return process_inner2<uint16_t>(self, input, input_mask, output, output_mask, center);
+    case NPY_FLOAT64: return process_inner2<double>(self, input, input_mask, output, output_mask, center);
     default:
       PyErr_Format(PyExc_TypeError, "`%s' input array of type %s are currently not supported", Py_TYPE(self)->tp_name, PyBlitzArray_TypenumAsString(input->type_num));
       process.print_usage();
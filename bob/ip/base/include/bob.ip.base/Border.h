@@ -0,0 +1,41 @@
+/**
+ * @date Fri Oct 16 17:02:41 CEST 2026
+ * @author Manuel Guenther <manuel.guenther@idiap.ch>
+ *
+ * @brief This file defines a helper function to map pixel indices outside an image to the pixels that replace them
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_IP_BASE_BORDER_H
+#define BOB_IP_BASE_BORDER_H
+
+#include <bob.sp/extrapolate.h>
+
+namespace bob { namespace ip { namespace base {
+
+  /**
+   * Returns the index of the pixel that is used at position i of an image line of size n,
+   * according to the given border type; -1 refers to a zero-valued pixel.
+   * Border types other than Zero, NearestNeighbour and Circular mirror the image, repeating the border pixels.
+   */
+  static inline int _border_index(const int i, const int n, const bob::sp::Extrapolation::BorderType border_type){
+    if (i >= 0 && i < n) return i;
+    switch (border_type){
+      case bob::sp::Extrapolation::Zero:
+        return -1;
+      case bob::sp::Extrapolation::NearestNeighbour:
+        return i < 0 ? 0 : n - 1;
+      case bob::sp::Extrapolation::Circular:
+        return ((i % n) + n) % n;
+      default:{
+        // the period of the mirrored image is twice the image size
+        const int m = ((i % (2*n)) + 2*n) % (2*n);
+        return m < n ? m : 2*n - 1 - m;
+      }
+    }
+  }
+
+} } } // namespaces
+
+#endif // BOB_IP_BASE_BORDER_H
@@ -15,6 +15,7 @@
 #include <bob.core/check.h>
 
 #include <bob.ip.base/GeomNorm.h>
+#include <bob.ip.base/Parallel.h>
 
 static inline double _sqr(double x){return x*x;}
 
@@ -92,25 +93,68 @@ namespace bob { namespace ip { namespace base {
       /**
         * @brief Process a 2D face image by applying the geometric
         * normalization
+        *
+        * The output image can be of type double or float, or of an integral
+        * type like uint8, where the values are rounded and saturated.
         */
-      template <typename T>
+      template <typename T, typename U>
       void extract(
         const blitz::Array<T,2>& src,
-        blitz::Array<double,2>& dst,
+        blitz::Array<U,2>& dst,
         const blitz::TinyVector<double,2>& rightEye,
         const blitz::TinyVector<double,2>& leftEye
       ) const;
 
-      template <typename T>
+      template <typename T, typename U>
       void extract(
         const blitz::Array<T,2>& src,
         const blitz::Array<bool,2>& srcMask,
-        blitz::Array<double,2>& dst,
+        blitz::Array<U,2>& dst,
         blitz::Array<bool,2>& dstMask,
         const blitz::TinyVector<double,2>& rightEye,
         const blitz::TinyVector<double,2>& leftEye
       ) const;
 
+      /**
+        * @brief Process a 3D (color) face image by applying the geometric
+        * normalization to all color planes at once; the masks are shared by all planes
+        */
+      template <typename T, typename U>
+      void extract(
+        const blitz::Array<T,3>& src,
+        blitz::Array<U,3>& dst,
+        const blitz::TinyVector<double,2>& rightEye,
+        const blitz::TinyVector<double,2>& leftEye
+      ) const;
+
+      template <typename T, typename U>
+      void extract(
+        const blitz::Array<T,3>& src,
+        const blitz::Array<bool,2>& srcMask,
+        blitz::Array<U,3>& dst,
+        blitz::Array<bool,2>& dstMask,
+        const blitz::TinyVector<double,2>& rightEye,
+        const blitz::TinyVector<double,2>& leftEye
+      ) const;
+
+      /**
+        * @brief Process a batch of 2D face images, where the eye positions of
+        * image i are given in row i of eyes as (right_y, right_x, left_y, left_x)
+        * and the normalized face is written to dst(i,:,:)
+        *
+        * The images are distributed over the given number of threads
+        * (0: one thread per CPU core). In contrast to the other extract
+        * functions, this object is not modified, i.e., the last angle, scale
+        * and offset are not updated.
+        */
+      template <typename T, typename U>
+      void extract(
+        const std::vector<blitz::Array<T,2> >& src,
+        blitz::Array<U,3>& dst,
+        const blitz::Array<double,2>& eyes,
+        const int threads = 1
+      ) const;
+
       /**
        * @brief Getter function for the bob::ip::GeomNorm object that is doing the job.
        *
@@ -120,13 +164,26 @@ namespace bob { namespace ip { namespace base {
        */
       const boost::shared_ptr<GeomNorm> getGeomNorm() const{return m_geomNorm;}
 
+      /**
+       * @brief Configures the given GeomNorm object (usually a copy of getGeomNorm()) and
+       * the center of the transformation for the given eye positions, without processing any image
+       *
+       * This object is not modified, so it can be shared by several threads.
+       */
+      void configure(
+        GeomNorm& geomNorm,
+        blitz::TinyVector<double,2>& center,
+        const blitz::TinyVector<double,2>& rightEye,
+        const blitz::TinyVector<double,2>& leftEye
+      ) const;
+
     private:
 
-      template <typename T, bool mask>
+      template <typename T, int N, bool mask, typename U>
       void processNoCheck(
-        const blitz::Array<T,2>& src,
+        const blitz::Array<T,N>& src,
         const blitz::Array<bool,2>& srcMask,
-        blitz::Array<double,2>& dst,
+        blitz::Array<U,N>& dst,
         blitz::Array<bool,2>& dstMask,
         const blitz::TinyVector<double,2>& rightEye,
         const blitz::TinyVector<double,2>& leftEye
@@ -142,10 +199,10 @@ namespace bob { namespace ip { namespace base {
       mutable boost::shared_ptr<GeomNorm> m_geomNorm;
   };
 
-  template <typename T>
+  template <typename T, typename U>
   inline void FaceEyesNorm::extract(
     const blitz::Array<T,2>& src,
-    blitz::Array<double,2>& dst,
+    blitz::Array<U,2>& dst,
     const blitz::TinyVector<double,2>& rightEye,
     const blitz::TinyVector<double,2>& leftEye
   ) const
@@ -159,14 +216,14 @@ namespace bob { namespace ip { namespace base {
 
     // Process
     blitz::Array<bool,2> srcMask, dstMask;
-    processNoCheck<T,false>(src, srcMask, dst, dstMask, rightEye, leftEye);
+    processNoCheck<T,2,false>(src, srcMask, dst, dstMask, rightEye, leftEye);
   }
 
-  template <typename T>
+  template <typename T, typename U>
   inline void FaceEyesNorm::extract(
     const blitz::Array<T,2>& src,
     const blitz::Array<bool,2>& srcMask,
-    blitz::Array<double,2>& dst,
+    blitz::Array<U,2>& dst,
     blitz::Array<bool,2>& dstMask,
     const blitz::TinyVector<double,2>& rightEye,
     const blitz::TinyVector<double,2>& leftEye
@@ -184,32 +241,102 @@ namespace bob { namespace ip { namespace base {
     bob::core::array::assertSameShape(dst, m_geomNorm->getCropSize());
 
     // Process
-    processNoCheck<T,true>(src, srcMask, dst, dstMask, rightEye, leftEye);
+    processNoCheck<T,2,true>(src, srcMask, dst, dstMask, rightEye, leftEye);
+  }
+
+  template <typename T, typename U>
+  inline void FaceEyesNorm::extract(
+    const blitz::Array<T,3>& src,
+    blitz::Array<U,3>& dst,
+    const blitz::TinyVector<double,2>& rightEye,
+    const blitz::TinyVector<double,2>& leftEye
+  ) const
+  {
+    // Check input
+    bob::core::array::assertZeroBase(src);
+
+    // Check output
+    bob::core::array::assertZeroBase(dst);
+    bob::core::array::assertSameDimensionLength(src.extent(0), dst.extent(0));
+    bob::core::array::assertSameDimensionLength(dst.extent(1), m_geomNorm->getCropSize()[0]);
+    bob::core::array::assertSameDimensionLength(dst.extent(2), m_geomNorm->getCropSize()[1]);
+
+    // Process
+    blitz::Array<bool,2> srcMask, dstMask;
+    processNoCheck<T,3,false>(src, srcMask, dst, dstMask, rightEye, leftEye);
   }
 
-  template <typename T, bool mask>
+  template <typename T, typename U>
+  inline void FaceEyesNorm::extract(
+    const blitz::Array<T,3>& src,
+    const blitz::Array<bool,2>& srcMask,
+    blitz::Array<U,3>& dst,
+    blitz::Array<bool,2>& dstMask,
+    const blitz::TinyVector<double,2>& rightEye,
+    const blitz::TinyVector<double,2>& leftEye
+  ) const
+  {
+    // Check input
+    bob::core::array::assertZeroBase(src);
+    bob::core::array::assertZeroBase(srcMask);
+    bob::core::array::assertSameDimensionLength(src.extent(1), srcMask.extent(0));
+    bob::core::array::assertSameDimensionLength(src.extent(2), srcMask.extent(1));
+
+    // Check output
+    bob::core::array::assertZeroBase(dst);
+    bob::core::array::assertZeroBase(dstMask);
+    bob::core::array::assertSameDimensionLength(src.extent(0), dst.extent(0));
+    bob::core::array::assertSameShape(dstMask, m_geomNorm->getCropSize());
+    bob::core::array::assertSameDimensionLength(dst.extent(1), dstMask.extent(0));
+    bob::core::array::assertSameDimensionLength(dst.extent(2), dstMask.extent(1));
+
+    // Process
+    processNoCheck<T,3,true>(src, srcMask, dst, dstMask, rightEye, leftEye);
+  }
+
+  template <typename T, typename U>
+  inline void FaceEyesNorm::extract(
+    const std::vector<blitz::Array<T,2> >& src,
+    blitz::Array<U,3>& dst,
+    const blitz::Array<double,2>& eyes,
+    const int threads
+  ) const
+  {
+    // Check input
+    for (size_t i = 0; i < src.size(); ++i)
+      bob::core::array::assertZeroBase(src[i]);
+    bob::core::array::assertZeroBase(eyes);
+    bob::core::array::assertSameDimensionLength(eyes.extent(0), (int)src.size());
+    bob::core::array::assertSameDimensionLength(eyes.extent(1), 4);
+
+    // Check output
+    bob::core::array::assertZeroBase(dst);
+    bob::core::array::assertSameDimensionLength(dst.extent(0), (int)src.size());
+    bob::core::array::assertSameDimensionLength(dst.extent(1), m_geomNorm->getCropSize()[0]);
+    bob::core::array::assertSameDimensionLength(dst.extent(2), m_geomNorm->getCropSize()[1]);
+
+    // Process; each image uses its own GeomNorm object and array views, so that the images are independent
+    _parallel_for((int)src.size(), threads, [&](int i){
+      GeomNorm geomNorm(*m_geomNorm);
+      blitz::TinyVector<double,2> center;
+      configure(geomNorm, center, blitz::TinyVector<double,2>(eyes(i,0), eyes(i,1)), blitz::TinyVector<double,2>(eyes(i,2), eyes(i,3)));
+      blitz::Array<U,2> plane = _thread_plane(dst, i);
+      geomNorm.process(_thread_view(src[i]), plane, center);
+    });
+  }
+
+  template <typename T, int N, bool mask, typename U>
   inline void FaceEyesNorm::processNoCheck(
-    const blitz::Array<T,2>& src,
+    const blitz::Array<T,N>& src,
     const blitz::Array<bool,2>& srcMask,
-    blitz::Array<double,2>& dst,
+    blitz::Array<U,N>& dst,
     blitz::Array<bool,2>& dstMask,
     const blitz::TinyVector<double,2>& rightEye,
     const blitz::TinyVector<double,2>& leftEye
   ) const
   {
-    // Get angle to horizontal
-    double dy = leftEye[0] - rightEye[0], dx = leftEye[1] - rightEye[1];
-    double angle = std::atan2(dy, dx);
-    m_geomNorm->setRotationAngle(angle * 180. / M_PI - m_eyesAngle);
-
-    // Get scaling factor
-    m_geomNorm->setScalingFactor(m_eyesDistance / sqrt(_sqr(leftEye[0]-rightEye[0]) + _sqr(leftEye[1]-rightEye[1])));
-
-    // Get the center (of the eye centers segment)
-    m_lastCenter = blitz::TinyVector<double,2>(
-      (rightEye[0] + leftEye[0]) / 2.,
-      (rightEye[1] + leftEye[1]) / 2.
-    );
+    // Set up the GeomNorm object for the given eyes
+    configure(*m_geomNorm, m_lastCenter, rightEye, leftEye);
 
     // Perform the normalization
     if(mask)
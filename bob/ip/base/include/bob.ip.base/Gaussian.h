@@ -15,8 +15,42 @@
 #include <bob.sp/conv.h>
 #include <bob.sp/extrapolate.h>
 
+#include <vector>
+
 namespace bob { namespace ip { namespace base {
 
+  /**
+    * Resizes the given array to the given shape, unless it already has that shape.
+    * Any change of the shape reallocates the array, so workspaces that alternate between image sizes allocate on every call.
+    */
+  static inline void _resize(blitz::Array<double,2>& array, const int height, const int width){
+    if (array.extent(0) != height || array.extent(1) != width) array.resize(height, width);
+  }
+
+  /**
+    * Returns src as an array of doubles, using buffer for the conversion if required
+    */
+  template <typename T>
+  const blitz::Array<double,2>& _as_double(const blitz::Array<T,2>& src, blitz::Array<double,2>& buffer){
+    _resize(buffer, src.extent(0), src.extent(1));
+    buffer = blitz::cast<double>(src);
+    return buffer;
+  }
+
+  static inline const blitz::Array<double,2>& _as_double(const blitz::Array<double,2>& src, blitz::Array<double,2>&){
+    return src;
+  }
+
+  /**
+    * The implementation of the Gaussian smoothing:
+    * - GAUSSIAN_FIR: convolution with the truncated Gaussian kernel of the given radius
+    * - GAUSSIAN_IIR: the recursive filter of Young and van Vliet, whose cost per pixel does not depend on sigma or radius
+    */
+  typedef enum {
+    GAUSSIAN_FIR = 0,
+    GAUSSIAN_IIR
+  } GaussianMode;
+
   /**
     * @brief This class allows to smooth images with a Gaussian kernel
     */
@@ -30,11 +64,13 @@ namespace bob { namespace ip { namespace base {
        * @param sigma_y The standard deviation of the kernel along the y-axis
        * @param sigma_x The standard deviation of the kernel along the x-axis
        * @param border_type The interpolation type for the convolution
+       * @param mode The implementation of the smoothing, see GaussianMode
        */
       Gaussian(
         const size_t radius_y = 1, const size_t radius_x = 1,
         const double sigma_y=sqrt(2.5), const double sigma_x=sqrt(2.5),
-        const bob::sp::Extrapolation::BorderType border_type = bob::sp::Extrapolation::Mirror
+        const bob::sp::Extrapolation::BorderType border_type = bob::sp::Extrapolation::Mirror,
+        const GaussianMode mode = GAUSSIAN_FIR
       );
 
       /**
@@ -68,11 +104,13 @@ namespace bob { namespace ip { namespace base {
        * @param sigma_y The standard deviation of the kernel along the y-axis
        * @param sigma_x The standard deviation of the kernel along the x-axis
        * @param border_type The interpolation type for the convolution
+       * @param mode The implementation of the smoothing, see GaussianMode
        */
       void reset(
         const size_t radius_y, const size_t radius_x,
         const double sigma_y=sqrt(2.5), const double sigma_x=sqrt(2.5),
-        const bob::sp::Extrapolation::BorderType border_type = bob::sp::Extrapolation::Mirror
+        const bob::sp::Extrapolation::BorderType border_type = bob::sp::Extrapolation::Mirror,
+        const GaussianMode mode = GAUSSIAN_FIR
       );
 
       /**
@@ -83,6 +121,7 @@ namespace bob { namespace ip { namespace base {
       double getSigmaY() const { return m_sigma_y; }
       double getSigmaX() const { return m_sigma_x; }
       bob::sp::Extrapolation::BorderType getConvBorder() const { return m_conv_border; }
+      GaussianMode getMode() const { return m_mode; }
       const blitz::Array<double,1>& getKernelY() const { return m_kernel_y; }
       const blitz::Array<double,1>& getKernelX() const { return m_kernel_x; }
 
@@ -96,26 +135,70 @@ namespace bob { namespace ip { namespace base {
       void setSigmaX(const double sigma_x) { m_sigma_x = sigma_x; computeKernel(); }
       void setSigma(const blitz::TinyVector<double,2>& sigma) {m_sigma_y = sigma[0]; m_sigma_x = sigma[1]; computeKernel();}
       void setConvBorder(const bob::sp::Extrapolation::BorderType border_type) { m_conv_border = border_type; }
+      void setMode(const GaussianMode mode) { m_mode = mode; }
+
+      /**
+       * @brief The scratch space of the filter functions:
+       * the remapped border indices, the padded rows of the row bands, the converted (or in-place) source image,
+       * and the padded columns of the recursive filter.
+       * The same workspace can be used for images of different sizes, which resize these buffers as required.
+       * It must not be used by several threads at the same time.
+       */
+      struct Workspace {
+        std::vector<int> index_y;
+        std::vector<int> index_x;
+        std::vector<double> row;
+        std::vector<std::vector<double> > rows;
+        blitz::Array<double,2> src;
+        blitz::Array<double,2> columns;
+      };
+
+      /**
+       * @brief Returns the workspace of the calling thread, which is used when no workspace is given
+       */
+      static Workspace& threadWorkspace();
 
       /**
        * @brief Process a 2D blitz Array/Image
+       * The image borders are handled by remapping the pixel indices,
+       * so that only a single padded row is allocated, but no padded copy of the image.
+       * In GAUSSIAN_IIR mode, the image is padded by 4*sigma (instead of the radius) in y-direction,
+       * and the padded image is kept in the workspace.
+       * In GAUSSIAN_FIR mode, the rows of dst can be split into bands that are filtered by several threads,
+       * each of which reads the rows of src that its band (including the kernel radius) requires.
+       * src and dst may share their memory (e.g., to filter in place), in which case src is copied into the workspace first.
        * @param src The 2D input blitz array
        * @param dst The 2D output blitz array
+       * @param workspace The scratch space to use
+       * @param threads The number of threads for the row bands (see _thread_count); ignored in GAUSSIAN_IIR mode
        */
-      void filter_(const blitz::Array<double,2>& src, blitz::Array<double,2>& dst);
+      void filter_(const blitz::Array<double,2>& src, blitz::Array<double,2>& dst, Workspace& workspace, const int threads = 1) const;
+      void filter_(const blitz::Array<double,2>& src, blitz::Array<double,2>& dst) const { filter_(src, dst, threadWorkspace()); }
+
+      /**
+       * @brief Process a 2D blitz Array/Image in single precision
+       * The image is read and written in single precision, while the convolutions are computed in double precision.
+       * This halves the memory and the memory bandwidth of the images, e.g., in a float32 Gaussian scale space.
+       */
+      void filter_(const blitz::Array<float,2>& src, blitz::Array<float,2>& dst, Workspace& workspace, const int threads = 1) const;
+      void filter_(const blitz::Array<float,2>& src, blitz::Array<float,2>& dst) const { filter_(src, dst, threadWorkspace()); }
 
 
       /**
        * @brief Process a 2D blitz Array/Image
        * @param src The 2D input blitz array
        * @param dst The 2D output blitz array
+       * @param workspace The scratch space to use; if not given, the workspace of the calling thread is used
        */
       template <typename T>
-      void filter(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst){
-        // Casts the input to double
-        blitz::Array<double,2> src_d = bob::core::array::cast<double>(src);
-        // Calls the specialized template function for double
-        filter_(src_d, dst);
+      void filter(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst, Workspace& workspace) const{
+        // Casts the input to double, and calls the specialized function for double
+        filter_(_as_double(src, workspace.src), dst, workspace);
+      }
+
+      template <typename T>
+      void filter(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst) const{
+        filter(src, dst, threadWorkspace());
       }
 
 
@@ -123,20 +206,29 @@ namespace bob { namespace ip { namespace base {
        * @brief Process a 3D blitz Array/Image
        * @param src The 3D input blitz array
        * @param dst The 3D output blitz array
+       * @param workspace The scratch space to use; if not given, the workspace of the calling thread is used
        */
       template <typename T>
-      void filter(const blitz::Array<T,3>& src, blitz::Array<double,3>& dst){
+      void filter(const blitz::Array<T,3>& src, blitz::Array<double,3>& dst, Workspace& workspace) const{
         for( int p=0; p<dst.extent(0); ++p) {
           const blitz::Array<T,2> src_slice = src( p, blitz::Range::all(), blitz::Range::all() );
           blitz::Array<double,2> dst_slice = dst( p, blitz::Range::all(), blitz::Range::all() );
 
           // Gaussian smooth plane
-          filter(src_slice, dst_slice);
+          filter(src_slice, dst_slice, workspace);
         }
       }
 
+      template <typename T>
+      void filter(const blitz::Array<T,3>& src, blitz::Array<double,3>& dst) const{
+        filter(src, dst, threadWorkspace());
+      }
+
     private:
       void computeKernel();
+      template <typename T> void filterTyped(const blitz::Array<T,2>& src, blitz::Array<T,2>& dst, Workspace& workspace, const int threads) const;
+      template <typename S, typename T> void filterFIR(const blitz::Array<S,2>& src, blitz::Array<T,2>& dst, Workspace& workspace, const int threads) const;
+      template <typename T> void filterIIR(const blitz::Array<T,2>& src, blitz::Array<T,2>& dst, Workspace& workspace) const;
 
       /**
        * @brief Attributes
@@ -146,13 +238,15 @@ namespace bob { namespace ip { namespace base {
       double m_sigma_y;
       double m_sigma_x;
       bob::sp::Extrapolation::BorderType m_conv_border;
+      GaussianMode m_mode;
 
       blitz::Array<double, 1> m_kernel_y;
       blitz::Array<double, 1> m_kernel_x;
 
-      blitz::Array<double, 2> m_tmp_int;
-      blitz::Array<double, 2> m_tmp_int1;
-      blitz::Array<double, 2> m_tmp_int2;
+      // the coefficients (B, b1/b0, b2/b0, b3/b0) of the recursive filters
+      blitz::TinyVector<double, 4> m_iir_y;
+      blitz::TinyVector<double, 4> m_iir_x;
+
   };
 
 
@@ -15,6 +15,7 @@
 #include <vector>
 
 #include <bob.ip.base/Gaussian.h>
+#include <bob.ip.base/Parallel.h>
 
 namespace bob { namespace ip { namespace base {
   /**
@@ -41,8 +42,8 @@ namespace bob { namespace ip { namespace base {
     double edge_score; // score of the edge response (ratio Tr(H)^2/det(H) in section 4.1 of Lowe's paper)
   } GSSKeypointInfo;
 
-  template <typename T>
-  void _upsample(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst)
+  template <typename T, typename U>
+  void _upsample(const blitz::Array<T,2>& src, blitz::Array<U,2>& dst)
   {
     // Check dimensions
     bob::core::array::assertSameDimensionLength(src.extent(0)*2, dst.extent(0));
@@ -62,15 +63,15 @@ namespace bob { namespace ip { namespace base {
     blitz::Range rall = blitz::Range::all();
 
     // Non interpolated values
-    blitz::Array<double,2> dst1 = dst(rdst_y0, rdst_x0);
+    blitz::Array<U,2> dst1 = dst(rdst_y0, rdst_x0);
     dst1 = src;
 
     // Interpolated values
-    blitz::Array<double,2> dst2 = dst(rdst_y0, rdst_x1m);
+    blitz::Array<U,2> dst2 = dst(rdst_y0, rdst_x1m);
     dst2 = 0.5 * (src(rall, rsrc_x0) + src(rall, rsrc_x1));
-    blitz::Array<double,2> dst3 = dst(rdst_y1m, rdst_x0);
+    blitz::Array<U,2> dst3 = dst(rdst_y1m, rdst_x0);
     dst3 = 0.5 * (src(rsrc_y0, rall) + src(rsrc_y1, rall));
-    blitz::Array<double,2> dst4 = dst(rdst_y1m, rdst_x1m);
+    blitz::Array<U,2> dst4 = dst(rdst_y1m, rdst_x1m);
     dst4 = 0.5 * (dst3(rall, rsrc_x0) + dst3(rall, rsrc_x1)); // = 0.5 * (dst2(rsrc_y0, rall) + dst2(rsrc_y1, rall))
 
     // Right and bottom borders
@@ -78,8 +79,8 @@ namespace bob { namespace ip { namespace base {
     dst(dst.extent(0)-1, rall) = dst(dst.extent(0)-2, rall);
   }
 
-  template <typename T>
-  void _downsample(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst, const size_t d)
+  template <typename T, typename U>
+  void _downsample(const blitz::Array<T,2>& src, blitz::Array<U,2>& dst, const size_t d)
   {
     // Checks dimensions
     const int factor = (1 << d);
@@ -215,10 +216,18 @@ namespace bob { namespace ip { namespace base {
        * @param src The 2D input blitz array
        * @param dst A vector of 3D blitz Arrays. Each octave is described by
        *   one element of the vector. The bliz Arrays should have the
-       *   expected size.
+       *   expected size. The pyramid can be computed in double or in single
+       *   (float) precision, which halves its memory.
+       * @param threads The number of threads (see _thread_count). Each
+       *   scale is smoothed in row bands by the given number of threads.
+       *   Additionally, the next octave is computed as soon as its first
+       *   scale is available, while the last scales of the current octave
+       *   are still smoothed; both share the threads, so that no more than
+       *   the given number of threads run at the same time (including the
+       *   calling thread).
        */
-      template <typename T>
-      void process(const blitz::Array<T,2>& src, std::vector<blitz::Array<double,3> >& dst) const{
+      template <typename T, typename U>
+      void process(const blitz::Array<T,2>& src, std::vector<blitz::Array<U,3> >& dst, const int threads = 1) const{
         // Checks
         bob::core::array::assertZeroBase(src);
         bob::core::array::assertSameDimensionLength(src.extent(0),m_height);
@@ -232,37 +241,22 @@ namespace bob { namespace ip { namespace base {
           bob::core::array::assertSameShape(dst[i], shape);
         }
 
+        // The first scale of the first octave, which is smoothed from the
+        // second scale; the latter is overwritten when processing the octave
+        blitz::Array<U,2> dst_m1 = dst[0](0, blitz::Range::all(), blitz::Range::all());
+        blitz::Array<U,2> dst_init = dst[0](m_smooth_at_init ? 1 : 0, blitz::Range::all(), blitz::Range::all());
         if (m_octave_min < 0)
-          _upsample(src, m_cache_array0);
+          _upsample(src, dst_init);
         else if (m_octave_min > 0)
-          _downsample(src, m_cache_array0, m_octave_min);
+          _downsample(src, dst_init, m_octave_min);
         else // 0
-          m_cache_array0 = src;
+          dst_init = src;
 
-        blitz::Range rall = blitz::Range::all();
-        // Iterates over the scales
-        for (size_t o=0; o<m_n_octaves; ++o)
-        {
-          blitz::Array<double,2> dst_m1 = dst[o](0, rall, rall);
-          if (o==0) {
-            if (m_smooth_at_init)
-              m_gaussians[0]->filter(m_cache_array0, dst_m1);
-            else
-              dst_m1 = m_cache_array0;
-          }
-          else {
-            // Copy from previous octave and downsample
-            blitz::Array<double,2> dst_prev = dst[o-1]((int)m_n_intervals, rall, rall);
-            _downsample(dst_prev, dst_m1, 1);
-          }
-
-          for (size_t s=1; s<m_n_intervals+3; ++s)
-          {
-            blitz::Array<double,2> dst_prev = dst[o](s-1, rall, rall);
-            blitz::Array<double,2> dst_cur = dst[o](s, rall, rall);
-            m_gaussians[s]->filter(dst_prev, dst_cur);
-          }
-        }
+        if (m_smooth_at_init)
+          m_gaussians[0]->filter_(dst_init, dst_m1, Gaussian::threadWorkspace(), threads);
+
+        // Iterates over the octaves and scales
+        processOctave(dst, 0, threads);
       }
 
       /**
@@ -271,6 +265,7 @@ namespace bob { namespace ip { namespace base {
        *   New blitz Arrays of suitable sizes will be allocated and will populate the vector.
        */
       void allocateOutputPyramid(std::vector<blitz::Array<double,3> >& dst) const;
+      void allocateOutputPyramid(std::vector<blitz::Array<float,3> >& dst) const;
 
       /**
        * @brief Returns the output shape for a given octave.
@@ -300,12 +295,15 @@ namespace bob { namespace ip { namespace base {
       std::vector<boost::shared_ptr<bob::ip::base::Gaussian> > m_gaussians;
       bool m_smooth_at_init;
 
+      void resetGaussians();
+
       /**
-       * Working arrays/variables in cache
+       * Computes the scales of the given octave from its first scale, and
+       * the following octaves
        */
-      mutable blitz::Array<double,2> m_cache_array0;
-      void resetCache() const;
-      void resetGaussians();
+      void processOctave(std::vector<blitz::Array<double,3> >& dst, const size_t o, const int threads) const;
+      void processOctave(std::vector<blitz::Array<float,3> >& dst, const size_t o, const int threads) const;
+      template <typename U> void processOctaveTyped(std::vector<blitz::Array<U,3> >& dst, const size_t o, const int threads) const;
 
       /**
        * Checks that minimum octave index is in the range [-1,+infty], and
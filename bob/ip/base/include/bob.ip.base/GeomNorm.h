@@ -26,6 +26,10 @@ namespace bob { namespace ip { namespace base {
    *   3/ cropped with respect to the point given and the additional
    *        cropping parameters (will be substracted to the provided
    *        reference point in the final coordinate system)
+   *
+   * With INTERPOLATION_AREA, downscaled images average all source pixels
+   * inside the footprint of each target pixel, so that no blurring of the
+   * source image is required to avoid aliasing.
    */
   class GeomNorm
   {
@@ -37,7 +41,8 @@ namespace bob { namespace ip { namespace base {
       GeomNorm(
         const double rotation_angle, const double scaling_factor,
         const blitz::TinyVector<int,2>& crop_size,
-        const blitz::TinyVector<double,2>& cropp_offset
+        const blitz::TinyVector<double,2>& cropp_offset,
+        const Interpolation interpolation = INTERPOLATION_BILINEAR
       );
 
       /**
@@ -71,6 +76,7 @@ namespace bob { namespace ip { namespace base {
       double getScalingFactor() const { return m_scaling_factor; }
       const blitz::TinyVector<int,2>& getCropSize() const { return m_crop_size; }
       const blitz::TinyVector<double,2>& getCropOffset() const { return m_crop_offset; }
+      Interpolation getInterpolation() const { return m_interpolation; }
 
       /**
         * @brief Mutators
@@ -79,24 +85,33 @@ namespace bob { namespace ip { namespace base {
       void setScalingFactor(const double scaling_factor) {m_scaling_factor = scaling_factor;}
       void setCropSize(const blitz::TinyVector<int,2>& size) {m_crop_size = size;}
       void setCropOffset(const blitz::TinyVector<double,2>& offset) {m_crop_offset = offset;}
+      void setInterpolation(const Interpolation interpolation) {m_interpolation = interpolation;}
 
       /**
         * @brief Process a 2D blitz Array/Image by applying the geometric
         * normalization
+        *
+        * The output image can be of type double or float, or of an integral
+        * type like uint8, where the values are rounded and saturated.
         */
-      template <typename T>
-      void process(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst, const blitz::TinyVector<double,2>& center) const;
-      template <typename T>
-      void process(const blitz::Array<T,2>& src, const blitz::Array<bool,2>& src_mask, blitz::Array<double,2>& dst, blitz::Array<bool,2>& dst_mask, const blitz::TinyVector<double,2>& center) const;
+      template <typename T, typename U>
+      void process(const blitz::Array<T,2>& src, blitz::Array<U,2>& dst, const blitz::TinyVector<double,2>& center) const;
+      template <typename T, typename U>
+      void process(const blitz::Array<T,2>& src, const blitz::Array<bool,2>& src_mask, blitz::Array<U,2>& dst, blitz::Array<bool,2>& dst_mask, const blitz::TinyVector<double,2>& center) const;
 
       /**
        * @brief Process a 3D blitz Array/Image by applying the geometric
        * normalization to each color plane
+       *
+       * The source coordinates and interpolation weights are computed only once for all color planes.
+       * When a 2D mask is given, it is shared by all color planes.
        */
-      template <typename T>
-      void process(const blitz::Array<T,3>& src, blitz::Array<double,3>& dst, const blitz::TinyVector<double,2>& center) const;
-      template <typename T>
-      void process(const blitz::Array<T,3>& src, const blitz::Array<bool,3>& src_mask, blitz::Array<double,3>& dst, blitz::Array<bool,3>& dst_mask, const blitz::TinyVector<double,2>& center) const;
+      template <typename T, typename U>
+      void process(const blitz::Array<T,3>& src, blitz::Array<U,3>& dst, const blitz::TinyVector<double,2>& center) const;
+      template <typename T, typename U>
+      void process(const blitz::Array<T,3>& src, const blitz::Array<bool,2>& src_mask, blitz::Array<U,3>& dst, blitz::Array<bool,2>& dst_mask, const blitz::TinyVector<double,2>& center) const;
+      template <typename T, typename U>
+      void process(const blitz::Array<T,3>& src, const blitz::Array<bool,3>& src_mask, blitz::Array<U,3>& dst, blitz::Array<bool,3>& dst_mask, const blitz::TinyVector<double,2>& center) const;
 
       /**
        * @brief applies the geometric normalization to the given input position
@@ -111,10 +126,11 @@ namespace bob { namespace ip { namespace base {
       double m_scaling_factor;
       blitz::TinyVector<int,2> m_crop_size;
       blitz::TinyVector<double,2> m_crop_offset;
+      Interpolation m_interpolation;
   };
 
-  template <typename T>
-  void GeomNorm::process(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst, const blitz::TinyVector<double,2>& center) const
+  template <typename T, typename U>
+  void GeomNorm::process(const blitz::Array<T,2>& src, blitz::Array<U,2>& dst, const blitz::TinyVector<double,2>& center) const
   {
     // Check input
     bob::core::array::assertZeroBase(src);
@@ -126,11 +142,11 @@ namespace bob { namespace ip { namespace base {
 
     // Process
     blitz::Array<bool,2> src_mask, dst_mask;
-    bob::ip::base::transform<T,false>(src, src_mask, center, dst, dst_mask, m_crop_offset, blitz::TinyVector<double,2>(m_scaling_factor, m_scaling_factor), m_rotation_angle);
+    bob::ip::base::transform<T,false>(src, src_mask, center, dst, dst_mask, m_crop_offset, blitz::TinyVector<double,2>(m_scaling_factor, m_scaling_factor), m_rotation_angle, m_interpolation);
   }
 
-  template <typename T>
-  void GeomNorm::process(const blitz::Array<T,2>& src, const blitz::Array<bool,2>& src_mask, blitz::Array<double,2>& dst, blitz::Array<bool,2>& dst_mask, const blitz::TinyVector<double,2>& center) const
+  template <typename T, typename U>
+  void GeomNorm::process(const blitz::Array<T,2>& src, const blitz::Array<bool,2>& src_mask, blitz::Array<U,2>& dst, blitz::Array<bool,2>& dst_mask, const blitz::TinyVector<double,2>& center) const
   {
     // Check input
     bob::core::array::assertZeroBase(src);
@@ -145,30 +161,64 @@ namespace bob { namespace ip { namespace base {
     bob::core::array::assertSameDimensionLength(dst.extent(1), m_crop_size[1]);
 
     // Process
-    bob::ip::base::transform<T,true>(src, src_mask, center, dst, dst_mask, m_crop_offset, blitz::TinyVector<double,2>(m_scaling_factor, m_scaling_factor), m_rotation_angle);
+    bob::ip::base::transform<T,true>(src, src_mask, center, dst, dst_mask, m_crop_offset, blitz::TinyVector<double,2>(m_scaling_factor, m_scaling_factor), m_rotation_angle, m_interpolation);
   }
 
-  template <typename T>
-  void GeomNorm::process(const blitz::Array<T,3>& src, blitz::Array<double,3>& dst, const blitz::TinyVector<double,2>& center) const
+  template <typename T, typename U>
+  void GeomNorm::process(const blitz::Array<T,3>& src, blitz::Array<U,3>& dst, const blitz::TinyVector<double,2>& center) const
   {
-    for( int p=0; p<dst.extent(0); ++p) {
-      const blitz::Array<T,2> src_slice =
-        src( p, blitz::Range::all(), blitz::Range::all() );
-      blitz::Array<double,2> dst_slice =
-        dst( p, blitz::Range::all(), blitz::Range::all() );
+    // Check input
+    bob::core::array::assertZeroBase(src);
 
-      // Process one plane
-      process(src_slice, dst_slice, center);
-    }
+    // Check output
+    bob::core::array::assertZeroBase(dst);
+    bob::core::array::assertSameDimensionLength(src.extent(0), dst.extent(0));
+    bob::core::array::assertSameDimensionLength(dst.extent(1), m_crop_size[0]);
+    bob::core::array::assertSameDimensionLength(dst.extent(2), m_crop_size[1]);
+
+    // Process all planes at once
+    blitz::Array<bool,2> src_mask, dst_mask;
+    bob::ip::base::transform<T,false>(src, src_mask, center, dst, dst_mask, m_crop_offset, blitz::TinyVector<double,2>(m_scaling_factor, m_scaling_factor), m_rotation_angle, m_interpolation);
+  }
+
+  template <typename T, typename U>
+  void GeomNorm::process(const blitz::Array<T,3>& src, const blitz::Array<bool,2>& src_mask, blitz::Array<U,3>& dst, blitz::Array<bool,2>& dst_mask, const blitz::TinyVector<double,2>& center) const
+  {
+    // Check input
+    bob::core::array::assertZeroBase(src);
+    bob::core::array::assertZeroBase(src_mask);
+    bob::core::array::assertSameDimensionLength(src.extent(1), src_mask.extent(0));
+    bob::core::array::assertSameDimensionLength(src.extent(2), src_mask.extent(1));
+
+    // Check output
+    bob::core::array::assertZeroBase(dst);
+    bob::core::array::assertZeroBase(dst_mask);
+    bob::core::array::assertSameDimensionLength(src.extent(0), dst.extent(0));
+    bob::core::array::assertSameDimensionLength(dst.extent(1), m_crop_size[0]);
+    bob::core::array::assertSameDimensionLength(dst.extent(2), m_crop_size[1]);
+    bob::core::array::assertSameShape(dst_mask, m_crop_size);
+
+    // Process all planes at once
+    bob::ip::base::transform<T,true>(src, src_mask, center, dst, dst_mask, m_crop_offset, blitz::TinyVector<double,2>(m_scaling_factor, m_scaling_factor), m_rotation_angle, m_interpolation);
   }
 
-  template <typename T>
-  void GeomNorm::process(const blitz::Array<T,3>& src, const blitz::Array<bool,3>& src_mask, blitz::Array<double,3>& dst, blitz::Array<bool,3>& dst_mask, const blitz::TinyVector<double,2>& center) const
+  template <typename T, typename U>
+  void GeomNorm::process(const blitz::Array<T,3>& src, const blitz::Array<bool,3>& src_mask, blitz::Array<U,3>& dst, blitz::Array<bool,3>& dst_mask, const blitz::TinyVector<double,2>& center) const
   {
+    if (_has_identical_planes(src_mask)){
+      // all planes share the same mask, so we can process them at once
+      bob::core::array::assertSameDimensionLength(src_mask.extent(0), dst_mask.extent(0));
+      blitz::Array<bool,2> dst_mask_slice = dst_mask( 0, blitz::Range::all(), blitz::Range::all() );
+      process(src, src_mask( 0, blitz::Range::all(), blitz::Range::all() ), dst, dst_mask_slice, center);
+      for( int p=1; p<dst_mask.extent(0); ++p)
+        dst_mask( p, blitz::Range::all(), blitz::Range::all() ) = dst_mask_slice;
+      return;
+    }
+
     for( int p=0; p<dst.extent(0); ++p) {
       const blitz::Array<T,2> src_slice = src( p, blitz::Range::all(), blitz::Range::all() );
       const blitz::Array<bool,2> src_mask_slice = src_mask( p, blitz::Range::all(), blitz::Range::all() );
-      blitz::Array<double,2> dst_slice = dst( p, blitz::Range::all(), blitz::Range::all() );
+      blitz::Array<U,2> dst_slice = dst( p, blitz::Range::all(), blitz::Range::all() );
       blitz::Array<bool,2> dst_mask_slice = dst_mask( p, blitz::Range::all(), blitz::Range::all() );
 
       // Process one plane
@@ -381,13 +381,13 @@ namespace bob { namespace ip { namespace base {
       GradientMagnitudeType getGradientMagnitudeType() const { return m_mag_type; }
 
       /**
-        * Processes an input array
+        * Processes an input array; the magnitude and orientation maps can be of type double or float
         */
-      template <typename T>
+      template <typename T, typename U>
       void process(
         const blitz::Array<T,2>& input,
-        blitz::Array<double,2>& magnitude,
-        blitz::Array<double,2>& orientation
+        blitz::Array<U,2>& magnitude,
+        blitz::Array<U,2>& orientation
       ){
         // Checks input/output arrays
         bob::core::array::assertSameShape(input, m_gy);
@@ -12,38 +12,197 @@
 
 #include <vector>
 #include <algorithm>
+#include <stdint.h>
 #include <bob.core/assert.h>
 #include <bob.core/cast.h>
 
+#include <bob.ip.base/Parallel.h>
+
 namespace bob { namespace ip { namespace base {
 
+  /**
+   * Computes the median filter for the destination rows [first, last) by sorting the pixels of each window.
+   * This is the generic implementation, e.g., for floating point images.
+   */
+  template <typename T>
+  void _median_rows(const blitz::Array<T,2>& src, blitz::Array<T,2>& dst, const blitz::TinyVector<int,2>& radius, const int first, const int last){
+    // compute centeral pixel
+    int center = (2*radius[0]+1)*(2*radius[1]+1)/2;
+    // we only sort the first half of the sequence (this is all we need)
+    std::vector<T> _temp(center+1), _window((2*radius[0]+1)*(2*radius[1]+1));
+    for (int y = first; y < last; ++y)
+      for (int x = 0; x < dst.extent(1); ++x){
+        // copy the window from the src array
+        typename std::vector<T>::iterator it = _window.begin();
+        for (int i = y; i <= y + 2 * radius[0]; ++i)
+          for (int j = x; j <= x + 2 * radius[1]; ++j)
+            *it++ = src(i,j);
+        // compute the median
+        // we only sort the first half of the sequence
+        std::partial_sort_copy(_window.begin(), _window.end(), _temp.begin(), _temp.end());
+        // get the central element
+        dst(y,x) = _temp[center];
+      }
+  }
+
+  /**
+   * Computes the median filter of uint8 images for the destination rows [first, last) in constant time per pixel, following:
+   * S. Perreault and P. Hebert, "Median Filtering in Constant Time", IEEE Transactions on Image Processing, 16(9), 2007.
+   * One histogram per source column is moved down the rows, while the kernel histogram is moved along each row.
+   * The kernel histogram consists of 16 coarse bins, and the 16 fine bins of a coarse bin are updated only when required.
+   */
+  static inline void _median_rows(const blitz::Array<uint8_t,2>& src, blitz::Array<uint8_t,2>& dst, const blitz::TinyVector<int,2>& radius, const int first, const int last){
+    const int kernel_height = 2*radius[0]+1, kernel_width = 2*radius[1]+1;
+    const int width = src.extent(1);
+    const int rank = kernel_height * kernel_width / 2;
+    const uint8_t* src_data = src.data();
+    const int src_sy = src.stride(0), src_sx = src.stride(1);
+    uint8_t* dst_data = dst.data();
+    const int dst_sy = dst.stride(0), dst_sx = dst.stride(1);
+
+    // the fine (256 bins) and coarse (16 bins) histograms of all source columns
+    std::vector<int> column_fine(width * 256, 0), column_coarse(width * 16, 0);
+    // the histograms of the kernel, and the column, up to which each coarse bin of the fine histogram is valid
+    int kernel_coarse[16], kernel_fine[256], valid[16];
+
+    for (int y = first; y < last; ++y){
+      // move the column histograms to the current row
+      if (y == first){
+        for (int i = y; i < y + kernel_height; ++i)
+          for (int x = 0; x < width; ++x){
+            const int v = src_data[i * src_sy + x * src_sx];
+            ++column_fine[x * 256 + v];
+            ++column_coarse[x * 16 + (v >> 4)];
+          }
+      } else {
+        for (int x = 0; x < width; ++x){
+          const int out = src_data[(y - 1) * src_sy + x * src_sx], in = src_data[(y + kernel_height - 1) * src_sy + x * src_sx];
+          --column_fine[x * 256 + out]; --column_coarse[x * 16 + (out >> 4)];
+          ++column_fine[x * 256 + in]; ++column_coarse[x * 16 + (in >> 4)];
+        }
+      }
+
+      // initialize the coarse kernel histogram at the beginning of the row
+      std::fill(kernel_coarse, kernel_coarse + 16, 0);
+      std::fill(valid, valid + 16, -kernel_width - 1);
+      for (int x = 0; x < kernel_width; ++x)
+        for (int c = 0; c < 16; ++c)
+          kernel_coarse[c] += column_coarse[x * 16 + c];
+
+      for (int x = 0; x < dst.extent(1); ++x){
+        // move the coarse kernel histogram
+        if (x){
+          const int* in = &column_coarse[(x + kernel_width - 1) * 16],* out = &column_coarse[(x - 1) * 16];
+          for (int c = 0; c < 16; ++c)
+            kernel_coarse[c] += in[c] - out[c];
+        }
+
+        // find the coarse bin that contains the median
+        int c = 0, count = 0;
+        while (count + kernel_coarse[c] <= rank) count += kernel_coarse[c++];
+
+        // bring the fine bins of this coarse bin up to date
+        int* fine = kernel_fine + c * 16;
+        if (x - valid[c] >= kernel_width){
+          // recompute from scratch
+          std::fill(fine, fine + 16, 0);
+          for (int k = x; k < x + kernel_width; ++k){
+            const int* column = &column_fine[k * 256 + c * 16];
+            for (int f = 0; f < 16; ++f) fine[f] += column[f];
+          }
+        } else {
+          for (int k = valid[c] + 1; k <= x; ++k){
+            const int* in = &column_fine[(k + kernel_width - 1) * 256 + c * 16],* out = &column_fine[(k - 1) * 256 + c * 16];
+            for (int f = 0; f < 16; ++f) fine[f] += in[f] - out[f];
+          }
+        }
+        valid[c] = x;
+
+        // find the median inside the coarse bin
+        int f = 0;
+        while (count + fine[f] <= rank) count += fine[f++];
+        dst_data[y * dst_sy + x * dst_sx] = static_cast<uint8_t>(c * 16 + f);
+      }
+    }
+  }
+
+  /**
+   * Computes the median filter of uint16 images for the destination rows [first, last), following:
+   * T. Huang, G. Yang and G. Tang, "A fast two-dimensional median filtering algorithm", IEEE Transactions on Acoustics, Speech, and Signal Processing, 27(1), 1979.
+   * The kernel histogram is moved along each row, and the median is searched in 256 coarse and 256 fine bins, independent of the radius.
+   * Histograms for each column (see the uint8 version) would require 65536 bins per column, so that only the update of the kernel histogram depends on the radius.
+   */
+  static inline void _median_rows(const blitz::Array<uint16_t,2>& src, blitz::Array<uint16_t,2>& dst, const blitz::TinyVector<int,2>& radius, const int first, const int last){
+    const int kernel_height = 2*radius[0]+1, kernel_width = 2*radius[1]+1;
+    const int rank = kernel_height * kernel_width / 2;
+    const uint16_t* src_data = src.data();
+    const int src_sy = src.stride(0), src_sx = src.stride(1);
+    uint16_t* dst_data = dst.data();
+    const int dst_sy = dst.stride(0), dst_sx = dst.stride(1);
+
+    std::vector<int> fine(65536, 0);
+    int coarse[256];
+
+    for (int y = first; y < last; ++y){
+      // fill the kernel histogram at the beginning of the row
+      std::fill(coarse, coarse + 256, 0);
+      for (int i = y; i < y + kernel_height; ++i)
+        for (int j = 0; j < kernel_width; ++j){
+          const int v = src_data[i * src_sy + j * src_sx];
+          ++fine[v]; ++coarse[v >> 8];
+        }
+
+      for (int x = 0; x < dst.extent(1); ++x){
+        // move the kernel histogram by one column
+        if (x){
+          for (int i = y; i < y + kernel_height; ++i){
+            const int out = src_data[i * src_sy + (x - 1) * src_sx], in = src_data[i * src_sy + (x + kernel_width - 1) * src_sx];
+            --fine[out]; --coarse[out >> 8];
+            ++fine[in]; ++coarse[in >> 8];
+          }
+        }
+
+        // find the median in the coarse and the fine histogram
+        int c = 0, count = 0;
+        while (count + coarse[c] <= rank) count += coarse[c++];
+        int v = c << 8;
+        while (count + fine[v] <= rank) count += fine[v++];
+        dst_data[y * dst_sy + x * dst_sx] = static_cast<uint16_t>(v);
+      }
+
+      // empty the fine histogram for the next row
+      const int x = dst.extent(1) - 1;
+      for (int i = y; i < y + kernel_height; ++i)
+        for (int j = x; j < x + kernel_width; ++j)
+          --fine[src_data[i * src_sy + j * src_sx]];
+    }
+  }
+
+  /**
+   * Performs a median filtering of the given src image with a window of size (2*radius[0]+1, 2*radius[1]+1).
+   * For uint8 and uint16 images, sliding histograms are used, which makes the cost per pixel (almost) independent of the radius;
+   * other types sort the pixels of each window.
+   * The rows of the dst image are split into bands, one for each of the given number of threads (see _thread_count).
+   */
   template <typename T>
   void medianFilter(
     const blitz::Array<T,2>& src,
     blitz::Array<T,2>& dst,
-    const blitz::TinyVector<int,2>& radius
+    const blitz::TinyVector<int,2>& radius,
+    const int threads = 1
   ){
     // Checks
     bob::core::array::assertZeroBase(src);
     bob::core::array::assertZeroBase(dst);
     blitz::TinyVector<int,2> dst_size(src.extent(0) - 2 * radius[0], src.extent(1) - 2 * radius[1]);
     bob::core::array::assertSameShape(dst, dst_size);
+    if (dst_size[0] <= 0 || dst_size[1] <= 0) return;
 
-    // compute centeral pixel
-    int center = (2*radius[0]+1)*(2*radius[1]+1)/2;
-    // we only sort the first half of the sequence (this is all we need)
-    std::vector<T> _temp(center+1);
-    // iterate over the destination array
-    for (int y = 0; y < dst_size[0]; ++y)
-      for (int x = 0; x < dst_size[1]; ++x){
-        // get a slice from the src array
-        const blitz::Array<T,2> slice(src(blitz::Range(y, y + 2 * radius[0]), blitz::Range(x, x + 2 * radius[1])));
-        // compute the median
-        // we only sort the first half of the sequence
-        std::partial_sort_copy(slice.begin(), slice.end(), _temp.begin(), _temp.end());
-        // get the central element
-        dst(y,x) = _temp[center];
-    }
+    // split the rows into bands of (almost) equal size
+    const int bands = _thread_count(threads, dst_size[0]);
+    _parallel_for(bands, bands, [&](int b){
+      _median_rows(src, dst, radius, b * dst_size[0] / bands, (b+1) * dst_size[0] / bands);
+    });
   }
 
 
@@ -51,7 +210,8 @@ namespace bob { namespace ip { namespace base {
   void medianFilter(
     const blitz::Array<T,3>& src,
     blitz::Array<T,3>& dst,
-    const blitz::TinyVector<int,2>& radius
+    const blitz::TinyVector<int,2>& radius,
+    const int threads = 1
   ){
     // iterate over the color layers
     for (int p = 0; p < dst.extent(0); ++p){
@@ -59,11 +219,10 @@ namespace bob { namespace ip { namespace base {
       blitz::Array<T,2> dst_slice = dst(p, blitz::Range::all(), blitz::Range::all());
 
       // Apply median filter to the plane
-      medianFilter(src_slice, dst_slice, radius);
+      medianFilter(src_slice, dst_slice, radius, threads);
     }
   }
 
 } } } // namespaces
 
 #endif // BOB_IP_BASE_MEDIAN_H
-
@@ -18,7 +18,10 @@
 #include <bob.sp/extrapolate.h>
 #include <boost/shared_array.hpp>
 
+#include <vector>
+
 #include <bob.ip.base/Gaussian.h>
+#include <bob.ip.base/Parallel.h>
 
 namespace bob { namespace ip { namespace base {
 
@@ -42,13 +45,15 @@ namespace bob { namespace ip { namespace base {
        * @param sigma The standard deviation of the kernel for the smallest
        *  convolution kernel.
        * @param border_type The interpolation type for the convolution
+       * @param cascaded Compute each scale by smoothing the previous one (see setCascaded)
        */
       MultiscaleRetinex(
           const size_t n_scales=1,
           const int size_min=1,
           const int size_step=1,
           const double sigma=5.,
-          const bob::sp::Extrapolation::BorderType border_type = bob::sp::Extrapolation::Mirror
+          const bob::sp::Extrapolation::BorderType border_type = bob::sp::Extrapolation::Mirror,
+          const bool cascaded = false
       );
 
       /**
@@ -83,13 +88,15 @@ namespace bob { namespace ip { namespace base {
        * @param sigma The variance of the kernal for the smallest
        *  convolution kernel.
        * @param border_type The interpolation type for the convolution
+       * @param cascaded Compute each scale by smoothing the previous one (see setCascaded)
        */
       void reset(
         const size_t n_scales=1,
         const int size_min=1,
         const int size_step=1,
         const double sigma=2.,
-        const bob::sp::Extrapolation::BorderType border_type = bob::sp::Extrapolation::Mirror
+        const bob::sp::Extrapolation::BorderType border_type = bob::sp::Extrapolation::Mirror,
+        const bool cascaded = false
       );
 
       /**
@@ -100,50 +107,94 @@ namespace bob { namespace ip { namespace base {
       int getSizeStep() const { return m_size_step; }
       double getSigma() const { return m_sigma; }
       bob::sp::Extrapolation::BorderType getConvBorder() const { return m_conv_border; }
+      bool getCascaded() const { return m_cascaded; }
 
       /**
        * @brief Setters
        */
-      void setNScales(const size_t n_scales) { m_n_scales = n_scales; m_gaussians.reset(new bob::ip::base::Gaussian[m_n_scales]); computeKernels(); }
+      void setNScales(const size_t n_scales) { m_n_scales = n_scales; computeKernels(); }
       void setSizeMin(const int size_min) { m_size_min = size_min; computeKernels(); }
       void setSizeStep(const int size_step) { m_size_step = size_step; computeKernels(); }
       void setSigma(const double sigma) { m_sigma = sigma; computeKernels(); }
       void setConvBorder(const bob::sp::Extrapolation::BorderType border_type) { m_conv_border = border_type; computeKernels(); }
+      /**
+       * @brief In cascaded mode, each scale is computed by smoothing the previous scale with the incremental
+       * sigma sqrt(sigma_s^2 - sigma_{s-1}^2) and radius sqrt(size_s^2 - size_{s-1}^2) (rounded up).
+       * This is faster, but only approximates the independent smoothing, due to the truncation of the kernels and the image borders.
+       * The cascaded mode is only used for increasing kernel sizes, i.e., size_step > 0.
+       */
+      void setCascaded(const bool cascaded) { m_cascaded = cascaded; }
+
+      /**
+       * @brief The scratch space of the process functions:
+       * the converted source image, and one smoothed image and one Gaussian workspace per scale,
+       * so that the scales can be smoothed by different threads.
+       * The vectors grow with the number of scales, and the images follow the size of the processed image.
+       * It must not be used by several threads at the same time (other than by the scales of a single call).
+       */
+      struct Workspace {
+        blitz::Array<double,2> src;
+        std::vector<blitz::Array<double,2> > smoothed;
+        std::vector<bob::ip::base::Gaussian::Workspace> gaussians;
+      };
+
+      /**
+       * @brief Returns the workspace of the calling thread, which is used when no workspace is given
+       */
+      static Workspace& threadWorkspace();
+
+      /**
+       * @brief Process a 2D blitz Array/Image of type double
+       * All scales are smoothed first, and the logarithms are accumulated in a single pass:
+       * dst = log(src+1) - mean_s(log(smoothed_s+1))
+       * @param src The 2D input blitz array
+       * @param dst The 2D output blitz array
+       * @param workspace The scratch space to use
+       * @param threads The number of threads that smooth independent scales (see _thread_count); ignored in cascaded mode
+       */
+      void process_(const blitz::Array<double,2>& src, blitz::Array<double,2>& dst, Workspace& workspace, const int threads = 1) const;
 
       /**
        * @brief Process a 2D blitz Array/Image
        * @param src The 2D input blitz array
        * @param dst The 2D output blitz array
+       * @param workspace The scratch space to use; if not given, the workspace of the calling thread is used
+       * @param threads The number of threads that smooth independent scales (see _thread_count); ignored in cascaded mode
        */
       template <typename T>
-      void process(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst){
-        // Checks are postponed to the Gaussian operator() function.
-        dst = 0.;
-        if( m_tmp.extent(0) != src.extent(0) || m_tmp.extent(1) != src.extent(1))
-          m_tmp.resize(src.extent(0), src.extent(1) );
-        for(size_t s=0; s<m_n_scales; ++s) {
-          m_gaussians[s].filter(src,m_tmp);
-          dst += (blitz::log(src+1.) - blitz::log(m_tmp+1.));
-        }
-        dst /= (double)m_n_scales;
+      void process(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst, Workspace& workspace, const int threads = 1) const{
+        bob::core::array::assertSameShape(src, dst);
+        process_(_as_double(src, workspace.src), dst, workspace, threads);
+      }
+
+      template <typename T>
+      void process(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst, const int threads = 1) const{
+        process(src, dst, threadWorkspace(), threads);
       }
 
       /**
        * @brief Process a 3D blitz Array/Image
        * @param src The 3D input blitz array
        * @param dst The 3D output blitz array
+       * @param workspace The scratch space to use; if not given, the workspace of the calling thread is used
+       * @param threads The number of threads that smooth independent scales (see _thread_count); ignored in cascaded mode
        */
       template <typename T>
-      void process(const blitz::Array<T,3>& src, blitz::Array<double,3>& dst){
+      void process(const blitz::Array<T,3>& src, blitz::Array<double,3>& dst, Workspace& workspace, const int threads = 1) const{
         for( int p=0; p<dst.extent(0); ++p) {
           const blitz::Array<T,2> src_slice = src( p, blitz::Range::all(), blitz::Range::all() );
           blitz::Array<double,2> dst_slice = dst( p, blitz::Range::all(), blitz::Range::all() );
 
           // Gaussian smooth plane
-          process(src_slice, dst_slice);
+          process(src_slice, dst_slice, workspace, threads);
         }
       }
 
+      template <typename T>
+      void process(const blitz::Array<T,3>& src, blitz::Array<double,3>& dst, const int threads = 1) const{
+        process(src, dst, threadWorkspace(), threads);
+      }
+
     private:
       void computeKernels();
 
@@ -155,9 +206,11 @@ namespace bob { namespace ip { namespace base {
       int m_size_step;
       double m_sigma;
       bob::sp::Extrapolation::BorderType m_conv_border;
+      bool m_cascaded;
 
       boost::shared_array<bob::ip::base::Gaussian> m_gaussians;
-      blitz::Array<double,2> m_tmp;
+      // the Gaussians that smooth each scale to the next one, used in cascaded mode
+      boost::shared_array<bob::ip::base::Gaussian> m_increments;
   };
 
 } } } // namespaces
@@ -0,0 +1,132 @@
+/**
+ * @date Fri Oct 16 15:40:12 CEST 2026
+ * @author Manuel Guenther <manuel.guenther@idiap.ch>
+ *
+ * @brief This file defines helper functions to distribute independent work items over several threads,
+ * and to detect the arrays whose memory overlaps, which must not be processed in parallel
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_IP_BASE_PARALLEL_H
+#define BOB_IP_BASE_PARALLEL_H
+
+#include <blitz/array.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bob { namespace ip { namespace base {
+
+  /**
+   * Checks whether the memory spanned by the two arrays overlaps,
+   * e.g., when a function writes rows of dst that it still needs to read from src.
+   */
+  template <typename T, typename U, int N>
+  bool _overlaps(const blitz::Array<T,N>& a, const blitz::Array<U,N>& b){
+    if (!a.size() || !b.size()) return false;
+    size_t a_low = reinterpret_cast<size_t>(a.data()), a_high = a_low + sizeof(T);
+    size_t b_low = reinterpret_cast<size_t>(b.data()), b_high = b_low + sizeof(U);
+    for (int d = 0; d < N; ++d){
+      const blitz::diffType a_span = a.stride(d) * (a.extent(d) - 1) * (blitz::diffType)sizeof(T),
+                            b_span = b.stride(d) * (b.extent(d) - 1) * (blitz::diffType)sizeof(U);
+      if (a_span < 0) a_low += a_span; else a_high += a_span;
+      if (b_span < 0) b_low += b_span; else b_high += b_span;
+    }
+    return a_low < b_high && b_low < a_high;
+  }
+
+  /**
+   * Returns the number of threads that should process the given number of work items,
+   * when the given number of threads was requested; 0 requests one thread per CPU core.
+   */
+  static inline int _thread_count(const int threads, const int count){
+    int n = threads;
+    if (n <= 0) n = std::max(1u, std::thread::hardware_concurrency());
+    return std::max(1, std::min(n, count));
+  }
+
+  /**
+   * Calls function(i) for all i in [0, count), distributed over the given number of threads (see _thread_count).
+   * The work items are handed out one by one, so that items of different cost are balanced.
+   * With a single thread, all items are processed in the calling thread.
+   * The first exception thrown by any call is re-thrown in the calling thread, after all threads have finished.
+   */
+  template <typename F>
+  void _parallel_for(const int count, const int threads, F function){
+    const int n = _thread_count(threads, count);
+    if (n == 1){
+      for (int i = 0; i < count; ++i) function(i);
+      return;
+    }
+
+    std::atomic<int> next(0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto worker = [&](){
+      try {
+        for (int i = next++; i < count; i = next++) function(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) error = std::current_exception();
+        // stop handing out work items
+        next = count;
+      }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < n; ++t) pool.push_back(std::thread(worker));
+    worker();
+    for (auto& thread : pool) thread.join();
+    if (error) std::rethrow_exception(error);
+  }
+
+  /**
+   * Returns a view of the given plane of a 3D array, which does not share the reference counter of the array.
+   * blitz++ does not guard its reference counters against concurrent access,
+   * so that worker threads must not slice or copy arrays that other threads use at the same time.
+   * The view does not own the data, i.e., the array must outlive it.
+   */
+  template <typename T>
+  static inline blitz::Array<T,2> _thread_plane(const blitz::Array<T,3>& array, const int plane){
+    return blitz::Array<T,2>(
+      const_cast<T*>(array.dataZero()) + plane * array.stride(0),
+      blitz::TinyVector<int,2>(array.extent(1), array.extent(2)),
+      blitz::TinyVector<blitz::diffType,2>(array.stride(1), array.stride(2)),
+      blitz::neverDeleteData
+    );
+  }
+
+  /**
+   * Returns a view of the given slice of a 4D array along its first dimension, which does not share the reference counter of the array (see _thread_plane).
+   */
+  template <typename T>
+  static inline blitz::Array<T,3> _thread_slice(const blitz::Array<T,4>& array, const int index){
+    return blitz::Array<T,3>(
+      const_cast<T*>(array.dataZero()) + index * array.stride(0),
+      blitz::TinyVector<int,3>(array.extent(1), array.extent(2), array.extent(3)),
+      blitz::TinyVector<blitz::diffType,3>(array.stride(1), array.stride(2), array.stride(3)),
+      blitz::neverDeleteData
+    );
+  }
+
+  /**
+   * Returns a view of the given 2D array, which does not share the reference counter of the array (see _thread_plane).
+   */
+  template <typename T>
+  static inline blitz::Array<T,2> _thread_view(const blitz::Array<T,2>& array){
+    return blitz::Array<T,2>(
+      const_cast<T*>(array.dataZero()),
+      array.shape(),
+      blitz::TinyVector<blitz::diffType,2>(array.stride(0), array.stride(1)),
+      blitz::neverDeleteData
+    );
+  }
+
+} } } // namespaces
+
+#endif // BOB_IP_BASE_PARALLEL_H
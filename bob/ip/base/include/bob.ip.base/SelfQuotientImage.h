@@ -18,6 +18,8 @@
 #include <bob.sp/extrapolate.h>
 #include <boost/shared_array.hpp>
 
+#include <vector>
+
 #include <bob.ip.base/WeightedGaussian.h>
 
 namespace bob { namespace ip { namespace base {
@@ -114,32 +116,64 @@ namespace bob { namespace ip { namespace base {
       void setSigma(const double sigma) { m_sigma = sigma; computeKernels(); }
       void setConvBorder(const bob::sp::Extrapolation::BorderType border_type) { m_conv_border = border_type; computeKernels(); }
 
+        /**
+         * @brief The scratch space of the process functions:
+         * the converted source image, its extrapolation by the radius of the largest scale and the integral image of it,
+         * which all scales share, and one smoothed image per scale.
+         * The extrapolated images depend on both the image size and the largest scale of the filter that uses the workspace.
+         * It must not be used by several threads at the same time.
+         */
+        struct Workspace {
+          blitz::Array<double,2> src;
+          blitz::Array<double,2> src_extra;
+          blitz::Array<double,2> src_integral;
+          std::vector<blitz::Array<double,2> > smoothed;
+        };
+
+        /**
+         * @brief Returns the workspace of the calling thread, which is used when no workspace is given
+         */
+        static Workspace& threadWorkspace();
+
+        /**
+         * @brief Process a 2D blitz Array/Image of type double
+         * The image is extrapolated once by the radius of the largest scale, and all scales share this
+         * extrapolated image and its integral image (see WeightedGaussian::filterExtrapolated).
+         * @param src The 2D input blitz array
+         * @param dst The 2D output blitz array
+         * @param workspace The scratch space to use
+         * @param threads The number of threads that process the scales (see _thread_count)
+         */
+        void process_(const blitz::Array<double,2>& src, blitz::Array<double,2>& dst, Workspace& workspace, const int threads = 1) const;
+
         /**
          * @brief Process a 2D blitz Array/Image
          * @param src The 2D input blitz array
          * @param dst The 2D output blitz array
+         * @param workspace The scratch space to use; if not given, the workspace of the calling thread is used
+         * @param threads The number of threads that process the scales (see _thread_count)
          */
         template <typename T>
-        void process(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst){
+        void process(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst, Workspace& workspace, const int threads = 1) const{
           // TODO: assert array elements > -1.
-          // Checks are postponed to the Weighted Gaussian operator() function.
-          dst = 0.;
-          if( m_tmp.extent(0) != src.extent(0) || m_tmp.extent(1) != src.extent(1))
-            m_tmp.resize(src.extent(0), src.extent(1) );
-          for(size_t s=0; s<m_n_scales; ++s) {
-            m_wgaussians[s].filter(src,m_tmp);
-            dst += (blitz::log(src+1.) - blitz::log(m_tmp+1.));
-          }
-          dst /= (double)m_n_scales;
+          bob::core::array::assertSameShape(src, dst);
+          process_(_as_double(src, workspace.src), dst, workspace, threads);
+        }
+
+        template <typename T>
+        void process(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst, const int threads = 1) const{
+          process(src, dst, threadWorkspace(), threads);
         }
 
         /**
          * @brief Process a 3D blitz Array/Image
          * @param src The 3D input blitz array
          * @param dst The 3D output blitz array
+         * @param workspace The scratch space to use; if not given, the workspace of the calling thread is used
+         * @param threads The number of threads that process the scales (see _thread_count)
          */
         template <typename T>
-        void process(const blitz::Array<T,3>& src, blitz::Array<double,3>& dst){
+        void process(const blitz::Array<T,3>& src, blitz::Array<double,3>& dst, Workspace& workspace, const int threads = 1) const{
           // Check number of planes
           bob::core::array::assertSameDimensionLength(src.extent(0), dst.extent(0));
 
@@ -150,10 +184,15 @@ namespace bob { namespace ip { namespace base {
               dst( p, blitz::Range::all(), blitz::Range::all() );
 
             // Gaussian smooth plane
-            process(src_slice, dst_slice);
+            process(src_slice, dst_slice, workspace, threads);
           }
         }
 
+        template <typename T>
+        void process(const blitz::Array<T,3>& src, blitz::Array<double,3>& dst, const int threads = 1) const{
+          process(src, dst, threadWorkspace(), threads);
+        }
+
     private:
         void computeKernels();
 
@@ -167,7 +206,6 @@ namespace bob { namespace ip { namespace base {
         bob::sp::Extrapolation::BorderType m_conv_border;
 
         boost::shared_array<bob::ip::base::WeightedGaussian> m_wgaussians;
-        blitz::Array<double,2> m_tmp;
   };
 
 } } } // namespaces
@@ -10,33 +10,93 @@
 #ifndef BOB_IP_BASE_SOBEL_H
 #define BOB_IP_BASE_SOBEL_H
 
+#include <cmath>
 #include <stdexcept>
+#include <vector>
 #include <boost/format.hpp>
 
 #include <bob.core/assert.h>
 #include <bob.core/cast.h>
-#include <bob.sp/conv.h>
 #include <bob.sp/extrapolate.h>
 
+#include <bob.ip.base/Border.h>
+
 namespace bob { namespace ip { namespace base {
 
-  // compute filtering with the given filter
+  /**
+    * The norm that is used to compute the gradient magnitude from the Sobel responses
+    * - SOBEL_L2: the Euclidean norm sqrt(dy^2 + dx^2)
+    * - SOBEL_L1: the sum of absolute values |dy| + |dx|
+    */
+  typedef enum {
+    SOBEL_L2 = 0,
+    SOBEL_L1
+  } SobelNorm;
+
+  /**
+    * Computes both Sobel responses in a single pass over the src image, using the separability of the kernels:
+    * for each row, the three neighboring src rows are combined into the vertical difference [1,0,-1] and the vertical smoothing [1,2,1],
+    * which are then combined horizontally with [1,2,1] and [1,0,-1], respectively.
+    * If given (i.e., not NULL), the gradient magnitude and orientation are computed from the responses of the same pixel.
+    */
   template <typename T>
   void _sobel(
     const blitz::Array<T,2>& src,
-    const blitz::Array<T,2>& kernel,
-    blitz::Array<T,2>& dst,
-    bob::sp::Extrapolation::BorderType border_type
+    blitz::Array<T,2>& dst_y,
+    blitz::Array<T,2>& dst_x,
+    blitz::Array<double,2>* magnitude,
+    blitz::Array<double,2>* orientation,
+    const bob::sp::Extrapolation::BorderType border_type,
+    const SobelNorm norm
   ){
-    if (border_type == bob::sp::Extrapolation::Zero)
-      bob::sp::conv(src, kernel, dst);
-    else {
-      blitz::Array<T,2> tmp(bob::sp::getConvOutputSize(src, kernel, bob::sp::Conv::Full));
-      if (border_type == bob::sp::Extrapolation::NearestNeighbour) bob::sp::extrapolateNearest(src, tmp);
-      else if (border_type == bob::sp::Extrapolation::Circular) bob::sp::extrapolateCircular(src, tmp);
-      else if (border_type == bob::sp::Extrapolation::Mirror) bob::sp::extrapolateMirror(src, tmp);
-      else throw std::runtime_error("The given border type is (currently) not supported");
-      bob::sp::conv(tmp, kernel, dst, bob::sp::Conv::Valid);
+    bob::core::array::assertZeroBase(src);
+    bob::core::array::assertSameShape(dst_y, src);
+    bob::core::array::assertSameShape(dst_x, src);
+    if (magnitude) bob::core::array::assertSameShape(*magnitude, src);
+    if (orientation) bob::core::array::assertSameShape(*orientation, src);
+
+    if (border_type == bob::sp::Extrapolation::Constant)
+      throw std::runtime_error("The given border type is (currently) not supported");
+
+    const int height = src.extent(0), width = src.extent(1);
+    if (!height || !width) return;
+
+    // the columns left and right of the image
+    const int left = _border_index(-1, width, border_type), right = _border_index(width, width, border_type);
+
+    // the vertical difference and smoothing of the current row, padded by one pixel on each side
+    std::vector<T> difference(width + 2), smoothed(width + 2);
+
+    for (int y = 0; y < height; ++y){
+      const int above = _border_index(y - 1, height, border_type), below = _border_index(y + 1, height, border_type);
+
+      // combine the three rows
+      for (int x = 0; x < width; ++x){
+        const T a = above < 0 ? T(0) : src(above, x), c = src(y, x), b = below < 0 ? T(0) : src(below, x);
+        difference[x+1] = a - b;
+        smoothed[x+1] = a + T(2) * c + b;
+      }
+      difference[0] = left < 0 ? T(0) : difference[left+1];
+      smoothed[0] = left < 0 ? T(0) : smoothed[left+1];
+      difference[width+1] = right < 0 ? T(0) : difference[right+1];
+      smoothed[width+1] = right < 0 ? T(0) : smoothed[right+1];
+
+      // combine the three columns
+      for (int x = 0; x < width; ++x){
+        const T dy = difference[x] + T(2) * difference[x+1] + difference[x+2];
+        const T dx = smoothed[x] - smoothed[x+2];
+        dst_y(y, x) = dy;
+        dst_x(y, x) = dx;
+        if (magnitude){
+          const double gy = static_cast<double>(dy), gx = static_cast<double>(dx);
+          (*magnitude)(y, x) = norm == SOBEL_L1 ? std::abs(gy) + std::abs(gx) : std::sqrt(gy * gy + gx * gx);
+        }
+        if (orientation){
+          // the Sobel responses point against the gradient (see sobel), which is negated here as in GradientMaps;
+          // subtracting from 0 avoids -0, so that flat areas have orientation 0
+          (*orientation)(y, x) = std::atan2(0. - static_cast<double>(dy), 0. - static_cast<double>(dx));
+        }
+      }
     }
   }
 
@@ -45,6 +105,7 @@ namespace bob { namespace ip { namespace base {
     *   The resulting 3D array will contain two planes:
     *     - The first one for the convolution with the y-kernel
     *     - The second one for the convolution with the x-kernel
+    *   Since the kernels are convolved (i.e., flipped), both responses have the opposite sign of the image gradient.
     * @warning The selected type should be signed (e.g. int64_t or double)
     */
   template <typename T>
@@ -59,18 +120,41 @@ namespace bob { namespace ip { namespace base {
     // Check that dst has zero bases
     bob::core::array::assertZeroBase(dst);
 
-    // Define kernels for y and x
-    blitz::Array<T,2> kernel_y(3,3), kernel_x(3,3);
-    kernel_y = -1, -2, -1, 0, 0, 0, 1, 2, 1;
-    kernel_x = -1, 0, 1, -2, 0, 2, -1, 0, 1;
+    // Define slices for y and x
+    blitz::Array<T,2> dst_y = dst(0, blitz::Range::all(), blitz::Range::all());
+    blitz::Array<T,2> dst_x = dst(1, blitz::Range::all(), blitz::Range::all());
+
+    // execute
+    _sobel(src, dst_y, dst_x, static_cast<blitz::Array<double,2>*>(0), static_cast<blitz::Array<double,2>*>(0), border_type, SOBEL_L2);
+  }
+
+  /**
+    * @brief Process a 2D blitz Array/Image by applying the Sobel operator (see above),
+    *   and computes the gradient magnitude (using the given norm) and orientation in the same pass.
+    *   The orientation is the one of the image gradient, i.e., atan2(-dst(0,y,x), -dst(1,y,x)) in range [-pi, pi], as in GradientMaps.
+    *   magnitude and orientation may be NULL, in which case they are not computed.
+    */
+  template <typename T>
+  void sobel(
+    const blitz::Array<T,2>& src,
+    blitz::Array<T,3>& dst,
+    blitz::Array<double,2>* magnitude,
+    blitz::Array<double,2>* orientation,
+    bob::sp::Extrapolation::BorderType border_type = bob::sp::Extrapolation::Mirror,
+    const SobelNorm norm = SOBEL_L2
+  ){
+    // Check that dst has two planes
+    if (dst.extent(0) != 2) throw std::runtime_error((boost::format("destination array extent for the first dimension (0) is not 2, but %d") % dst.extent(0)).str());
+
+    // Check that dst has zero bases
+    bob::core::array::assertZeroBase(dst);
 
     // Define slices for y and x
     blitz::Array<T,2> dst_y = dst(0, blitz::Range::all(), blitz::Range::all());
     blitz::Array<T,2> dst_x = dst(1, blitz::Range::all(), blitz::Range::all());
 
     // execute
-    _sobel(src, kernel_y, dst_y, border_type);
-    _sobel(src, kernel_x, dst_x, border_type);
+    _sobel(src, dst_y, dst_x, magnitude, orientation, border_type, norm);
   }
 
 
@@ -10,10 +10,13 @@
 #ifndef BOB_IP_BASE_TAN_TRIGGS_H
 #define BOB_IP_BASE_TAN_TRIGGS_H
 
+#include <boost/format.hpp>
+
 #include <bob.core/assert.h>
-#include <bob.sp/conv.h>
 #include <bob.sp/extrapolate.h>
 
+#include <bob.ip.base/Gaussian.h>
+
 namespace bob { namespace ip { namespace base {
 
   /**
@@ -154,45 +157,57 @@ namespace bob { namespace ip { namespace base {
       void setRadius(const size_t radius) { m_radius = radius; computeDoG(m_sigma0, m_sigma1, 2*m_radius+1); }
       void setThreshold(const double threshold) { m_threshold = threshold; }
       void setAlpha(const double alpha) { m_alpha = alpha; }
-      void setConvBorder(const bob::sp::Extrapolation::BorderType border_type) { m_border_type = border_type; }
+      void setConvBorder(const bob::sp::Extrapolation::BorderType border_type) { m_border_type = border_type; m_gaussian0.setConvBorder(border_type); m_gaussian1.setConvBorder(border_type); }
+
+      /**
+       * @brief The scratch space of the process functions:
+       * the gamma-corrected (or logarithmic) image, the image smoothed by the outer Gaussian, and the workspace that both Gaussians of the DoG share.
+       * The images take the size of the last processed image.
+       * It must not be used by several threads at the same time.
+       */
+      struct Workspace {
+        blitz::Array<double,2> img;
+        blitz::Array<double,2> outer;
+        Gaussian::Workspace gaussian;
+      };
+
+      /**
+       * @brief Returns the workspace of the calling thread, which is used when no workspace is given
+       */
+      static Workspace& threadWorkspace();
 
       /**
         * @brief Process a 2D blitz Array/Image by applying the preprocessing
         * algorihtm
         */
-      template <typename T> void process(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst)
+      template <typename T> void process(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst, Workspace& workspace) const
       {
         // Check input and output arrays
         bob::core::array::assertZeroBase(src);
         bob::core::array::assertZeroBase(dst);
         bob::core::array::assertSameShape(src, dst);
 
-        // Check and resize intermediate array if required
-        if (m_img_tmp.extent(0) != src.extent(0) || m_img_tmp.extent(1) != src.extent(1))
-          m_img_tmp.resize( src.extent(0), src.extent(1) );
+        // Check and resize intermediate arrays if required
+        _resize(workspace.img, src.extent(0), src.extent(1));
+        _resize(workspace.outer, src.extent(0), src.extent(1));
 
         // 1/ Perform gamma correction
         if( m_gamma > 0.)
-          bob::ip::base::gammaCorrection( src, m_img_tmp, m_gamma);
+          bob::ip::base::gammaCorrection( src, workspace.img, m_gamma);
         else
-          m_img_tmp = blitz::log( 1. + src );
-
-        // 2/ Convolution with the DoG Filter
-        if (m_border_type == bob::sp::Extrapolation::Zero)
-          sp::conv( m_img_tmp, m_kernel, dst, bob::sp::Conv::Same);
-        else {
-          m_img_tmp2.resize(bob::sp::getConvOutputSize(m_img_tmp, m_kernel, bob::sp::Conv::Full));
-          if (m_border_type == bob::sp::Extrapolation::NearestNeighbour)
-            bob::sp::extrapolateNearest(m_img_tmp, m_img_tmp2);
-          else if (m_border_type == bob::sp::Extrapolation::Circular)
-            bob::sp::extrapolateCircular(m_img_tmp, m_img_tmp2);
-          else
-            bob::sp::extrapolateMirror(m_img_tmp, m_img_tmp2);
-          bob::sp::conv( m_img_tmp2, m_kernel, dst, bob::sp::Conv::Valid);
-        }
-
-        // 3/ Perform contrast equalization
-        performContrastEqualization(dst);
+          workspace.img = blitz::log( 1. + src );
+
+        // 2/ Convolution with the DoG Filter, which is separated into two Gaussians
+        m_gaussian0.filter_(workspace.img, dst, workspace.gaussian);
+        m_gaussian1.filter_(workspace.img, workspace.outer, workspace.gaussian);
+
+        // 3/ Compute the difference of the Gaussians and perform contrast equalization
+        performContrastEqualization(workspace.outer, dst);
+      }
+
+      template <typename T> void process(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst) const
+      {
+        process(src, dst, threadWorkspace());
       }
 
 
@@ -200,8 +215,11 @@ namespace bob { namespace ip { namespace base {
       /**
         * @brief Perform the contrast equalization step on a 2D blitz
         * Array/Image.
+        * On input, dst contains the image filtered with the inner Gaussian,
+        * and outer the image filtered with the outer Gaussian, which is
+        * overwritten.
         */
-      void performContrastEqualization( blitz::Array<double,2>& img);
+      void performContrastEqualization(blitz::Array<double,2>& outer, blitz::Array<double,2>& dst) const;
 
       /**
         * @brief Generate the difference of Gaussian filter
@@ -210,8 +228,8 @@ namespace bob { namespace ip { namespace base {
 
       // Attributes
       blitz::Array<double, 2> m_kernel;
-      blitz::Array<double, 2> m_img_tmp;
-      blitz::Array<double, 2> m_img_tmp2;
+      Gaussian m_gaussian0;
+      Gaussian m_gaussian1;
       double m_gamma;
       double m_sigma0;
       double m_sigma1;
@@ -0,0 +1,285 @@
+/**
+ * @date Fri Oct 16 10:12:45 CEST 2026
+ * @author Manuel Guenther <manuel.guenther@idiap.ch>
+ *
+ * @brief This file defines a class storing a precomputed geometric normalization
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_IP_BASE_WARP_MAP_H
+#define BOB_IP_BASE_WARP_MAP_H
+
+#include <stdint.h>
+#include <bob.core/assert.h>
+#include <bob.core/check.h>
+#include <bob.core/array_copy.h>
+
+#include <bob.ip.base/GeomNorm.h>
+#include <bob.ip.base/FaceEyesNorm.h>
+
+namespace bob { namespace ip { namespace base {
+
+  /** the type used to accumulate the weighted source values in WarpMap::remap */
+  template <typename T> struct _WarpAccumulator {typedef int64_t type;};
+  template <> struct _WarpAccumulator<float> {typedef double type;};
+  template <> struct _WarpAccumulator<double> {typedef double type;};
+
+  /**
+   * @brief This class stores the bi-linear interpolation of a geometric
+   * normalization for a given source image size and transformation center.
+   *
+   * For each target pixel, the offset of the upper left source pixel and the
+   * fixed-point weights of the four source pixels are precomputed once.
+   * Applying the map to an image (e.g., to all frames of a video, or to all
+   * color planes) is then a pure gather, with no trigonometry, division or
+   * bounds checks per pixel.
+   *
+   * The source positions are identical to the ones of GeomNorm::process.
+   * Due to the fixed-point weights (WEIGHT_BITS per axis), the results
+   * differ by at most 2^-WEIGHT_BITS times the range of the source values.
+   * The map always uses bi-linear interpolation, independent of GeomNorm::getInterpolation.
+   */
+  class WarpMap
+  {
+    public:
+
+      /** number of fractional bits of the interpolation weights in each direction */
+      static const int WEIGHT_BITS = 15;
+
+      /**
+        * @brief Constructs the map of the given geometric normalization for
+        * source images of the given shape, transformed around the given center
+        */
+      WarpMap(
+        const GeomNorm& geomNorm,
+        const blitz::TinyVector<int,2>& sourceShape,
+        const blitz::TinyVector<double,2>& center
+      );
+
+      /**
+        * @brief Constructs the map of the given face normalization for
+        * source images of the given shape and the given eye positions
+        */
+      WarpMap(
+        const FaceEyesNorm& faceEyesNorm,
+        const blitz::TinyVector<int,2>& sourceShape,
+        const blitz::TinyVector<double,2>& rightEye,
+        const blitz::TinyVector<double,2>& leftEye
+      );
+
+      /**
+       * @brief Copy constructor
+       */
+      WarpMap(const WarpMap& other);
+
+      /**
+        * @brief Destructor
+        */
+      virtual ~WarpMap() {}
+
+      /**
+       * @brief Assignment operator
+       */
+      WarpMap& operator=(const WarpMap& other);
+
+      /**
+       * @brief Equal to
+       */
+      bool operator==(const WarpMap& b) const;
+      /**
+       * @brief Not equal to
+       */
+      bool operator!=(const WarpMap& b) const;
+
+      /**
+        * @brief Accessors
+        */
+      const blitz::TinyVector<int,2>& getSourceShape() const {return m_sourceShape;}
+      blitz::TinyVector<int,2> getTargetShape() const {return m_offsets.shape();}
+
+      /**
+        * @brief Applies the precomputed geometric normalization to the given 2D image
+        */
+      template <typename T>
+      void remap(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst) const;
+      template <typename T>
+      void remap(const blitz::Array<T,2>& src, const blitz::Array<bool,2>& srcMask, blitz::Array<double,2>& dst, blitz::Array<bool,2>& dstMask) const;
+
+      /**
+        * @brief Applies the precomputed geometric normalization to each plane
+        * of the given 3D array, i.e., to a stack of images or to the color planes of an image;
+        * a 2D mask is shared by all planes
+        */
+      template <typename T>
+      void remap(const blitz::Array<T,3>& src, blitz::Array<double,3>& dst) const;
+      template <typename T>
+      void remap(const blitz::Array<T,3>& src, const blitz::Array<bool,2>& srcMask, blitz::Array<double,3>& dst, blitz::Array<bool,2>& dstMask) const;
+
+    private:
+
+      void init(const GeomNorm& geomNorm, const blitz::TinyVector<double,2>& center);
+
+      template <typename T, bool mask>
+      void remapNoCheck(const blitz::Array<T,2>& src, const blitz::Array<bool,2>& srcMask, blitz::Array<double,2>& dst, blitz::Array<bool,2>& dstMask) const;
+
+      /**
+        * Attributes
+        */
+      blitz::TinyVector<int,2> m_sourceShape;
+      // the distance between two neighboring source pixels in x and y direction (0 for images of width or height 1)
+      int m_stepX;
+      int m_stepY;
+      // the offset of the upper left source pixel for each target pixel
+      blitz::Array<int32_t,2> m_offsets;
+      // the four weights (upper left, upper right, lower left, lower right) for each target pixel, summing up to 2^(2*WEIGHT_BITS)
+      blitz::Array<int32_t,3> m_weights;
+      // bits 0-3: the corresponding pixel has a positive weight; bit 4: the footprint reaches outside the source image
+      blitz::Array<uint8_t,2> m_flags;
+  };
+
+  /** helper function to get a row-major contiguous version of the given array, copying the data only when required */
+  template <typename T>
+  static inline blitz::Array<T,2> _row_major(const blitz::Array<T,2>& array){
+    if (array.stride(1) == 1 && array.stride(0) == array.extent(1))
+      return array;
+    blitz::Array<T,2> copy(array.shape());
+    copy = array;
+    return copy;
+  }
+
+  template <typename T, bool mask>
+  inline void WarpMap::remapNoCheck(
+    const blitz::Array<T,2>& src,
+    const blitz::Array<bool,2>& srcMask,
+    blitz::Array<double,2>& dst,
+    blitz::Array<bool,2>& dstMask
+  ) const
+  {
+    typedef typename _WarpAccumulator<T>::type A;
+    const double norm = 1. / (double)(int64_t(1) << (2 * WEIGHT_BITS));
+
+    const blitz::Array<T,2> source = _row_major(src);
+    const T* s = source.data();
+    blitz::Array<bool,2> sourceMask;
+    const bool* m = 0;
+    if (mask){
+      sourceMask.reference(_row_major(srcMask));
+      m = sourceMask.data();
+    }
+
+    // the offsets of the four pixels of the footprint
+    const int o[4] = {0, m_stepX, m_stepY, m_stepY + m_stepX};
+
+    const int32_t* offset = m_offsets.data();
+    const int32_t* weight = m_weights.data();
+    const uint8_t* flags = m_flags.data();
+    for (int y = 0; y < dst.extent(0); ++y){
+      for (int x = 0; x < dst.extent(1); ++x, ++offset, weight += 4, ++flags){
+        const T* p = s + *offset;
+        if (mask){
+          const bool* q = m + *offset;
+          bool valid = !(*flags & 16);
+          A sum = 0;
+          for (int i = 0; i < 4; ++i){
+            if (q[o[i]])
+              sum += (A)weight[i] * p[o[i]];
+            else if (*flags & (1 << i))
+              valid = false;
+          }
+          dst(y,x) = sum * norm;
+          dstMask(y,x) = valid;
+        } else {
+          dst(y,x) = ((A)weight[0] * p[o[0]] + (A)weight[1] * p[o[1]] + (A)weight[2] * p[o[2]] + (A)weight[3] * p[o[3]]) * norm;
+        }
+      }
+    }
+  }
+
+  template <typename T>
+  inline void WarpMap::remap(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst) const
+  {
+    // Check input
+    bob::core::array::assertZeroBase(src);
+    bob::core::array::assertSameShape(src, m_sourceShape);
+
+    // Check output
+    bob::core::array::assertZeroBase(dst);
+    bob::core::array::assertSameShape(dst, getTargetShape());
+
+    // Process
+    blitz::Array<bool,2> srcMask, dstMask;
+    remapNoCheck<T,false>(src, srcMask, dst, dstMask);
+  }
+
+  template <typename T>
+  inline void WarpMap::remap(const blitz::Array<T,2>& src, const blitz::Array<bool,2>& srcMask, blitz::Array<double,2>& dst, blitz::Array<bool,2>& dstMask) const
+  {
+    // Check input
+    bob::core::array::assertZeroBase(src);
+    bob::core::array::assertZeroBase(srcMask);
+    bob::core::array::assertSameShape(src, m_sourceShape);
+    bob::core::array::assertSameShape(srcMask, m_sourceShape);
+
+    // Check output
+    bob::core::array::assertZeroBase(dst);
+    bob::core::array::assertZeroBase(dstMask);
+    bob::core::array::assertSameShape(dst, getTargetShape());
+    bob::core::array::assertSameShape(dstMask, getTargetShape());
+
+    // Process
+    remapNoCheck<T,true>(src, srcMask, dst, dstMask);
+  }
+
+  template <typename T>
+  inline void WarpMap::remap(const blitz::Array<T,3>& src, blitz::Array<double,3>& dst) const
+  {
+    // Check input
+    bob::core::array::assertZeroBase(src);
+    bob::core::array::assertSameDimensionLength(src.extent(1), m_sourceShape[0]);
+    bob::core::array::assertSameDimensionLength(src.extent(2), m_sourceShape[1]);
+
+    // Check output
+    bob::core::array::assertZeroBase(dst);
+    bob::core::array::assertSameDimensionLength(src.extent(0), dst.extent(0));
+    bob::core::array::assertSameDimensionLength(dst.extent(1), m_offsets.extent(0));
+    bob::core::array::assertSameDimensionLength(dst.extent(2), m_offsets.extent(1));
+
+    // Process each plane
+    blitz::Array<bool,2> srcMask, dstMask;
+    for (int p = 0; p < src.extent(0); ++p){
+      const blitz::Array<T,2> src_slice = src(p, blitz::Range::all(), blitz::Range::all());
+      blitz::Array<double,2> dst_slice = dst(p, blitz::Range::all(), blitz::Range::all());
+      remapNoCheck<T,false>(src_slice, srcMask, dst_slice, dstMask);
+    }
+  }
+
+  template <typename T>
+  inline void WarpMap::remap(const blitz::Array<T,3>& src, const blitz::Array<bool,2>& srcMask, blitz::Array<double,3>& dst, blitz::Array<bool,2>& dstMask) const
+  {
+    // Check input
+    bob::core::array::assertZeroBase(src);
+    bob::core::array::assertZeroBase(srcMask);
+    bob::core::array::assertSameDimensionLength(src.extent(1), m_sourceShape[0]);
+    bob::core::array::assertSameDimensionLength(src.extent(2), m_sourceShape[1]);
+    bob::core::array::assertSameShape(srcMask, m_sourceShape);
+
+    // Check output
+    bob::core::array::assertZeroBase(dst);
+    bob::core::array::assertZeroBase(dstMask);
+    bob::core::array::assertSameDimensionLength(src.extent(0), dst.extent(0));
+    bob::core::array::assertSameDimensionLength(dst.extent(1), m_offsets.extent(0));
+    bob::core::array::assertSameDimensionLength(dst.extent(2), m_offsets.extent(1));
+    bob::core::array::assertSameShape(dstMask, getTargetShape());
+
+    // Process each plane; the target mask is identical for all planes
+    for (int p = 0; p < src.extent(0); ++p){
+      const blitz::Array<T,2> src_slice = src(p, blitz::Range::all(), blitz::Range::all());
+      blitz::Array<double,2> dst_slice = dst(p, blitz::Range::all(), blitz::Range::all());
+      remapNoCheck<T,true>(src_slice, srcMask, dst_slice, dstMask);
+    }
+  }
+
+} } } // namespaces
+
+#endif // BOB_IP_BASE_WARP_MAP_H
@@ -15,6 +15,8 @@
 #include <bob.sp/conv.h>
 #include <bob.sp/extrapolate.h>
 
+#include <bob.ip.base/Gaussian.h>
+
 namespace bob { namespace ip { namespace base {
 
   /**
@@ -102,43 +104,96 @@ namespace bob { namespace ip { namespace base {
       void setConvBorder(const bob::sp::Extrapolation::BorderType border_type){ m_conv_border = border_type; }
 
 
+      /**
+        * @brief The scratch space of the filter functions:
+        * the image extrapolated by the radius of the filter, its integral image, and the converted source image.
+        * Since src is extrapolated before any pixel of dst is written, images can be filtered in place.
+        * It must not be used by several threads at the same time.
+        */
+      struct Workspace {
+        blitz::Array<double,2> src_extra;
+        blitz::Array<double,2> src_integral;
+        blitz::Array<double,2> src;
+      };
+
+      /**
+        * @brief Returns the workspace of the calling thread, which is used when no workspace is given
+        */
+      static Workspace& threadWorkspace();
+
+      /**
+        * @brief Extrapolates the given image by the radius of this filter, and computes the integral image
+        * (with an additional zero row and column) of the extrapolated image.
+        * @param src The 2D input blitz array
+        * @param src_extra The extrapolated image, will be resized if required
+        * @param src_integral The integral image of the extrapolated image, will be resized if required
+        */
+      void extrapolate(const blitz::Array<double,2>& src, blitz::Array<double,2>& src_extra, blitz::Array<double,2>& src_integral) const;
+
+      /**
+        * @brief Process a 2D blitz Array/Image that was extrapolated before (see extrapolate),
+        * possibly by a larger radius, so that several filters can share the same extrapolated image.
+        * @param src_extra The extrapolated image
+        * @param src_integral The integral image of the extrapolated image
+        * @param dst The 2D output blitz array
+        * @param threads The number of threads that process bands of rows (see _thread_count)
+        */
+      void filterExtrapolated(const blitz::Array<double,2>& src_extra, const blitz::Array<double,2>& src_integral, blitz::Array<double,2>& dst, const int threads = 1) const;
+
       /**
         * @brief Process a 2D blitz Array/Image
+        * For each pixel, the number of pixels above the threshold and the kernel-weighted sums
+        * of the pixels above and below the threshold are computed in a single pass over the window.
         * @param src The 2D input blitz array
         * @param dst The 2D output blitz array
+        * @param workspace The scratch space to use
+        * @param threads The number of threads that process bands of rows (see _thread_count)
         */
-      void filter_(const blitz::Array<double,2>& src, blitz::Array<double,2>& dst);
+      void filter_(const blitz::Array<double,2>& src, blitz::Array<double,2>& dst, Workspace& workspace, const int threads = 1) const;
+      void filter_(const blitz::Array<double,2>& src, blitz::Array<double,2>& dst, const int threads = 1) const { filter_(src, dst, threadWorkspace(), threads); }
 
       /**
         * @brief Process a 2D blitz Array/Image
         * @param src The 2D input blitz array
         * @param dst The 2D output blitz array
+        * @param workspace The scratch space to use; if not given, the workspace of the calling thread is used
+        * @param threads The number of threads that process bands of rows (see _thread_count)
         */
       template <typename T>
-      void filter(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst){
-        // Casts the input to double
-        blitz::Array<double,2> src_d = bob::core::array::cast<double>(src);
-        // Calls the specialized template function for double
-        filter_(src_d, dst);
+      void filter(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst, Workspace& workspace, const int threads = 1) const{
+        // Casts the input to double, and calls the specialized function for double
+        filter_(_as_double(src, workspace.src), dst, workspace, threads);
+      }
+
+      template <typename T>
+      void filter(const blitz::Array<T,2>& src, blitz::Array<double,2>& dst, const int threads = 1) const{
+        filter(src, dst, threadWorkspace(), threads);
       }
 
       /**
         * @brief Process a 3D blitz Array/Image
         * @param src The 3D input blitz array
         * @param dst The 3D output blitz array
+        * @param workspace The scratch space to use; if not given, the workspace of the calling thread is used
+        * @param threads The number of threads that process bands of rows (see _thread_count)
         */
       template <typename T>
-      void filter(const blitz::Array<T,3>& src, blitz::Array<double,3>& dst){
+      void filter(const blitz::Array<T,3>& src, blitz::Array<double,3>& dst, Workspace& workspace, const int threads = 1) const{
         // Check number of planes
         bob::core::array::assertSameDimensionLength(src.extent(0), dst.extent(0));
         for( int p=0; p<dst.extent(0); ++p){
           const blitz::Array<T,2> src_slice = src( p, blitz::Range::all(), blitz::Range::all() );
           blitz::Array<double,2> dst_slice = dst( p, blitz::Range::all(), blitz::Range::all() );
           // Weighted Gaussian smooth plane
-          filter(src_slice, dst_slice);
+          filter(src_slice, dst_slice, workspace, threads);
         }
       }
 
+      template <typename T>
+      void filter(const blitz::Array<T,3>& src, blitz::Array<double,3>& dst, const int threads = 1) const{
+        filter(src, dst, threadWorkspace(), threads);
+      }
+
     private:
       void computeKernel();
 
@@ -152,10 +207,6 @@ namespace bob { namespace ip { namespace base {
       bob::sp::Extrapolation::BorderType m_conv_border;
 
       blitz::Array<double,2> m_kernel;
-      blitz::Array<double,2> m_kernel_weighted;
-
-      blitz::Array<double,2> m_src_extra;
-      blitz::Array<double,2> m_src_integral;
   };
 
 } } } // namespaces
@@ -10,11 +10,92 @@
 
 #include <blitz/array.h>
 #include <complex>
+#include <vector>
 #include <bob.io.base/HDF5File.h>
 #include <bob.sp/FFT2D.h>
 
+#include <bob.ip.base/Parallel.h>
+
 namespace bob { namespace ip { namespace base {
 
+/**
+ * @brief Accumulates the statistics to train a Wiener filter, i.e., the mean
+ * and the variance of the absolute FFT of the training images at each
+ * frequency.\n
+ *
+ * The statistics are updated with each image using Welford's online
+ * algorithm, so that the memory does not depend on the number of training
+ * images. Trainers that accumulated different parts of the training set
+ * (e.g., in different threads) can be merged.
+ */
+class WienerTrainer
+{
+  public: //api
+    /**
+     * @brief Creates an empty trainer for images of the given size
+     */
+    WienerTrainer(const blitz::TinyVector<int,2>& size);
+
+    /**
+     * @brief Copy constructor
+     */
+    WienerTrainer(const WienerTrainer& other);
+
+    /**
+     * @brief Assignment operator
+     */
+    WienerTrainer& operator=(const WienerTrainer& other);
+
+    /**
+     * @brief Adds the given training image
+     */
+    void add(const blitz::Array<double,2>& sample);
+
+    /**
+     * @brief Adds the given training images, which are distributed over the
+     * given number of threads (see _thread_count)
+     */
+    void add(const blitz::Array<double,3>& samples, const int threads = 1);
+
+    /**
+     * @brief Merges the statistics of the other trainer into this trainer
+     */
+    void merge(const WienerTrainer& other);
+
+    /**
+     * @brief Removes all statistics
+     */
+    void reset();
+
+    /**
+     * @brief Returns the size of the training images
+     */
+    blitz::TinyVector<int,2> getSize() const {return m_mean.shape();}
+
+    /**
+     * @brief Returns the number of training images accumulated so far
+     */
+    size_t getCount() const {return m_count;}
+
+    /**
+     * @brief Returns the mean of the absolute FFT at each frequency
+     */
+    const blitz::Array<double,2>& getMean() const {return m_mean;}
+
+    /**
+     * @brief Returns the variance of the absolute FFT at each frequency
+     */
+    blitz::Array<double,2> getVariance() const;
+
+  private: //representation
+    size_t m_count; ///< the number of accumulated images
+    blitz::Array<double,2> m_mean; ///< the mean of the absolute FFT
+    blitz::Array<double,2> m_m2; ///< the sum of squared differences from the mean of the absolute FFT
+    bob::sp::FFT2D m_fft;
+    blitz::Array<std::complex<double>,2> m_signal; ///< a buffer for speed
+    blitz::Array<std::complex<double>,2> m_spectrum; ///< a buffer for speed
+};
+
 /**
  * @brief A Wiener filter, which can be used to denoise a signal,
  * by comparing with a statistical model of the noiseless signal.\n
@@ -89,13 +170,45 @@ class Wiener
      */
     void train(const blitz::Array<double,3>& data);
 
+    /**
+     * @brief Trains the Wiener filter with the statistics accumulated by the
+     * given trainer.
+     */
+    void train(const WienerTrainer& trainer);
+
+    /**
+     * @brief The scratch space of the filter functions, i.e., the FFT plans and the spectra.
+     * Unlike the image filters, a Wiener filter works on images of a single size;
+     * the plans and spectra are set up again only when the workspace alternates between filters of different sizes.
+     * It must not be used by several threads at the same time.
+     */
+    struct Workspace {
+      bob::sp::FFT2D fft;
+      bob::sp::IFFT2D ifft;
+      blitz::Array<std::complex<double>,2> signal;
+      blitz::Array<std::complex<double>,2> spectrum;
+    };
+
+    /**
+     * @brief Returns the workspace of the calling thread, which is used when no workspace is given
+     */
+    static Workspace& threadWorkspace();
+
     /**
      * @brief filters the given input image
      *
      * The input and output are NOT checked for compatibility each time. It
      * is your responsibility to do it.
+     *
+     * For images of even width, the real input is transformed with a complex
+     * FFT of half the width, by packing the even and odd columns into the
+     * real and imaginary parts; the filter is applied to the non-redundant
+     * half of the spectrum only. This requires a (point-)symmetric filter,
+     * i.e., W(y,x) == W(-y,-x), as it is obtained by training; otherwise,
+     * the full complex spectrum is filtered.
      */
-    void filter_(const blitz::Array<double,2>& input, blitz::Array<double,2>& output) const;
+    void filter_(const blitz::Array<double,2>& input, blitz::Array<double,2>& output, Workspace& workspace) const;
+    void filter_(const blitz::Array<double,2>& input, blitz::Array<double,2>& output) const { filter_(input, output, threadWorkspace()); }
 
     /**
      * @brief filters the given input image
@@ -105,6 +218,14 @@ class Wiener
      */
     void filter(const blitz::Array<double,2>& input, blitz::Array<double,2>& output) const;
 
+    /**
+     * @brief filters the given stack of images
+     *
+     * The images are distributed over the given number of threads (see
+     * _thread_count), each of which uses its own workspace.
+     */
+    void filter(const blitz::Array<double,3>& input, blitz::Array<double,3>& output, const int threads = 1) const;
+
     /**
      * @brief Resizes the filter and preserves the data
      */
@@ -156,18 +277,18 @@ class Wiener
 
   private: //representation
     void computeW(); /// Compute the Wiener filter using Pn, Ps, etc.
+    void computeHalfW(); /// Extract the non-redundant half of a symmetric Wiener filter
     void applyVarianceThreshold(); /// Apply variance flooring threshold
+    void filterComplex(const blitz::Array<double,2>& input, blitz::Array<double,2>& output, Workspace& workspace) const;
+    void filterReal(const blitz::Array<double,2>& input, blitz::Array<double,2>& output, Workspace& workspace) const;
 
     blitz::Array<double, 2> m_Ps; ///< variance at each frequency estimated empirically
     double m_variance_threshold; ///< Threshold on Ps values when computing the Wiener filter
                                  ///  (to avoid division by zero)
     double m_Pn; ///< variance of the noise
     blitz::Array<double, 2> m_W; ///< Wiener filter in the frequency domain (W=1/(1+Pn/Ps))
-    bob::sp::FFT2D m_fft;
-    bob::sp::IFFT2D m_ifft;
-
-    mutable blitz::Array<std::complex<double>, 2> m_buffer1; ///< a buffer for speed
-    mutable blitz::Array<std::complex<double>, 2> m_buffer2; ///< a buffer for speed
+    blitz::Array<double, 2> m_W_half; ///< the columns [0, width/2] of a symmetric W of even width; empty otherwise
+    std::vector<std::complex<double> > m_twiddle; ///< the twiddle factors exp(-2*pi*i*x/width) to split the packed spectrum
 };
 
 } } } // namespaces
@@ -47,6 +47,30 @@ static PyMethodDef module_methods[] = {
     METH_VARARGS|METH_KEYWORDS,
     s_extrapolateMask.doc()
   },
+  {
+    s_crop.name(),
+    (PyCFunction)PyBobIpBase_crop,
+    METH_VARARGS|METH_KEYWORDS,
+    s_crop.doc()
+  },
+  {
+    s_shift.name(),
+    (PyCFunction)PyBobIpBase_shift,
+    METH_VARARGS|METH_KEYWORDS,
+    s_shift.doc()
+  },
+  {
+    s_flip.name(),
+    (PyCFunction)PyBobIpBase_flip,
+    METH_VARARGS|METH_KEYWORDS,
+    s_flip.doc()
+  },
+  {
+    s_flop.name(),
+    (PyCFunction)PyBobIpBase_flop,
+    METH_VARARGS|METH_KEYWORDS,
+    s_flop.doc()
+  },
   {
     s_block.name(),
     (PyCFunction)PyBobIpBase_block,
@@ -148,6 +172,7 @@ static PyObject* create_module (void) {
   if (PyModule_AddStringConstant(module, "__version__", BOB_EXT_MODULE_VERSION) < 0) return 0;
   if (!init_BobIpBaseGeomNorm(module)) return 0;
   if (!init_BobIpBaseFaceEyesNorm(module)) return 0;
+  if (!init_BobIpBaseWarpMap(module)) return 0;
   if (!init_BobIpBaseLBP(module)) return 0;
   if (!init_BobIpBaseLBPTop(module)) return 0;
   if (!init_BobIpBaseDCTFeatures(module)) return 0;
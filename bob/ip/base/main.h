@@ -28,9 +28,11 @@
 #include <bob.ip.base/SelfQuotientImage.h>
 #include <bob.ip.base/GaussianScaleSpace.h>
 #include <bob.ip.base/SIFT.h>
+#include <bob.ip.base/Sobel.h>
 #include <bob.ip.base/HOG.h>
 #include <bob.ip.base/GeomNorm.h>
 #include <bob.ip.base/FaceEyesNorm.h>
+#include <bob.ip.base/WarpMap.h>
 #include <bob.ip.base/GLCM.h>
 #include <bob.ip.base/Wiener.h>
 
@@ -42,6 +44,42 @@ static inline int insert_item_string(PyObject* dict, PyObject* entries, const ch
   return PyDict_SetItemString(entries, key, v.get());
 }
 
+/// converts the given interpolation name ('bilinear' or 'area') to the according interpolation
+static inline bob::ip::base::Interpolation interpolation_from_string(const std::string& name){
+  if (name == "bilinear") return bob::ip::base::INTERPOLATION_BILINEAR;
+  if (name == "area") return bob::ip::base::INTERPOLATION_AREA;
+  throw std::runtime_error("The given interpolation '" + name + "' is not known; choose one of ('bilinear', 'area')");
+}
+/// converts the given interpolation to its name
+static inline const char* interpolation_to_string(bob::ip::base::Interpolation interpolation){
+  switch (interpolation){
+    case bob::ip::base::INTERPOLATION_BILINEAR: return "bilinear";
+    case bob::ip::base::INTERPOLATION_AREA: return "area";
+  }
+  throw std::runtime_error("The given interpolation is not known");
+}
+
+/// converts the given Gaussian mode name ('fir' or 'iir') to the according mode
+static inline bob::ip::base::GaussianMode gaussian_mode_from_string(const std::string& name){
+  if (name == "fir") return bob::ip::base::GAUSSIAN_FIR;
+  if (name == "iir") return bob::ip::base::GAUSSIAN_IIR;
+  throw std::runtime_error("The given Gaussian mode '" + name + "' is not known; choose one of ('fir', 'iir')");
+}
+/// converts the given Gaussian mode to its name
+static inline const char* gaussian_mode_to_string(bob::ip::base::GaussianMode mode){
+  switch (mode){
+    case bob::ip::base::GAUSSIAN_FIR: return "fir";
+    case bob::ip::base::GAUSSIAN_IIR: return "iir";
+  }
+  throw std::runtime_error("The given Gaussian mode is not known");
+}
+/// converts the given Sobel norm name ('l2' or 'l1') to the according norm
+static inline bob::ip::base::SobelNorm sobel_norm_from_string(const std::string& name){
+  if (name == "l2") return bob::ip::base::SOBEL_L2;
+  if (name == "l1") return bob::ip::base::SOBEL_L1;
+  throw std::runtime_error("The given Sobel norm '" + name + "' is not known; choose one of ('l2', 'l1')");
+}
+
 
 // GeomNorm
 typedef struct {
@@ -63,6 +101,16 @@ extern PyTypeObject PyBobIpBaseFaceEyesNorm_Type;
 bool init_BobIpBaseFaceEyesNorm(PyObject* module);
 int PyBobIpBaseFaceEyesNorm_Check(PyObject* o);
 
+// WarpMap
+typedef struct {
+  PyObject_HEAD
+  boost::shared_ptr<bob::ip::base::WarpMap> cxx;
+} PyBobIpBaseWarpMapObject;
+
+extern PyTypeObject PyBobIpBaseWarpMap_Type;
+bool init_BobIpBaseWarpMap(PyObject* module);
+int PyBobIpBaseWarpMap_Check(PyObject* o);
+
 // .. scaling
 PyObject* PyBobIpBase_scale(PyObject*, PyObject*, PyObject*);
 extern bob::extension::FunctionDoc s_scale;
@@ -79,6 +127,15 @@ PyObject* PyBobIpBase_maxRectInMask(PyObject*, PyObject*, PyObject*);
 extern bob::extension::FunctionDoc s_maxRectInMask;
 PyObject* PyBobIpBase_extrapolateMask(PyObject*, PyObject*, PyObject*);
 extern bob::extension::FunctionDoc s_extrapolateMask;
+// .. cropping, shifting and flipping
+PyObject* PyBobIpBase_crop(PyObject*, PyObject*, PyObject*);
+extern bob::extension::FunctionDoc s_crop;
+PyObject* PyBobIpBase_shift(PyObject*, PyObject*, PyObject*);
+extern bob::extension::FunctionDoc s_shift;
+PyObject* PyBobIpBase_flip(PyObject*, PyObject*, PyObject*);
+extern bob::extension::FunctionDoc s_flip;
+PyObject* PyBobIpBase_flop(PyObject*, PyObject*, PyObject*);
+extern bob::extension::FunctionDoc s_flop;
 
 
 // LBP
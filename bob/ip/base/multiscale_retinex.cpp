@@ -24,13 +24,14 @@ static auto MultiscaleRetinex_doc = bob::extension::ClassDoc(
     ".. todo:: Add documentation for MultiscaleRetinex",
     true
   )
-  .add_prototype("[scales], [size_min], [size_step], [sigma], [border]","")
+  .add_prototype("[scales], [size_min], [size_step], [sigma], [border], [cascaded]","")
   .add_prototype("msrx", "")
   .add_parameter("scales", "int", "[default: 1] The number of scales (:py:class:`bob.ip.base.Gaussian`)")
   .add_parameter("size_min", "int", "[default: 1] The radius of the kernel of the smallest :py:class:`bob.ip.base.Gaussian`")
   .add_parameter("size_step", "int", "[default: 1] The step used to set the kernel size of other weighted Gaussians: ``size_s = 2 * (size_min + s * size_step) + 1``")
   .add_parameter("sigma", "double", "[default: 2.] The standard deviation of the kernel of the smallest weighted Gaussian; other sigmas: ``sigma_s = sigma * (size_min + s * size_step) / size_min``")
   .add_parameter("border", ":py:class:`bob.sp.BorderType`", "[default: ``bob.sp.BorderType.Mirror``] The extrapolation method used by the convolution at the border")
+  .add_parameter("cascaded", "bool", "[default: ``False``] Compute each scale by smoothing the previous one, see :py:attr:`cascaded`")
   .add_parameter("msrx", ":py:class:`bob.ip.base.MultiscaleRetinex`", "The MultiscaleRetinex object to use for copy-construction")
 );
 
@@ -57,12 +58,13 @@ static int PyBobIpBaseMultiscaleRetinex_init(PyBobIpBaseMultiscaleRetinexObject*
   int scales = 1, size_min = 1, size_step = 1;
   double sigma = 2.;
   bob::sp::Extrapolation::BorderType border = bob::sp::Extrapolation::Mirror;
+  PyObject* cascaded = 0;
 
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|iiidO&", kwlist1, &scales, &size_min, &size_step, &sigma, &PyBobSpExtrapolationBorder_Converter, &border)){
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|iiidO&O!", kwlist1, &scales, &size_min, &size_step, &sigma, &PyBobSpExtrapolationBorder_Converter, &border, &PyBool_Type, &cascaded)){
     MultiscaleRetinex_doc.print_usage();
     return -1;
   }
-  self->cxx.reset(new bob::ip::base::MultiscaleRetinex(scales, size_min, size_step, sigma, border));
+  self->cxx.reset(new bob::ip::base::MultiscaleRetinex(scales, size_min, size_step, sigma, border, cascaded && PyObject_IsTrue(cascaded)));
   return 0;
 
   BOB_CATCH_MEMBER("cannot create MultiscaleRetinex", -1)
@@ -204,6 +206,31 @@ int PyBobIpBaseMultiscaleRetinex_setBorder(PyBobIpBaseMultiscaleRetinexObject* s
   BOB_CATCH_MEMBER("border could not be set", -1)
 }
 
+static auto cascaded = bob::extension::VariableDoc(
+  "cascaded",
+  "bool",
+  "Compute each scale by smoothing the previous scale instead of the source image; with read and write access",
+  "In cascaded mode, scale ``s`` is computed from scale ``s-1`` with a Gaussian of standard deviation ``sqrt(sigma_s^2 - sigma_{s-1}^2)``, which has a smaller kernel than the Gaussian of scale ``s``. "
+  "Inside the image, the result is close to the independent smoothing, when the kernels are not truncated too much (i.e., ``size_min >= 3*sigma``); at the image borders, the results differ. "
+  "The cascaded mode is only used when ``size_step > 0``."
+);
+PyObject* PyBobIpBaseMultiscaleRetinex_getCascaded(PyBobIpBaseMultiscaleRetinexObject* self, void*){
+  BOB_TRY
+  if (self->cxx->getCascaded()) Py_RETURN_TRUE; else Py_RETURN_FALSE;
+  BOB_CATCH_MEMBER("cascaded could not be read", 0)
+}
+int PyBobIpBaseMultiscaleRetinex_setCascaded(PyBobIpBaseMultiscaleRetinexObject* self, PyObject* value, void*){
+  BOB_TRY
+  int r = PyObject_IsTrue(value);
+  if (r < 0){
+    PyErr_Format(PyExc_RuntimeError, "%s %s expects a bool", Py_TYPE(self)->tp_name, cascaded.name());
+    return -1;
+  }
+  self->cxx->setCascaded(r>0);
+  return 0;
+  BOB_CATCH_MEMBER("cascaded could not be set", -1)
+}
+
 static PyGetSetDef PyBobIpBaseMultiscaleRetinex_getseters[] = {
     {
       scales.name(),
@@ -240,6 +267,13 @@ static PyGetSetDef PyBobIpBaseMultiscaleRetinex_getseters[] = {
       border.doc(),
       0
     },
+    {
+      cascaded.name(),
+      (getter)PyBobIpBaseMultiscaleRetinex_getCascaded,
+      (setter)PyBobIpBaseMultiscaleRetinex_setCascaded,
+      cascaded.doc(),
+      0
+    },
     {0}  /* Sentinel */
 };
 
@@ -253,19 +287,21 @@ static auto process = bob::extension::FunctionDoc(
   "process",
   "Applies the Self Quotient Image algorithm to an image (2D/grayscale or color 3D/color) of type uint8, uint16 or double",
   ".. todo:: Check if this documentation is correct (seems to be copied from :py:class:`bob.ip.base.SelfQuotientImage`\n\n"
-  "If given, the ``dst`` array should have the type float and the same size as the ``src`` array.\n\n"
+  "If given, the ``dst`` array should have the type float and the same size as the ``src`` array. "
+  "Unless :py:attr:`cascaded` is set, the scales are independent, and they can be smoothed in parallel by the given number of threads.\n\n"
   ".. note::\n\n  The `__call__` function is an alias for this method.",
   true
 )
-.add_prototype("src, [dst]", "dst")
+.add_prototype("src, [dst], [threads]", "dst")
 .add_parameter("src", "array_like (2D)", "The input image which should be processed")
 .add_parameter("dst", "array_like (2D, float)", "[default: ``None``] If given, the output will be saved into this image; must be of the same shape as ``src``")
+.add_parameter("threads", "int", "[default: 1] The number of threads to use; ``0`` uses one thread per CPU core")
 .add_return("dst", "array_like (2D, float)", "The resulting output image, which is the same as ``dst`` (if given)")
 ;
 
 template <typename T, int D>
-static PyObject* process_inner(PyBobIpBaseMultiscaleRetinexObject* self, PyBlitzArrayObject* input, PyBlitzArrayObject* output){
-  self->cxx->process(*PyBlitzArrayCxx_AsBlitz<T,D>(input), *PyBlitzArrayCxx_AsBlitz<double,D>(output));
+static PyObject* process_inner(PyBobIpBaseMultiscaleRetinexObject* self, PyBlitzArrayObject* input, PyBlitzArrayObject* output, int threads){
+  self->cxx->process(*PyBlitzArrayCxx_AsBlitz<T,D>(input), *PyBlitzArrayCxx_AsBlitz<double,D>(output), threads);
   return PyBlitzArray_AsNumpyArray(output, 0);
 }
 
@@ -274,8 +310,9 @@ static PyObject* PyBobIpBaseMultiscaleRetinex_process(PyBobIpBaseMultiscaleRetin
   char** kwlist = process.kwlist();
 
   PyBlitzArrayObject* src,* dst = 0;
+  int threads = 1;
 
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|O&", kwlist, &PyBlitzArray_Converter, &src, &PyBlitzArray_OutputConverter, &dst)) return 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|O&i", kwlist, &PyBlitzArray_Converter, &src, &PyBlitzArray_OutputConverter, &dst, &threads)) return 0;
 
   auto src_ = make_safe(src), dst_ = make_xsafe(dst);
 
@@ -305,9 +342,9 @@ static PyObject* PyBobIpBaseMultiscaleRetinex_process(PyBobIpBaseMultiscaleRetin
 
   // finally, extract the features
   switch (src->type_num){
-    case NPY_UINT8:   if (src->ndim == 2) return process_inner<uint8_t,2>(self, src, dst);  else return process_inner<uint8_t,3>(self, src, dst);
-    case NPY_UINT16:  if (src->ndim == 2) return process_inner<uint16_t,2>(self, src, dst); else return process_inner<uint16_t,3>(self, src, dst);
-    case NPY_FLOAT64: if (src->ndim == 2) return process_inner<double,2>(self, src, dst);   else return process_inner<double,3>(self, src, dst);
+    case NPY_UINT8:   if (src->ndim == 2) return process_inner<uint8_t,2>(self, src, dst, threads);  else return process_inner<uint8_t,3>(self, src, dst, threads);
+    case NPY_UINT16:  if (src->ndim == 2) return process_inner<uint16_t,2>(self, src, dst, threads); else return process_inner<uint16_t,3>(self, src, dst, threads);
+    case NPY_FLOAT64: if (src->ndim == 2) return process_inner<double,2>(self, src, dst, threads);   else return process_inner<double,3>(self, src, dst, threads);
     default:
       process.print_usage();
       PyErr_Format(PyExc_TypeError, "`%s' processes only images of types uint8, uint16 or float, and not from %s", Py_TYPE(self)->tp_name, PyBlitzArray_TypenumAsString(src->type_num));
@@ -0,0 +1,50 @@
+#!/usr/bin/env python
+# vim: set fileencoding=utf-8 :
+# Manuel Guenther <manuel.guenther@idiap.ch>
+# Fri Oct 16 13:05:11 CEST 2026
+#
+# Copyright (C) Idiap Research Institute, Martigny, Switzerland
+
+"""Measures the speed of bob.ip.base.rotate for several rotation angles.
+
+Rotated images can be traversed in square tiles (see the ``tile_size``
+parameter of bob.ip.base.rotate), so that the source pixels required for each
+tile stay in the cache. This script compares the throughput of the default row
+by row traversal with the tiled one. So far, tiles gave a clear gain only for
+angles close to 90 degrees on very large images; for other angles, both
+traversals are about equally fast.
+
+This script is not installed; run it with::
+
+  python -m bob.ip.base.script.benchmark_rotate
+"""
+
+import argparse
+import timeit
+
+import numpy
+
+import bob.ip.base
+
+
+def main(command_line_parameters = None):
+  parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+  parser.add_argument('-s', '--size', type=int, nargs=2, default=(3508, 2480), metavar=('HEIGHT', 'WIDTH'), help = "The size of the image to rotate (default: A4 page scanned with 300 dpi)")
+  parser.add_argument('-a', '--angles', type=float, nargs='+', default=(0., 15., 45., 90.), help = "The rotation angles in degrees")
+  parser.add_argument('-t', '--dtype', choices=('uint8', 'float64'), default='uint8', help = "The data type of the image")
+  parser.add_argument('-T', '--tile-size', type=int, default=64, help = "The tile size to compare with the row by row traversal")
+  parser.add_argument('-r', '--repetitions', type=int, default=5, help = "The number of times each rotation is repeated; the fastest one is reported")
+  args = parser.parse_args(command_line_parameters)
+
+  numpy.random.seed(42)
+  image = (numpy.random.random(args.size) * 255).astype(args.dtype)
+
+  print("Rotating a %dx%d %s image, best of %d runs" % (args.size[0], args.size[1], args.dtype, args.repetitions))
+  for angle in args.angles:
+    rotated = numpy.ndarray(bob.ip.base.rotated_output_shape(image, angle), numpy.float64)
+    times = [min(timeit.repeat(lambda: bob.ip.base.rotate(image, rotated, angle, tile_size), number=1, repeat=args.repetitions)) for tile_size in (0, args.tile_size)]
+    print("angle %6.1f: rows %8.1f ms, tiles %8.1f ms (%3.0f%% of rows)" % (angle, times[0] * 1000., times[1] * 1000., 100. * times[1] / times[0]))
+
+
+if __name__ == '__main__':
+  main()
@@ -254,19 +254,21 @@ static PyGetSetDef PyBobIpBaseSelfQuotientImage_getseters[] = {
 static auto process = bob::extension::FunctionDoc(
   "process",
   "Applies the Self Quotient Image algorithm to an image (2D/grayscale or 3D/color) of type uint8, uint16 or double",
-  "If given, the ``dst`` array should have the type float and the same size as the ``src`` array.\n\n"
+  "If given, the ``dst`` array should have the type float and the same size as the ``src`` array. "
+  "The image is extrapolated only once for all scales, which can be processed in parallel by the given number of threads.\n\n"
   ".. note::\n\n  The `__call__` function is an alias for this method.",
   true
 )
-.add_prototype("src, [dst]", "dst")
+.add_prototype("src, [dst], [threads]", "dst")
 .add_parameter("src", "array_like (2D)", "The input image which should be processed")
 .add_parameter("dst", "array_like (2D, float)", "[default: ``None``] If given, the output will be saved into this image; must be of the same shape as ``src``")
+.add_parameter("threads", "int", "[default: 1] The number of threads to use; ``0`` uses one thread per CPU core")
 .add_return("dst", "array_like (2D, float)", "The resulting output image, which is the same as ``dst`` (if given)")
 ;
 
 template <typename T, int D>
-static PyObject* process_inner(PyBobIpBaseSelfQuotientImageObject* self, PyBlitzArrayObject* input, PyBlitzArrayObject* output){
-  self->cxx->process(*PyBlitzArrayCxx_AsBlitz<T,D>(input), *PyBlitzArrayCxx_AsBlitz<double,D>(output));
+static PyObject* process_inner(PyBobIpBaseSelfQuotientImageObject* self, PyBlitzArrayObject* input, PyBlitzArrayObject* output, int threads){
+  self->cxx->process(*PyBlitzArrayCxx_AsBlitz<T,D>(input), *PyBlitzArrayCxx_AsBlitz<double,D>(output), threads);
   return PyBlitzArray_AsNumpyArray(output, 0);
 }
 
@@ -275,8 +277,9 @@ static PyObject* PyBobIpBaseSelfQuotientImage_process(PyBobIpBaseSelfQuotientIma
   char** kwlist = process.kwlist();
 
   PyBlitzArrayObject* src,* dst = 0;
+  int threads = 1;
 
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|O&", kwlist, &PyBlitzArray_Converter, &src, &PyBlitzArray_OutputConverter, &dst)) return 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|O&i", kwlist, &PyBlitzArray_Converter, &src, &PyBlitzArray_OutputConverter, &dst, &threads)) return 0;
 
   auto src_ = make_safe(src), dst_ = make_xsafe(dst);
 
@@ -306,9 +309,9 @@ static PyObject* PyBobIpBaseSelfQuotientImage_process(PyBobIpBaseSelfQuotientIma
 
   // finally, extract the features
   switch (src->type_num){
-    case NPY_UINT8:   if (src->ndim == 2) return process_inner<uint8_t,2>(self, src, dst);  else return process_inner<uint8_t,3>(self, src, dst);
-    case NPY_UINT16:  if (src->ndim == 2) return process_inner<uint16_t,2>(self, src, dst); else return process_inner<uint16_t,3>(self, src, dst);
-    case NPY_FLOAT64: if (src->ndim == 2) return process_inner<double,2>(self, src, dst);   else return process_inner<double,3>(self, src, dst);
+    case NPY_UINT8:   if (src->ndim == 2) return process_inner<uint8_t,2>(self, src, dst, threads);  else return process_inner<uint8_t,3>(self, src, dst, threads);
+    case NPY_UINT16:  if (src->ndim == 2) return process_inner<uint16_t,2>(self, src, dst, threads); else return process_inner<uint16_t,3>(self, src, dst, threads);
+    case NPY_FLOAT64: if (src->ndim == 2) return process_inner<double,2>(self, src, dst, threads);   else return process_inner<double,3>(self, src, dst, threads);
     default:
       process.print_usage();
       PyErr_Format(PyExc_TypeError, "`%s' processes only images of types uint8, uint16 or float, and not from %s", Py_TYPE(self)->tp_name, PyBlitzArray_TypenumAsString(src->type_num));
@@ -9,6 +9,8 @@
 
 #include "main.h"
 
+static inline bool f(PyObject* o){return o != 0 && PyObject_IsTrue(o) > 0;}  /* converts PyObject to bool and returns false if object is NULL */
+
 static auto SIFT_doc = bob::extension::ClassDoc(
   BOB_EXT_MODULE_PREFIX ".SIFT",
   "This class allows after configuration the extraction of SIFT descriptors",
@@ -21,7 +23,7 @@ static auto SIFT_doc = bob::extension::ClassDoc(
     ".. warning:: The order of the parameters ``scales`` and ``octaves`` has changed compared to the old implementation, in order to keep it consistent with :py:class:`bob.ip.base.VLSIFT`!",
     true
   )
-  .add_prototype("size, scales, octaves, octave_min, [sigma_n], [sigma0], [contrast_thres], [edge_thres], [norm_thres], [kernel_radius_factor], [border]", "")
+  .add_prototype("size, scales, octaves, octave_min, [sigma_n], [sigma0], [contrast_thres], [edge_thres], [norm_thres], [kernel_radius_factor], [border], [single_precision]", "")
   .add_prototype("sift", "")
   .add_parameter("size", "(int, int)", "The height and width of the images to process")
   .add_parameter("scales", "int", "The number of intervals of the pyramid. Three additional scales will be computed in practice, as this is required for extracting SIFT features")
@@ -34,6 +36,7 @@ static auto SIFT_doc = bob::extension::ClassDoc(
   .add_parameter("norm_thres", "float", "[default: 0.2] The norm threshold used during descriptor normalization")
   .add_parameter("kernel_radius_factor", "float", "[default: 4.] Factor used to determine the kernel radii: ``size=2*radius+1``. For each Gaussian kernel, the radius is equal to ``ceil(kernel_radius_factor*sigma_{octave,scale})``")
   .add_parameter("border", ":py:class:`bob.sp.BorderType`", "[default: ``bob.sp.BorderType.Mirror``] The extrapolation method used by the convolution at the border")
+  .add_parameter("single_precision", "bool", "[default: ``False``] Compute and store the Gaussian, DoG and gradient pyramids in single (float32) precision, which halves their memory; the descriptors are still returned in double precision")
   .add_parameter("sift", ":py:class:`bob.ip.base.SIFT`", "The SIFT object to use for copy-construction")
 );
 
@@ -62,12 +65,13 @@ static int PyBobIpBaseSIFT_init(PyBobIpBaseSIFTObject* self, PyObject* args, PyO
   int scales, octaves, octave_min;
   double sigma_n = 0.5, sigma0 = 1.6, contrast = 0.03, edge = 10., norm = 0.2, factor = 4.;
   bob::sp::Extrapolation::BorderType border = bob::sp::Extrapolation::Mirror;
+  PyObject* single = 0;
 
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "(ii)iii|ddddddO&", kwlist1, &size[0], &size[1], &scales, &octaves, &octave_min, &sigma_n, &sigma0, &contrast, &edge, &norm, &factor, &PyBobSpExtrapolationBorder_Converter, &border)){
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "(ii)iii|ddddddO&O!", kwlist1, &size[0], &size[1], &scales, &octaves, &octave_min, &sigma_n, &sigma0, &contrast, &edge, &norm, &factor, &PyBobSpExtrapolationBorder_Converter, &border, &PyBool_Type, &single)){
     SIFT_doc.print_usage();
     return -1;
   }
-  self->cxx.reset(new bob::ip::base::SIFT(size[0], size[1], scales, octaves, octave_min, sigma_n, sigma0, contrast, edge, norm, factor, border));
+  self->cxx.reset(new bob::ip::base::SIFT(size[0], size[1], scales, octaves, octave_min, sigma_n, sigma0, contrast, edge, norm, factor, border, f(single)));
   return 0;
 
   BOB_CATCH_MEMBER("cannot create SIFT", -1)
@@ -438,6 +442,30 @@ int PyBobIpBaseSIFT_setNormEpsilon(PyBobIpBaseSIFTObject* self, PyObject* value,
   BOB_CATCH_MEMBER("norm_epsilon could not be set", -1)
 }
 
+static auto singlePrecision = bob::extension::VariableDoc(
+  "single_precision",
+  "bool",
+  "Whether the Gaussian, DoG and gradient pyramids are computed and stored in single (float32) precision, with read and write access",
+  "Single precision halves the memory of the pyramids, which is dominated by the first octave for ``octave_min=-1``. "
+  "The descriptors are still accumulated and returned in double precision, and they differ only slightly from the double precision descriptors."
+);
+PyObject* PyBobIpBaseSIFT_getSinglePrecision(PyBobIpBaseSIFTObject* self, void*){
+  BOB_TRY
+  if (self->cxx->getSinglePrecision()) Py_RETURN_TRUE; else Py_RETURN_FALSE;
+  BOB_CATCH_MEMBER("single_precision could not be read", 0)
+}
+int PyBobIpBaseSIFT_setSinglePrecision(PyBobIpBaseSIFTObject* self, PyObject* value, void*){
+  BOB_TRY
+  int r = PyObject_IsTrue(value);
+  if (r < 0){
+    PyErr_Format(PyExc_RuntimeError, "%s %s expects a bool", Py_TYPE(self)->tp_name, singlePrecision.name());
+    return -1;
+  }
+  self->cxx->setSinglePrecision(r>0);
+  return 0;
+  BOB_CATCH_MEMBER("single_precision could not be set", -1)
+}
+
 static PyGetSetDef PyBobIpBaseSIFT_getseters[] = {
     {
       size.name(),
@@ -558,6 +586,13 @@ static PyGetSetDef PyBobIpBaseSIFT_getseters[] = {
       normEpsilon.doc(),
       0
     },
+    {
+      singlePrecision.name(),
+      (getter)PyBobIpBaseSIFT_getSinglePrecision,
+      (setter)PyBobIpBaseSIFT_setSinglePrecision,
+      singlePrecision.doc(),
+      0
+    },
     {0}  /* Sentinel */
 };
 
@@ -616,20 +651,36 @@ static PyObject* PyBobIpBaseSIFT_outputShape(PyBobIpBaseSIFTObject* self, PyObje
 static auto computeDescriptor = bob::extension::FunctionDoc(
   "compute_descriptor",
   "Computes SIFT descriptor for a 2D/grayscale image, at the given keypoints",
-  "If given, the results are put in the output ``dst``, which output should be of type float and allocated in the shape :py:func:`output_shape` method).\n\n"
+  "If given, the results are put in the output ``dst``, which output should be of type float and allocated in the shape :py:func:`output_shape` method). "
+  "The keypoints are distributed over the given number of threads, which run without holding the global interpreter lock. "
+  "Since the pyramids of the image are cached in this object, concurrent calls of the same object (e.g., from several Python threads) are processed one after the other; use one object per thread to compute them in parallel.\n\n"
   ".. note::\n\n  The `__call__` function is an alias for this method.",
   true
 )
-.add_prototype("src, keypoints, [dst]", "dst")
+.add_prototype("src, keypoints, [dst], [threads]", "dst")
 .add_parameter("src", "array_like (2D)", "The input image which should be processed")
 .add_parameter("keypoints", "[:py:class:`bob.ip.base.GSSKeypoint`]", "The keypoints at which the descriptors should be computed")
 .add_parameter("dst", "[array_like (4D, float)]", "The descriptors that should have been allocated in size :py:func:`output_shape`")
+.add_parameter("threads", "int", "[default: 1] The number of threads to use; ``0`` uses one thread per CPU core")
 .add_return("dst", "[array_like (4D, float)]", "The resulting descriptors, if given it will be the same as the ``dst`` parameter")
 ;
 
 template <typename T>
-static PyObject* compute_inner(PyBobIpBaseSIFTObject* self, PyBlitzArrayObject* src, const std::vector<boost::shared_ptr<bob::ip::base::GSSKeypoint> >& keypoints, PyBlitzArrayObject* dst){
-  self->cxx->computeDescriptor(*PyBlitzArrayCxx_AsBlitz<T,2>(src), keypoints, *PyBlitzArrayCxx_AsBlitz<double,4>(dst));
+static PyObject* compute_inner(PyBobIpBaseSIFTObject* self, PyBlitzArrayObject* src, const std::vector<boost::shared_ptr<bob::ip::base::GSSKeypoint> >& keypoints, PyBlitzArrayObject* dst, const int threads){
+  // get the C++ arrays while holding the GIL
+  const blitz::Array<T,2> image = *PyBlitzArrayCxx_AsBlitz<T,2>(src);
+  blitz::Array<double,4> descriptors = *PyBlitzArrayCxx_AsBlitz<double,4>(dst);
+
+  // release the GIL while computing; exceptions are re-thrown after it has been re-acquired
+  std::exception_ptr error;
+  Py_BEGIN_ALLOW_THREADS
+  try {
+    self->cxx->computeDescriptor(image, keypoints, descriptors, threads);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  Py_END_ALLOW_THREADS
+  if (error) std::rethrow_exception(error);
   return PyBlitzArray_AsNumpyArray(dst,0);
 }
 
@@ -639,8 +690,9 @@ static PyObject* PyBobIpBaseSIFT_computeDescriptor(PyBobIpBaseSIFTObject* self,
 
   PyBlitzArrayObject* src, *dst = 0;
   PyObject* kp;
+  int threads = 1;
 
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&O!|O&", kwlist, &PyBlitzArray_Converter, &src, &PyList_Type, &kp, &PyBlitzArray_OutputConverter, &dst)) return 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&O!|O&i", kwlist, &PyBlitzArray_Converter, &src, &PyList_Type, &kp, &PyBlitzArray_OutputConverter, &dst, &threads)) return 0;
 
   auto src_ = make_safe(src), dst_ = make_xsafe(dst);
 
@@ -657,6 +709,7 @@ static PyObject* PyBobIpBaseSIFT_computeDescriptor(PyBobIpBaseSIFTObject* self,
     PyObject* o = PyList_GET_ITEM(kp, i);
     if (!PyBobIpBaseGSSKeypoint_Check(o)){
       PyErr_Format(PyExc_TypeError, "`%s' keypoints must be of type bob.ip.base.GSSKeypoint, but list item %d is not", Py_TYPE(self)->tp_name, (int)i);
+      return 0;
     }
     keypoints[i] = reinterpret_cast<PyBobIpBaseGSSKeypointObject*>(o)->cxx;
   }
@@ -681,9 +734,9 @@ static PyObject* PyBobIpBaseSIFT_computeDescriptor(PyBobIpBaseSIFTObject* self,
 
   // finally, extract the features
   switch (src->type_num){
-    case NPY_UINT8:   return compute_inner<uint8_t>(self, src, keypoints, dst);
-    case NPY_UINT16:  return compute_inner<uint16_t>(self, src, keypoints, dst);
-    case NPY_FLOAT64: return compute_inner<double>(self, src, keypoints, dst);
+    case NPY_UINT8:   return compute_inner<uint8_t>(self, src, keypoints, dst, threads);
+    case NPY_UINT16:  return compute_inner<uint16_t>(self, src, keypoints, dst, threads);
+    case NPY_FLOAT64: return compute_inner<double>(self, src, keypoints, dst, threads);
     default:
       PyErr_Format(PyExc_TypeError, "`%s' processes only images of types uint8, uint16 or float, and not %s", Py_TYPE(self)->tp_name, PyBlitzArray_TypenumAsString(src->type_num));
       return 0;
@@ -98,6 +98,71 @@ def test_extrapolate_mask():
   assert numpy.allclose(i, [s2_5_1,s2_5_1,s2_5_1])
 
 
+def _extrapolate_mask_reference(mask, image):
+  # straightforward port of the original column-then-row extrapolation, applied per plane
+  if image.ndim == 3:
+    return numpy.array([_extrapolate_mask_reference(mask, plane) for plane in image])
+  result = image.copy()
+  columns = numpy.flatnonzero(mask.any(axis=0))
+  assert len(columns)
+  for x in range(columns[0], columns[-1]+1):
+    rows = numpy.flatnonzero(mask[:,x])
+    result[:rows[0],x] = result[rows[0],x]
+    result[rows[-1]+1:,x] = result[rows[-1],x]
+  for x in range(columns[0]):
+    result[:,x] = result[:,columns[0]]
+  for x in range(columns[-1]+1, result.shape[1]):
+    result[:,x] = result[:,columns[-1]]
+  return result
+
+def _irregular_masks(shape):
+  # non-convex and multi-component masks; each column between the first and the last masked one contains a masked pixel
+  mask = numpy.zeros(shape, dtype = bool)
+  cross = mask.copy()
+  cross[10:20, 3:37] = True
+  cross[2:28, 15:25] = True
+  # a cross with a separate island and a hole
+  components = cross.copy()
+  components[5:8, 18:22] = False
+  components[25:28, 33:38] = True
+  # two separated blobs connected only by a thin diagonal line
+  blobs = mask.copy()
+  blobs[3:9, 5:12] = True
+  blobs[18:27, 26:34] = True
+  for i in range(15):
+    blobs[8+i, 11+i:14+i] = True
+  # a randomly frayed ellipse with a few random specks around it
+  y, x = numpy.mgrid[0:shape[0], 0:shape[1]]
+  numpy.random.seed(42)
+  ellipse = ((y - 15.)/11.)**2 + ((x - 20.)/16.)**2 < 1.
+  frayed = (ellipse & (numpy.random.rand(*shape) > 0.2)) | (numpy.random.rand(*shape) > 0.98)
+  frayed[13:18, 17:23] = True
+  frayed[15] = True
+  return [cross, components, blobs, frayed]
+
+def test_extrapolate_mask_irregular():
+  numpy.random.seed(7)
+  image = numpy.random.randint(0, 256, (30,40)).astype(numpy.uint8)
+  color = numpy.array([image, image[::-1], 255 - image])
+  for mask in _irregular_masks(image.shape):
+    # gray image
+    result = image.copy()
+    bob.ip.base.extrapolate_mask(mask, result)
+    assert numpy.array_equal(result, _extrapolate_mask_reference(mask, image))
+    assert numpy.array_equal(result[mask], image[mask])
+    # floating point gray image
+    result = image.astype(numpy.float64)
+    bob.ip.base.extrapolate_mask(mask, result)
+    assert numpy.array_equal(result, _extrapolate_mask_reference(mask, image.astype(numpy.float64)))
+    # color image with differing planes
+    result = color.copy()
+    bob.ip.base.extrapolate_mask(mask, result)
+    assert numpy.array_equal(result, _extrapolate_mask_reference(mask, color))
+
+  # a mask without any masked pixel cannot be extrapolated
+  nose.tools.assert_raises(RuntimeError, bob.ip.base.extrapolate_mask, numpy.zeros(image.shape, dtype = bool), image.copy())
+
+
 ###############################################
 #### random image extrapolation with mask #####
 ###############################################
@@ -138,6 +203,101 @@ def test_extrapolate_random():
   bob.ip.base.extrapolate_mask(fill_src_mask, color_image, random_sigma = 0.05, neighbors = 1, rng = bob.core.random.mt19937(42))
 
   assert numpy.allclose(image, [fill_ref_image]*3)
+  # all planes are filled identically, and the masked area is not touched
+  assert numpy.allclose(color_image, [image]*3)
+
+
+def _extrapolate_random_plan(mask, neighbors):
+  # port of the original spiral walk of the random extrapolation;
+  # returns the filled positions in fill order, each with the positions the random choice is made from
+  height, width = mask.shape
+  ys, xs = numpy.nonzero(mask)
+  center = ((ys.min() + ys.max()) // 2, (xs.min() + xs.max()) // 2)
+  assert mask[center]
+  filled = mask.copy()
+  directions = [(0,1), (1,0), (0,-1), (-1,0)]
+  border = [width, height, 1, 1]
+  at_border = [False]*4
+  maxima = [(center[0] + d[0], center[1] + d[1]) for d in directions]
+  index = 0
+  y, x = center
+  plan = []
+  while not all(at_border):
+    dy, dx = directions[index]
+    if y*dy + x*dx >= maxima[index][0]*dy + maxima[index][1]*dx:
+      maxima[index] = (maxima[index][0] + dy, maxima[index][1] + dx)
+      if y*dy + x*dx >= border[index]:
+        at_border[index] = True
+      index = (index + 1) % 4
+      dy, dx = directions[index]
+    if 0 <= y < height and 0 <= x < width and not mask[y,x]:
+      next = (index + 1) % 4
+      ny, nx = directions[next]
+      vy, vx = y + ny, x + nx
+      while vy*ny + vx*nx < border[next] and not filled[vy,vx]:
+        vy, vx = vy + ny, vx + nx
+      # when the walk leaves the image, the pixel is not filled at all
+      if vy*ny + vx*nx < border[next]:
+        if neighbors < 1:
+          candidates = [(vy,vx)]
+        else:
+          candidates = [(vy + c*dy, vx + c*dx) for c in range(-neighbors, neighbors+1) if 0 <= vy + c*dy < height and 0 <= vx + c*dx < width and filled[vy + c*dy, vx + c*dx]]
+        plan.append(((y,x), candidates))
+        filled[y,x] = True
+    y, x = y + dy, x + dx
+  return plan
+
+def test_extrapolate_random_irregular():
+  numpy.random.seed(11)
+  image = numpy.random.randint(1, 256, (30,40)).astype(numpy.float64)
+  color = numpy.array([image, 2.*image, image + 1.])
+  for mask in _irregular_masks(image.shape):
+    # without neighbors and randomness, the result is the plain spiral fill
+    plan = _extrapolate_random_plan(mask, 0)
+    reference = image.copy()
+    for position, candidates in plan:
+      reference[position] = reference[candidates[0]]
+    result = image.copy()
+    bob.ip.base.extrapolate_mask(mask, result, random_sigma = 0., neighbors = 0)
+    assert numpy.array_equal(result, reference)
+    result = color.copy()
+    bob.ip.base.extrapolate_mask(mask, result, random_sigma = 0., neighbors = 0)
+    assert numpy.array_equal(result, [reference, 2.*reference, reference + 1.])
+
+    # with a fixed seed, each pixel is copied from one of the neighbors that the spiral offers
+    plan = _extrapolate_random_plan(mask, 3)
+    filled = numpy.zeros(mask.shape, dtype = bool)
+    result = image.copy()
+    bob.ip.base.extrapolate_mask(mask, result, random_sigma = 0., neighbors = 3, rng = bob.core.random.mt19937(42))
+    for position, candidates in plan:
+      filled[position] = True
+      if candidates:
+        assert any(result[position] == result[c] for c in candidates)
+      else:
+        assert result[position] == image[position]
+    # pixels that are neither masked nor reached by the spiral are left untouched
+    assert numpy.array_equal(result[~filled], image[~filled])
+    # the same seed selects the same neighbors, for all planes of a color image
+    again = image.copy()
+    bob.ip.base.extrapolate_mask(mask, again, random_sigma = 0., neighbors = 3, rng = bob.core.random.mt19937(42))
+    assert numpy.array_equal(again, result)
+    result3 = color.copy()
+    bob.ip.base.extrapolate_mask(mask, result3, random_sigma = 0., neighbors = 3, rng = bob.core.random.mt19937(42))
+    assert numpy.array_equal(result3, [result, 2.*result, result + 1.])
+
+    # with random factors, a color pixel shares one factor across its planes and is drawn in the same order as for a gray image
+    result = image.copy()
+    bob.ip.base.extrapolate_mask(mask, result, random_sigma = 0.05, neighbors = 3, rng = bob.core.random.mt19937(42))
+    assert numpy.array_equal(result[mask], image[mask])
+    assert numpy.array_equal(result[~filled], image[~filled])
+    result3 = color.copy()
+    bob.ip.base.extrapolate_mask(mask, result3, random_sigma = 0.05, neighbors = 3, rng = bob.core.random.mt19937(42))
+    assert numpy.allclose(result3[0], result)
+    assert numpy.allclose(result3[1], 2.*result)
+    for position, candidates in plan:
+      if candidates:
+        # the chosen neighbor is scaled by the same factor in all planes
+        assert any(0.5 < result[position] / result[c] < 1.5 and numpy.isclose(result3[2][position] * result3[0][c], result3[0][position] * result3[2][c]) for c in candidates)
 
 
 ###############################################
@@ -199,6 +359,92 @@ def test_scale_factor():
     assert numpy.allclose(scaled_3by8by8[i], scaled_ref_8by8, atol=1e-7)
 
 
+def test_scale_separable():
+  # scaling without rotation uses a separable implementation; compare it with the general transform of GeomNorm
+  numpy.random.seed(42)
+  image = numpy.random.randint(0, 255, (40, 40)).astype(numpy.uint8)
+  for size in (93, 17, 40):
+    factor = (size - 1.) / 39.
+    geom_norm = bob.ip.base.GeomNorm(0., factor, (size, size), (0, 0))
+    reference = numpy.ndarray((size, size))
+    geom_norm(image, reference, (0, 0))
+    scaled = numpy.ndarray((size, size))
+    bob.ip.base.scale(image, scaled)
+    assert numpy.allclose(scaled, reference, rtol=0., atol=1e-8)
+
+    # color images given as non-contiguous arrays
+    color = numpy.array([image, image.T, image[::-1]])[:, ::-1, :]
+    scaled = numpy.ndarray((3, size, size))
+    bob.ip.base.scale(color, scaled)
+    for i in range(3):
+      geom_norm(color[i].copy(), reference, (0, 0))
+      assert numpy.allclose(scaled[i], reference, rtol=0., atol=1e-8)
+
+
+def test_scale_area():
+  # area downscaling by integral factors averages non-overlapping blocks
+  numpy.random.seed(42)
+  image = numpy.random.randint(0, 255, (60, 90)).astype(numpy.uint8)
+  blocks = image.reshape(20, 3, 30, 3).mean(axis=(1,3))
+  scaled = bob.ip.base.scale(image, 1./3., interpolation='area')
+  assert scaled.shape == (20, 30)
+  assert numpy.allclose(scaled, blocks, rtol=0., atol=1e-8)
+
+  # color images and masks
+  color = numpy.array([image, image[::-1], 255 - image])
+  scaled = numpy.ndarray((3, 20, 30))
+  bob.ip.base.scale(color, scaled, 'area')
+  assert numpy.allclose(scaled[0], blocks, rtol=0., atol=1e-8)
+  assert numpy.allclose(scaled[2], 255 - blocks, rtol=0., atol=1e-8)
+  mask = numpy.ones(image.shape, numpy.bool)
+  mask[4,5] = False
+  scaled_mask = numpy.ndarray((20, 30), numpy.bool)
+  scaled = numpy.ndarray((20, 30))
+  bob.ip.base.scale(image, mask, scaled, scaled_mask, 'area')
+  assert numpy.allclose(scaled, blocks, rtol=0., atol=1e-8)
+  assert not scaled_mask[1,1] and numpy.count_nonzero(scaled_mask) == 20*30-1
+
+  # GeomNorm without rotation integrates the same footprints; with rotation, constant images are preserved
+  geom_norm = bob.ip.base.GeomNorm(0., 1./3., (20, 30), (0, 0), 'area')
+  assert geom_norm.interpolation == 'area'
+  normalized = numpy.ndarray((20, 30))
+  geom_norm(image, normalized, (1, 1))
+  assert numpy.allclose(normalized, blocks, rtol=0., atol=1e-8)
+  geom_norm.rotation_angle = 30.
+  constant = numpy.ones(image.shape) * 42.
+  normalized_mask = numpy.ndarray((20, 30), numpy.bool)
+  geom_norm(constant, numpy.ones(image.shape, numpy.bool), normalized, normalized_mask, (30, 45))
+  assert numpy.count_nonzero(normalized_mask)
+  assert numpy.allclose(normalized[normalized_mask], 42.)
+
+  geom_norm.interpolation = 'bilinear'
+  assert geom_norm.interpolation == 'bilinear'
+  nose.tools.assert_raises(RuntimeError, bob.ip.base.scale, image, 0.5, 'cubic')
+
+
+def test_scale_area_border():
+  # the footprints of the border pixels stick out of the source image; they must not darken the border of constant images
+  constant = numpy.ones((60, 60)) * 42.
+  for size in ((20, 20), (7, 11), (13, 60)):
+    scaled = numpy.ndarray(size)
+    bob.ip.base.scale(constant, scaled, 'area')
+    assert numpy.allclose(scaled, 42., rtol=0., atol=1e-10)
+
+  # GeomNorm without rotation maps the corners of source and target image onto each other
+  geom_norm = bob.ip.base.GeomNorm(0., 19./59., (20, 20), (0, 0), 'area')
+  normalized = numpy.ndarray((20, 20))
+  normalized_mask = numpy.ndarray((20, 20), numpy.bool)
+  geom_norm(constant, normalized, (0, 0))
+  assert numpy.allclose(normalized, 42., rtol=0., atol=1e-10)
+  geom_norm(constant, numpy.ones(constant.shape, numpy.bool), normalized, normalized_mask, (0, 0))
+  assert numpy.allclose(normalized, 42., rtol=0., atol=1e-10)
+  assert numpy.all(normalized_mask)
+
+  # target pixels centered outside of the source image are still masked
+  geom_norm(constant, numpy.ones(constant.shape, numpy.bool), normalized, normalized_mask, (-10, 0))
+  assert not numpy.any(normalized_mask[:3]) and numpy.all(normalized_mask[4:])
+  assert numpy.allclose(normalized[4:], 42., rtol=0., atol=1e-10)
+
 def test_scaled_output_shape():
   shape_2by2 = bob.ip.base.scaled_output_shape(scale_src, 0.5)
   assert shape_2by2 == (2,2)
@@ -251,6 +497,119 @@ def test_rotate_mask():
   raise SkipTest("This functionality is (yet) untested")
 
 
+def test_rotate_interior_border():
+  # the interior of the rotated image is computed by a different code path than the border pixels;
+  # using a full mask must not change any pixel value
+  image = bob.io.base.load(bob.io.base.test_utils.datafile("image.hdf5", "bob.ip.base"))
+  image_mask = numpy.ones(image.shape, numpy.bool)
+
+  for angle in (0., 15., 45., 90., 123.):
+    shape = bob.ip.base.rotated_output_shape(image, angle)
+    rotated = numpy.ndarray(shape)
+    rotated_masked = numpy.ndarray(shape)
+    rotated_mask = numpy.ndarray(shape, numpy.bool)
+    bob.ip.base.rotate(image, rotated, angle)
+    bob.ip.base.rotate(image, image_mask, rotated_masked, rotated_mask, angle)
+    assert numpy.allclose(rotated, rotated_masked)
+    # the center of the rotated image needs to be valid
+    assert rotated_mask[shape[0]//2, shape[1]//2]
+
+
+def _bilinear_reference(image, angle, scale, crop_size, crop_offset, center):
+  # the source positions and weights of the scalar implementation, for all target pixels whose footprint is inside the image
+  sin_angle, cos_angle = -math.sin(angle * math.pi / 180.), math.cos(angle * math.pi / 180.)
+  col_dy, col_dx = -sin_angle / scale, cos_angle / scale
+  row_dy, row_dx = cos_angle / scale, sin_angle / scale
+  origin_y = center[0] - (crop_offset[0] * cos_angle - crop_offset[1] * sin_angle) / scale
+  origin_x = center[1] - (crop_offset[1] * cos_angle + crop_offset[0] * sin_angle) / scale
+  reference = numpy.ndarray(image.shape[:-2] + crop_size)
+  inside = numpy.zeros(crop_size, numpy.bool)
+  for y in range(crop_size[0]):
+    source_y, source_x = origin_y, origin_x
+    for x in range(crop_size[1]):
+      if 0. <= source_y < image.shape[-2] - 1 and 0. <= source_x < image.shape[-1] - 1:
+        oy, ox = int(math.floor(source_y)), int(math.floor(source_x))
+        my, mx = source_y - oy, source_x - ox
+        w00, w01, w10, w11 = (1.-mx) * (1.-my), mx * (1.-my), (1.-mx) * my, mx * my
+        reference[..., y, x] = w00 * image[..., oy, ox] + w01 * image[..., oy, ox+1] + w10 * image[..., oy+1, ox] + w11 * image[..., oy+1, ox+1]
+        inside[y, x] = True
+      source_y += col_dy
+      source_x += col_dx
+    origin_y += row_dy
+    origin_x += row_dx
+  return reference, inside
+
+
+def test_interpolate_span():
+  # the interior pixels are interpolated by a branch-free kernel, which is vectorized when built with BOB_IP_BASE_AVX2=1;
+  # it must give the same results as the scalar implementation, also for row lengths that are not a multiple of the vector size
+  random = numpy.random.RandomState(17)
+  image = random.rand(3, 41, 53) * 255.
+  for angle, scale, crop_size in ((0., 1., (37, 45)), (17., 0.8, (33, 29)), (-63., 1.7, (61, 43)), (90., 1., (35, 35))):
+    offset = (crop_size[0] / 2., crop_size[1] / 2.)
+    geom_norm = bob.ip.base.GeomNorm(angle, scale, crop_size, offset)
+    reference, inside = _bilinear_reference(image, angle, scale, crop_size, offset, (20.3, 26.6))
+    assert numpy.count_nonzero(inside) > crop_size[0] * crop_size[1] // 3
+
+    # gray and color images, with and without mask
+    normalized = numpy.ndarray(crop_size)
+    geom_norm(image[0], normalized, (20.3, 26.6))
+    assert numpy.allclose(normalized[inside], reference[0][inside], rtol=0., atol=1e-10)
+    normalized = numpy.ndarray((3,) + crop_size)
+    geom_norm(image, normalized, (20.3, 26.6))
+    for p in range(3):
+      assert numpy.allclose(normalized[p][inside], reference[p][inside], rtol=0., atol=1e-10)
+    # a hole in the mask splits the interior spans of the rows
+    mask = numpy.ones(image.shape[1:], numpy.bool)
+    mask[20, 26] = False
+    normalized_mask = numpy.ndarray(crop_size, numpy.bool)
+    geom_norm(image[0], mask, normalized, normalized_mask, (20.3, 26.6))
+    assert numpy.count_nonzero(inside & ~normalized_mask)
+    assert numpy.allclose(normalized[inside & normalized_mask], reference[0][inside & normalized_mask], rtol=0., atol=1e-10)
+
+
+def test_rotate_tiled():
+  # traversing the rotated image in tiles must give exactly the same results as the row by row traversal
+  numpy.random.seed(42)
+  image = numpy.random.random((150, 200)) * 255.
+  mask = numpy.random.random(image.shape) > 0.1
+  color = numpy.array([image, image[::-1], 255. - image])
+  for angle in (15., 45.):
+    rows = bob.ip.base.rotate(image, angle)
+    assert rows.shape[0] > 64 and rows.shape[1] > 64
+    for tile_size in (64, 17):
+      tiles = bob.ip.base.rotate(image, angle, tile_size)
+      assert numpy.array_equal(tiles, rows)
+
+      rows_mask, tiles_mask = numpy.ndarray(rows.shape, numpy.bool), numpy.ndarray(rows.shape, numpy.bool)
+      tiles = numpy.ndarray(rows.shape)
+      bob.ip.base.rotate(image, mask, rows, rows_mask, angle)
+      bob.ip.base.rotate(image, mask, tiles, tiles_mask, angle, tile_size = tile_size)
+      assert numpy.array_equal(tiles, rows)
+      assert numpy.array_equal(tiles_mask, rows_mask)
+
+      color_rows, color_tiles = numpy.ndarray((3,) + rows.shape), numpy.ndarray((3,) + rows.shape)
+      bob.ip.base.rotate(color, color_rows, angle)
+      bob.ip.base.rotate(color, color_tiles, angle, tile_size)
+      assert numpy.array_equal(color_tiles, color_rows)
+
+
+def test_shared_mask_shape():
+  # 2D masks shared by all color planes need to have the shape of the planes
+  color = numpy.ones((3, 20, 30))
+  src_mask = numpy.ones((20, 30), numpy.bool)
+  dst = numpy.ndarray((3, 10, 15))
+  dst_mask = numpy.ndarray((10, 15), numpy.bool)
+  bob.ip.base.scale(color, src_mask, dst, dst_mask)
+  bob.ip.base.rotate(color, src_mask, dst, dst_mask, 15.)
+
+  nose.tools.assert_raises(ValueError, bob.ip.base.scale, color, src_mask[:10], dst, dst_mask)
+  nose.tools.assert_raises(ValueError, bob.ip.base.scale, color, src_mask[:, :29], dst, dst_mask, 'area')
+  nose.tools.assert_raises(ValueError, bob.ip.base.scale, color, src_mask, dst, dst_mask[:, :5])
+  nose.tools.assert_raises(ValueError, bob.ip.base.rotate, color, src_mask[:10], dst, dst_mask, 15.)
+  nose.tools.assert_raises(ValueError, bob.ip.base.rotate, color, src_mask, dst, dst_mask[:, :5], 15.)
+
+
 ###############################################
 ########## GeomNorm ###########################
 ###############################################
@@ -367,6 +726,73 @@ def test_geom_norm_color():
 
 
 
+def test_geom_norm_color_mask():
+  # tests that color images with a shared 2D mask give the same results as each plane on its own
+  test_image = bob.io.base.load(bob.io.base.test_utils.datafile("image_r70.hdf5", "bob.ip.base", "data/affine"))
+  test_mask = test_image != 0
+  color_image = numpy.array([test_image, test_image // 2, test_image // 3])
+
+  geom_norm = bob.ip.base.GeomNorm(-70., 1.2, (160, 160), (80, 80))
+
+  processed = numpy.ndarray((3, 160, 160))
+  processed_mask = numpy.ndarray((160, 160), numpy.bool)
+  geom_norm(color_image, test_mask, processed, processed_mask, (64, 69))
+
+  plane = numpy.ndarray((160, 160))
+  plane_mask = numpy.ndarray((160, 160), numpy.bool)
+  for i in range(3):
+    geom_norm(color_image[i], test_mask, plane, plane_mask, (64, 69))
+    assert numpy.allclose(processed[i], plane)
+    assert numpy.all(processed_mask == plane_mask)
+
+  # the same with 3D masks
+  color_mask = numpy.array([test_mask]*3)
+  processed_mask_3 = numpy.ndarray((3, 160, 160), numpy.bool)
+  geom_norm(color_image, color_mask, processed, processed_mask_3, (64, 69))
+  for i in range(3):
+    assert numpy.all(processed_mask_3[i] == processed_mask)
+
+
+def test_output_types():
+  # tests that float32 and uint8 outputs are identical to the converted float64 output
+  test_image = bob.io.base.load(bob.io.base.test_utils.datafile("image_r70.hdf5", "bob.ip.base", "data/affine"))
+  test_mask = test_image != 0
+  def _uint8(image):
+    return numpy.clip(numpy.floor(image + .5), 0, 255).astype(numpy.uint8)
+
+  # rotation
+  reference = bob.ip.base.rotate(test_image, 33.)
+  for dtype in (numpy.float32, numpy.uint8):
+    rotated = numpy.ndarray(reference.shape, dtype)
+    bob.ip.base.rotate(test_image, rotated, 33.)
+    assert numpy.allclose(rotated, reference.astype(numpy.float32) if dtype == numpy.float32 else _uint8(reference))
+
+  # scaling, with values beyond the uint8 range
+  image = test_image * 3. - 100.
+  reference = bob.ip.base.scale(image, 0.7)
+  scaled = numpy.ndarray(reference.shape, numpy.uint8)
+  bob.ip.base.scale(image, scaled)
+  assert numpy.all(scaled == _uint8(reference))
+
+  # geometric normalization with masks
+  geom_norm = bob.ip.base.GeomNorm(-70., 1.2, (160, 160), (80, 80))
+  reference = numpy.ndarray((160, 160))
+  reference_mask = numpy.ndarray((160, 160), numpy.bool)
+  geom_norm(test_image, test_mask, reference, reference_mask, (64, 69))
+  processed = numpy.ndarray((160, 160), numpy.uint8)
+  processed_mask = numpy.ndarray((160, 160), numpy.bool)
+  geom_norm(test_image, test_mask, processed, processed_mask, (64, 69))
+  assert numpy.all(processed == _uint8(reference))
+  assert numpy.all(processed_mask == reference_mask)
+
+  # face eyes normalization
+  fen = bob.ip.base.FaceEyesNorm((40, 40), 20, (5/19.*40, 20))
+  reference = fen(test_image, (67, 47), (62, 71))
+  processed = numpy.ndarray((40, 40), numpy.float32)
+  fen(test_image, processed, (67, 47), (62, 71))
+  assert numpy.allclose(processed, reference.astype(numpy.float32))
+
+
 ###############################################
 ########## FaceEyesNorm #######################
 ###############################################
@@ -419,3 +845,74 @@ def test_face_eyes_norm():
   processed = fen(test_image, right_eye, left_eye)
   normalized = numpy.round(processed).astype(numpy.uint8)
   assert numpy.allclose(normalized, reference_image)
+
+
+def test_face_eyes_norm_batch():
+  # load test image
+  test_image = bob.io.base.load(bob.io.base.test_utils.datafile("image_r10.hdf5", "bob.ip.base", "data/affine"))
+  fen = bob.ip.base.FaceEyesNorm((40, 40), 20, (5/19.*40, 20))
+
+  # several eye positions in the same image
+  eyes = numpy.array([(67, 47, 62, 71), (66, 48, 63, 70), (60, 40, 60, 70), (70, 50, 58, 72)], numpy.float64)
+  reference = numpy.array([fen(test_image, tuple(e[:2]), tuple(e[2:])) for e in eyes])
+
+  images = numpy.array([test_image] * len(eyes))
+  for threads in (1, 0, 3):
+    # as a stack
+    processed = fen.extract_batch(images, eyes, threads=threads)
+    assert processed.shape == (len(eyes), 40, 40)
+    assert numpy.allclose(processed, reference)
+    # as a list, with a given output
+    processed = numpy.ndarray((len(eyes), 40, 40))
+    fen.extract_batch(list(images), eyes, processed, threads)
+    assert numpy.allclose(processed, reference)
+
+  # the eye positions must match the number of images
+  nose.tools.assert_raises(RuntimeError, fen.extract_batch, images, eyes[:2])
+
+
+###############################################
+########## WarpMap ############################
+###############################################
+
+def test_warp_map():
+  test_image = bob.io.base.load(bob.io.base.test_utils.datafile("image_r70.hdf5", "bob.ip.base", "data/affine"))
+  test_mask = test_image != 0
+  # the fixed-point weights limit the precision
+  tolerance = 255. / 2**15
+
+  # warp map of a GeomNorm
+  geom_norm = bob.ip.base.GeomNorm(-70., 1.2, (160, 160), (80, 80))
+  warp_map = bob.ip.base.WarpMap(geom_norm, test_image.shape, (64, 69))
+  assert warp_map.source_shape == test_image.shape
+  assert warp_map.target_shape == (160, 160)
+
+  processed = numpy.ndarray((160, 160))
+  geom_norm(test_image, processed, (64, 69))
+  assert numpy.allclose(warp_map(test_image), processed, rtol=0., atol=tolerance)
+
+  # with masks
+  processed_mask = numpy.ndarray((160, 160), numpy.bool)
+  geom_norm(test_image, test_mask, processed, processed_mask, (64, 69))
+  remapped = numpy.ndarray((160, 160))
+  remapped_mask = numpy.ndarray((160, 160), numpy.bool)
+  warp_map(test_image, test_mask, remapped, remapped_mask)
+  assert numpy.allclose(remapped, processed, rtol=0., atol=tolerance)
+  assert numpy.all(remapped_mask == processed_mask)
+
+  # a stack of frames is remapped with the same map
+  frames = numpy.array([test_image, test_image // 2, test_image // 3])
+  remapped = warp_map(frames)
+  assert remapped.shape == (3, 160, 160)
+  for i in range(3):
+    geom_norm(frames[i], processed, (64, 69))
+    assert numpy.allclose(remapped[i], processed, rtol=0., atol=tolerance)
+
+  # warp map of a FaceEyesNorm
+  fen = bob.ip.base.FaceEyesNorm((40, 40), 20, (5/19.*40, 20))
+  right_eye, left_eye = (67, 47), (62, 71)
+  warp_map = bob.ip.base.WarpMap(fen, test_image.shape, right_eye, left_eye)
+  assert numpy.allclose(warp_map(test_image), fen(test_image, right_eye, left_eye), rtol=0., atol=tolerance)
+
+  # copy
+  assert bob.ip.base.WarpMap(warp_map) == warp_map
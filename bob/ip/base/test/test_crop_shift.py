@@ -9,6 +9,7 @@
 """
 
 import numpy
+import nose.tools
 import bob.ip.base
 
 A_org           = numpy.array(range(0,100), numpy.float64).reshape((10,10))
@@ -47,3 +48,78 @@ def test_shift_3D():
   assert (B == B3_shift_1x1).all()
   C = bob.ip.base.shift(B_org, (-1, -1))
   assert (C == B3_shift_1x1).all()
+
+def test_crop_view():
+  # crops inside the image are views
+  A = A_org.copy()
+  C = bob.ip.base.crop(A, (2, 2), (2, 2))
+  assert (C == A_crop_2x2_2x2).all()
+  C[0,0] = -1
+  assert A[2,2] == -1
+  C = bob.ip.base.crop(A3_org, (2, 2), (2, 2))
+  assert C.base is not None
+  assert (C == A3_crop_2x2_2x2).all()
+
+def test_crop_mask():
+  # crops outside of the image are filled with the fill_pattern, and the mask is False there
+  A = numpy.array(range(0,100), numpy.uint8).reshape((10,10))
+  A_mask = numpy.ones((10,10), numpy.bool_)
+  A_mask[9,9] = False
+  B = numpy.ndarray((3,3), numpy.uint8)
+  B_mask = numpy.ndarray((3,3), numpy.bool_)
+  bob.ip.base.crop(A, (8, 8), dst=B, src_mask=A_mask, dst_mask=B_mask, fill_pattern=255)
+  assert (B == [[88, 89, 255], [98, 99, 255], [255, 255, 255]]).all()
+  assert (B_mask == [[True, True, False], [True, False, False], [False, False, False]]).all()
+
+def test_crop_mask_arguments():
+  # both masks or none of them need to be given
+  A_mask = numpy.ones((10,10), numpy.bool_)
+  B = numpy.ndarray((3,3), numpy.float64)
+  B_mask = numpy.ndarray((3,3), numpy.bool_)
+  nose.tools.assert_raises(ValueError, bob.ip.base.crop, A_org, (8, 8), dst=B, src_mask=A_mask)
+  nose.tools.assert_raises(ValueError, bob.ip.base.shift, A_org, (8, 8), dst=B, dst_mask=B_mask)
+  # the source mask is only read, so it might be read-only
+  A_mask.flags.writeable = False
+  bob.ip.base.crop(A_org, (8, 8), dst=B, src_mask=A_mask, dst_mask=B_mask)
+  assert (B_mask == [[True, True, False], [True, True, False], [False, False, False]]).all()
+
+DTYPES = (numpy.bool_, numpy.int8, numpy.int16, numpy.int32, numpy.int64, numpy.uint8, numpy.uint16, numpy.uint32, numpy.uint64, numpy.float16, numpy.float32, numpy.float64, numpy.complex64, numpy.complex128)
+
+def _crop_reference(src, offset, size, fill_pattern):
+  dst = numpy.empty(src.shape[:-2] + size, src.dtype)
+  dst.fill(fill_pattern)
+  for y in range(size[0]):
+    for x in range(size[1]):
+      if 0 <= y + offset[0] < src.shape[-2] and 0 <= x + offset[1] < src.shape[-1]:
+        dst[...,y,x] = src[...,y + offset[0], x + offset[1]]
+  return dst
+
+def test_crop_dtypes():
+  # all numeric data types can be cropped and shifted, in 2D and 3D
+  for dtype in DTYPES:
+    for A in (A_org.astype(dtype), A3_org.astype(dtype)):
+      C = bob.ip.base.crop(A, (8, -1), (4, 3), fill_pattern=1)
+      assert C.dtype == dtype
+      assert (C == _crop_reference(A, (8, -1), (4, 3), 1)).all(), dtype
+      B = numpy.ndarray(A.shape, dtype)
+      bob.ip.base.shift(A, (-2, 3), B)
+      assert (B == _crop_reference(A, (-2, 3), A.shape[-2:], 0)).all(), dtype
+      # masks are cropped for all data types
+      A_mask = numpy.ones(A.shape, numpy.bool_)
+      B_mask = numpy.ndarray(A.shape, numpy.bool_)
+      bob.ip.base.shift(A, (-2, 3), B, A_mask, B_mask)
+      assert (B_mask == _crop_reference(A_mask, (-2, 3), A.shape[-2:], False)).all(), dtype
+
+def test_crop_fill_pattern():
+  # the fill_pattern is converted without loss of precision
+  A = numpy.zeros((2,2), numpy.int64)
+  assert bob.ip.base.crop(A, (0, 1), (2, 2), fill_pattern=2**62+1)[0,1] == 2**62+1
+  A = numpy.zeros((2,2), numpy.uint64)
+  assert bob.ip.base.crop(A, (0, 1), (2, 2), fill_pattern=2**64-1)[0,1] == 2**64-1
+  A = numpy.zeros((2,2), numpy.complex128)
+  assert bob.ip.base.crop(A, (0, 1), (2, 2), fill_pattern=1-2j)[0,1] == 1-2j
+  # values that cannot be represented in the data type of src raise a ValueError
+  for dtype, value in ((numpy.uint8, -1), (numpy.uint8, 256), (numpy.int8, 128), (numpy.uint16, 1e6), (numpy.int64, 2**63), (numpy.uint64, 2**64), (numpy.uint32, -1.5), (numpy.float32, 1e39)):
+    A = numpy.zeros((2,2), dtype)
+    nose.tools.assert_raises(ValueError, bob.ip.base.crop, A, (0, 1), (2, 2), fill_pattern=value)
+    nose.tools.assert_raises(ValueError, bob.ip.base.shift, A, (0, 1), fill_pattern=value)
@@ -29,6 +29,23 @@ def test_median():
   dst = bob.ip.base.median(src, (1,1))
   assert numpy.allclose(ref, dst)
 
+
+def _median_reference(src, radius):
+  windows = [src[y:y+2*radius[0]+1, x:x+2*radius[1]+1].flatten() for y in range(src.shape[0]-2*radius[0]) for x in range(src.shape[1]-2*radius[1])]
+  return numpy.array([numpy.sort(w)[len(w)//2] for w in windows], dtype=src.dtype).reshape(src.shape[0]-2*radius[0], src.shape[1]-2*radius[1])
+
+def test_median_histogram():
+  # the histogram-based implementations for uint8 and uint16 are identical to sorting
+  generator = numpy.random.RandomState(5)
+  for dtype, maximum in ((numpy.uint8, 256), (numpy.uint16, 65536), (numpy.float64, 1000)):
+    src = generator.randint(0, maximum, (25, 31)).astype(dtype)
+    for radius in ((1,1), (3,2), (0,5), (7,7)):
+      reference = _median_reference(src, radius)
+      assert numpy.array_equal(bob.ip.base.median(src, radius), reference)
+      assert numpy.array_equal(bob.ip.base.median(src, radius, threads=4), reference)
+  color = generator.randint(0, 256, (3, 20, 20)).astype(numpy.uint8)
+  assert numpy.array_equal(bob.ip.base.median(color, (2,2)), numpy.array([_median_reference(c, (2,2)) for c in color]))
+
 def test_sobel():
   src = numpy.array([
       [0, 1, 2],
@@ -53,4 +70,47 @@ def test_sobel():
 
   assert numpy.allclose(dst, ref)
 
+  # gradient magnitude and orientation computed in the same pass
+  magnitude = numpy.ndarray(src.shape)
+  orientation = numpy.ndarray(src.shape)
+  dst = bob.ip.base.sobel(src, magnitude = magnitude, orientation = orientation)
+  assert numpy.allclose(dst, ref)
+  assert numpy.allclose(magnitude, numpy.sqrt(ref[0]**2 + ref[1]**2))
+  assert numpy.allclose(orientation, numpy.arctan2(-ref[0], -ref[1]))
+
+  bob.ip.base.sobel(src, magnitude = magnitude, norm = 'l1')
+  assert numpy.allclose(magnitude, numpy.abs(ref[0]) + numpy.abs(ref[1]))
+
+
+def test_sobel_orientation():
+  # the orientation is the one of the image gradient, as in GradientMaps, which computes it as numpy.arctan2(*numpy.gradient(src))
+  y, x = numpy.mgrid[0:6, 0:7].astype(numpy.float64)
+  orientation = numpy.ndarray(y.shape)
+  for a, b in ((0, 1), (0, -1), (1, 0), (-1, 0), (3, -2), (-2, -5), (0, 0)):
+    ramp = a * y + b * x
+    bob.ip.base.sobel(ramp, orientation = orientation)
+    reference = numpy.arctan2(*numpy.gradient(ramp))
+    assert numpy.allclose(orientation[1:-1,1:-1], reference[1:-1,1:-1], rtol=0., atol=1e-12), (a, b)
+
+
+def _sobel_reference(src, mode):
+  # convolves the padded image with both Sobel kernels
+  kernels = (numpy.array([[-1, -2, -1], [0, 0, 0], [1, 2, 1]], numpy.float64), numpy.array([[-1, 0, 1], [-2, 0, 2], [-1, 0, 1]], numpy.float64))
+  padded = numpy.pad(src, 1, mode)
+  dst = numpy.zeros((2,) + src.shape)
+  for k in range(2):
+    for i in range(3):
+      for j in range(3):
+        dst[k] += kernels[k][2-i, 2-j] * padded[i:i+src.shape[0], j:j+src.shape[1]]
+  return dst
+
+
+def test_sobel_borders():
+  # the borders are handled as a convolution of the extrapolated image, including the Zero border
+  numpy.random.seed(42)
+  src = numpy.random.random((7, 9))
+  for border, mode in ((bob.sp.BorderType.Zero, 'constant'), (bob.sp.BorderType.NearestNeighbour, 'edge'), (bob.sp.BorderType.Circular, 'wrap'), (bob.sp.BorderType.Mirror, 'symmetric')):
+    dst = bob.ip.base.sobel(src, border)
+    assert numpy.allclose(dst, _sobel_reference(src, mode), rtol=0., atol=1e-12), border
+
 
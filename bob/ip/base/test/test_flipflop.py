@@ -45,3 +45,43 @@ def test_flop_3D():
   assert (B == A3_ans_flop).all()
   C = bob.ip.base.flop(A3_org)
   assert (C == A3_ans_flop).all()
+
+def test_flipflop_view():
+  # without dst, views are returned
+  A = A_org.copy()
+  C = bob.ip.base.flip(A)
+  assert (C == A_ans_flip).all()
+  C[0,0] = -1
+  assert A[1,0] == -1
+  C = bob.ip.base.flop(A3_org)
+  assert (C == A3_ans_flop).all()
+  # flipping in place
+  A = A3_org.copy()
+  bob.ip.base.flop(A, A)
+  assert (A == A3_ans_flop).all()
+
+def test_flipflop_overlap():
+  # src and dst might partially overlap in memory
+  A = numpy.array(range(24), numpy.float64).reshape((4,6))
+  reference = A[:3].copy()
+  bob.ip.base.flip(A[:3], A[1:])
+  assert (A[1:] == reference[::-1]).all()
+  A = numpy.array(range(24), numpy.float64).reshape((4,6))
+  reference = A[:,:5].copy()
+  bob.ip.base.flop(A[:,:5], A[:,1:])
+  assert (A[:,1:] == reference[:,::-1]).all()
+  # and have different strides
+  A = numpy.array(range(16), numpy.float64).reshape((4,4))
+  reference = A.T.copy()
+  bob.ip.base.flip(A.T, A)
+  assert (A == reference[::-1]).all()
+
+def test_flipflop_dtypes():
+  # all numeric data types can be flipped and flopped
+  for dtype in (numpy.bool_, numpy.int8, numpy.int16, numpy.int32, numpy.int64, numpy.uint8, numpy.uint16, numpy.uint32, numpy.uint64, numpy.float16, numpy.float32, numpy.float64, numpy.complex64, numpy.complex128):
+    for A in (A3_org.astype(dtype), numpy.array(range(12)).reshape((3,4)).astype(dtype)):
+      B = numpy.ndarray(A.shape, dtype)
+      bob.ip.base.flip(A, B)
+      assert (B == A[...,::-1,:]).all(), dtype
+      bob.ip.base.flop(A, B)
+      assert (B == A[...,::-1]).all(), dtype
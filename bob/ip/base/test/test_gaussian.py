@@ -54,6 +54,65 @@ def test_processing():
   assert numpy.allclose(a_out2, a_ref, eps, eps)
 
 
+def test_borders():
+  # compare all border types with a padded reference, also for kernels that are larger than the image
+  image = numpy.random.RandomState(42).rand(5, 7)
+  modes = {bob.sp.BorderType.Zero : 'constant', bob.sp.BorderType.NearestNeighbour : 'edge', bob.sp.BorderType.Circular : 'wrap', bob.sp.BorderType.Mirror : 'symmetric'}
+  for border, mode in modes.items():
+    for radius in ((1, 2), (6, 9)):
+      op = bob.ip.base.Gaussian((1.5, 2.), radius, border)
+      padded = numpy.pad(image, ((radius[0], radius[0]), (radius[1], radius[1])), mode)
+      ky, kx = op.kernel_y, op.kernel_x
+      rows = numpy.array([numpy.dot(ky, padded[y:y+len(ky)]) for y in range(image.shape[0])])
+      reference = numpy.array([[numpy.dot(kx, rows[y, x:x+len(kx)]) for x in range(image.shape[1])] for y in range(image.shape[0])])
+      assert numpy.allclose(op(image), reference)
+
+
+def test_iir():
+  # the recursive filter approximates the (non-truncated) Gaussian, independent of the radius
+  image = numpy.random.RandomState(42).rand(40, 50)
+  for border in (bob.sp.BorderType.Zero, bob.sp.BorderType.NearestNeighbour, bob.sp.BorderType.Circular, bob.sp.BorderType.Mirror):
+    fir = bob.ip.base.Gaussian((3., 5.), (15, 25), border)
+    iir = bob.ip.base.Gaussian((3., 5.), border=border, mode='iir')
+    nose.tools.eq_(fir.mode, 'fir')
+    nose.tools.eq_(iir.mode, 'iir')
+    assert fir != iir
+    assert numpy.max(numpy.abs(fir(image) - iir(image))) < 0.02
+    if border != bob.sp.BorderType.Zero:
+      # constant images are preserved
+      assert numpy.allclose(iir(numpy.ones((20, 30))), 1.)
+  iir.radius = fir.radius
+  iir.mode = 'fir'
+  assert iir == fir
+  nose.tools.assert_raises(RuntimeError, bob.ip.base.Gaussian, (3., 5.), mode='unknown')
+
+
+def test_in_place():
+  # the rows of dst are written while src is still read, so that src is copied when both are the same array
+  image = numpy.random.RandomState(5).rand(20, 30)
+  for mode in ('fir', 'iir'):
+    op = bob.ip.base.Gaussian((2., 3.), (4, 6), mode=mode)
+    reference = op(image)
+    in_place = image.copy()
+    op(in_place, in_place)
+    assert numpy.array_equal(in_place, reference)
+
+
+def test_workspaces():
+  # the buffers of the calling thread are reused for images of different sizes, which must not change any result
+  random = numpy.random.RandomState(3)
+  images = [random.rand(*shape) for shape in ((40, 50), (23, 31), (2, 3), (3, 23, 31))]
+  # uint8 images are converted in the workspace
+  images.append(random.randint(0, 256, (17, 60)).astype(numpy.uint8))
+  for mode in ('fir', 'iir'):
+    op = bob.ip.base.Gaussian((1.5, 2.), (4, 6), mode=mode)
+    first = [op(image) for image in images]
+    for image, reference in reversed(list(zip(images, first))):
+      assert numpy.array_equal(op(image), reference)
+    for plane, reference in zip(images[3], first[3]):
+      assert numpy.array_equal(op(plane), reference)
+
+
 def _normalize(image):
   a = numpy.min(image)
   b = numpy.max(image)
@@ -101,6 +101,17 @@ def test_processing():
       #base_dir = '/home/user'
       #bob.io.base.save(Bpyr.astype('uint8'), os.path.join(base_dir, 'pyr_o'+str(o)+'_s'+str(s+1)+'.pgm'))
 
+  # the multithreaded pyramid is identical, also when the threads cannot be split evenly between the octaves
+  for threads in (2, 3, 4, 0):
+    for octave, octave_threads in zip(pyr, op(A, threads=threads)):
+      assert numpy.array_equal(octave, octave_threads)
+
+  # the single precision pyramid is close to the double precision one
+  pyr32 = op(A, op.allocate_output(numpy.float32))
+  for octave, octave32 in zip(pyr, pyr32):
+    assert octave32.dtype == numpy.float32
+    assert numpy.allclose(octave, octave32, 1e-5, 1e-3)
+
 def test_comparison():
   # Comparisons tests
   op1 = bob.ip.base.GaussianScaleSpace((200,250),3,4,-1,0.5,1.6,4.)
@@ -58,6 +58,44 @@ def test_processing():
   a_out2 = op(a_float64)
   assert numpy.allclose(a_out2, a_sqi_ref, eps, eps)
 
+def test_scales():
+  # compare to the independent smoothing of all scales with Gaussians
+  image = numpy.random.RandomState(7).randint(0, 256, (40, 50)).astype(numpy.uint8)
+  op = bob.ip.base.MultiscaleRetinex(4,3,3,1.)
+  reference = numpy.zeros(image.shape)
+  for s in range(4):
+    size = 3 + 3*s
+    gaussian = bob.ip.base.Gaussian((size/3., size/3.), (size, size))
+    reference += numpy.log(image + 1.) - numpy.log(gaussian(image) + 1.)
+  reference /= 4.
+  assert numpy.allclose(op(image), reference)
+  # independent scales can be smoothed in parallel
+  assert numpy.allclose(op(image, threads=4), reference)
+
+  # the cascaded smoothing is close to the independent one, apart from the image borders
+  nose.tools.eq_(op.cascaded, False)
+  op.cascaded = True
+  nose.tools.eq_(op.cascaded, True)
+  assert op != bob.ip.base.MultiscaleRetinex(4,3,3,1.)
+  assert op == bob.ip.base.MultiscaleRetinex(4,3,3,1., cascaded=True)
+  cascaded = op(image)
+  assert numpy.max(numpy.abs(cascaded - reference)[12:-12,12:-12]) < 1e-2
+
+
+def test_workspaces():
+  # the scales are smoothed by threads that share the const Gaussian filters, each with its own workspace;
+  # workspaces are reused for images of changing sizes and must not change any result
+  random = numpy.random.RandomState(3)
+  images = [random.randint(0, 256, shape).astype(numpy.float64) for shape in ((40, 50), (23, 31), (40, 50), (3, 23, 31))]
+  op = bob.ip.base.MultiscaleRetinex(5,2,3,1.)
+  serial = [op(image) for image in images]
+  for repetition in range(2):
+    for image, reference in zip(images, serial):
+      assert numpy.array_equal(op(image, threads=5), reference)
+      assert numpy.array_equal(op(image, threads=2), reference)
+      assert numpy.array_equal(op(image), reference)
+
+
 def test_comparison():
 
   # Comparisons tests
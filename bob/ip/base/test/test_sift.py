@@ -9,7 +9,9 @@
 """
 
 import os
+import math
 import numpy
+import threading
 import nose.tools
 
 import bob.sp
@@ -66,6 +68,17 @@ def test_processing():
   #bob.io.base.save(C, datafile(os.path.join("sift","vlimg_ref_cmp.hdf5"), __name__)) # Generated using initial bob version
   C_ref = bob.io.base.load(datafile("vlimg_ref_cmp.hdf5", 'bob.ip.base', 'data/sift'))
   assert numpy.allclose(C, C_ref, 1e-5, 1e-5)
+
+  # single precision pyramids give (almost) the same descriptors
+  op.single_precision = True
+  assert op.single_precision
+  D = op.compute_descriptor(A,kp)
+  assert numpy.allclose(D[0], C_ref, 1e-4, 1e-4)
+
+  # the descriptors of several keypoints are identical when computed by several threads
+  kps = [bob.ip.base.GSSKeypoint(1.6 * 2.**(i/3.), (250+5*i, 200+5*i), 0.3*i) for i in range(12)]
+  E = op.compute_descriptor(A,kps)
+  assert numpy.array_equal(E, op.compute_descriptor(A,kps,threads=4))
   """
   Descriptor returned by vlfeat 0.9.14.
     Differences with our implementation are (but not limited to):
@@ -89,6 +102,126 @@ def test_processing():
    54.9029     2.88965   0.0166734  0.227938    18.4405    6.35371   3.85071  28.1302
   """
 
+def _descriptor_reference(op, pyramid, keypoint):
+  # Direct per-pixel evaluation of the SIFT descriptor, with explicit bounds checks on the bins;
+  # returns the descriptor and the number of pixels whose first orientation bin is bins (i.e., wraps around to 0)
+  Ns, No, omin = op.scales, op.octaves, op.octave_min
+  blocks, bins = op.blocks, op.bins
+  two_pi = 2. * math.pi
+
+  # octave and scale of the keypoint
+  phi = math.log(keypoint.sigma / op.sigma0) / math.log(2.)
+  o = min(max(int(math.floor(phi + 0.5 / Ns)), omin), omin + No - 1)
+  s = min(max(int(math.floor(Ns * (phi - o) + 0.5)) + 1, 1), Ns)
+
+  # gradient of the Gaussian at that scale
+  gy, gx = numpy.gradient(pyramid[o - omin][s])
+  magnitude = numpy.sqrt(gy**2 + gx**2)
+  orientation = numpy.arctan2(gy, gx)
+  H, W = magnitude.shape
+
+  factor = 2.**o
+  yc, xc = keypoint.location[0] / factor, keypoint.location[1] / factor
+  hist_width = op.magnif * keypoint.sigma / factor
+  radius = int(math.floor(math.sqrt(2) * hist_width * (blocks + 1) / 2. + 0.5))
+  window_factor = 0.5 / op.gaussian_window_size**2
+  bins_per_radian = bins / two_pi
+  kp_orientation = math.fmod(keypoint.orientation, two_pi)
+  if kp_orientation < 0.: kp_orientation += two_pi
+  cosk, sink = math.cos(keypoint.orientation), math.sin(keypoint.orientation)
+  yci, xci = int(math.floor(yc + 0.5)), int(math.floor(xc + 0.5))
+
+  descriptor = numpy.zeros((blocks, blocks, bins))
+  wraps = 0
+  for yi in range(max(yci - radius, 1), min(yci + radius, H - 2) + 1):
+    for xi in range(max(xci - radius, 1), min(xci + radius, W - 2) + 1):
+      theta = orientation[yi, xi] - kp_orientation
+      while theta < 0.: theta += two_pi
+      if theta >= two_pi: theta -= two_pi
+      dy, dx = (yi - yc) / hist_width, (xi - xc) / hist_width
+      ny, nx, no = cosk * dy - sink * dx, sink * dy + cosk * dx, theta * bins_per_radian
+      window = math.exp(-(dy * dy + dx * dx) * window_factor)
+      fy, fx, fo = int(math.floor(ny - 0.5)), int(math.floor(nx - 0.5)), int(math.floor(no))
+      ry, rx, ro = ny - (fy + 0.5), nx - (fx + 0.5), no - fo
+      wraps += fo == bins
+      for by, wy in ((fy, 1. - ry), (fy + 1, ry)):
+        by += blocks // 2
+        if not 0 <= by < blocks: continue
+        for bx, wx in ((fx, 1. - rx), (fx + 1, rx)):
+          bx += blocks // 2
+          if not 0 <= bx < blocks: continue
+          for bo, wo in ((fo, 1. - ro), (fo + 1, ro)):
+            descriptor[by, bx, bo % bins] += window * magnitude[yi, xi] * wy * wx * wo
+
+  descriptor /= numpy.sqrt(numpy.sum(descriptor**2)) + op.norm_epsilon
+  descriptor = numpy.minimum(descriptor, op.norm_threshold)
+  descriptor /= numpy.sqrt(numpy.sum(descriptor**2)) + op.norm_epsilon
+  return descriptor, wraps
+
+
+def test_descriptor_reference():
+  # compares the descriptors with the direct per-pixel evaluation, for keypoints at the image border and arbitrary orientations;
+  # when built with BOB_IP_BASE_AVX2=1, this compares the vectorized sample computation with the scalar arithmetic
+  numpy.random.seed(42)
+  shape = (48, 64)
+  args = (shape, 3, 2, 0, 0.5, 1.6)
+  border = bob.sp.BorderType.NearestNeighbour
+  op = bob.ip.base.SIFT(*args, contrast_thres=0.03, edge_thres=10., norm_thres=0.2, kernel_radius_factor=4., border=border)
+  gss = bob.ip.base.GaussianScaleSpace(*args, kernel_radius_factor=4., border=border)
+
+  image = numpy.random.random(shape) * 255.
+  pyramid = gss(image)
+  keypoints = [
+    bob.ip.base.GSSKeypoint(1.6, (0., 0.), 0.),
+    bob.ip.base.GSSKeypoint(1.6, (1.5, 30.2), -0.8),
+    bob.ip.base.GSSKeypoint(2.1, (24.3, 63.), -7.5),
+    bob.ip.base.GSSKeypoint(2.6, (47., 2.7), 2. * math.pi),
+    bob.ip.base.GSSKeypoint(2.1, (46.4, 62.9), 9.3),
+    bob.ip.base.GSSKeypoint(3.4, (20., 30.), 4. * math.pi + 0.25),
+  ]
+  # supports of increasing width, whose rows are not all a multiple of the vector size
+  keypoints += [bob.ip.base.GSSKeypoint(1.6 * 1.07**k, (23.7, 31.2), 0.3 * k) for k in range(8)]
+  descriptors = op.compute_descriptor(image, keypoints)
+  for keypoint, descriptor in zip(keypoints, descriptors):
+    reference, _ = _descriptor_reference(op, pyramid, keypoint)
+    assert numpy.allclose(descriptor, reference, rtol=0., atol=1e-12), "keypoint %s: max difference %g" % (keypoint.location, numpy.max(numpy.abs(descriptor - reference)))
+
+  # in a horizontal ramp, all gradients have orientation 0; with 10 bins, a keypoint orientation of one ulp above 0
+  # gives angles of one ulp below 2*pi, which fall into the first orientation bin 10, i.e., wrap around to bin 0
+  op.bins = 10
+  ramp = numpy.tile(numpy.cumsum(numpy.random.random(shape[1]) + 0.1), (shape[0], 1))
+  pyramid = gss(ramp)
+  keypoints = [
+    bob.ip.base.GSSKeypoint(1.6, (24., 32.), float(numpy.spacing(2. * math.pi))),
+    bob.ip.base.GSSKeypoint(2.1, (2., 62.), float(numpy.spacing(2. * math.pi))),
+  ]
+  descriptors = op.compute_descriptor(ramp, keypoints)
+  for keypoint, descriptor in zip(keypoints, descriptors):
+    reference, wraps = _descriptor_reference(op, pyramid, keypoint)
+    assert wraps > 0
+    assert numpy.allclose(descriptor, reference, rtol=0., atol=1e-12), "keypoint %s: max difference %g" % (keypoint.location, numpy.max(numpy.abs(descriptor - reference)))
+
+
+def test_shared_object():
+  # Python threads that share a SIFT object release the GIL, but do not compute in its cached pyramids at the same time
+  random = numpy.random.RandomState(11)
+  images = [random.randint(0, 256, (60, 80)).astype(numpy.float64) for i in range(4)]
+  keypoints = [bob.ip.base.GSSKeypoint(1.6 * 2.**(i/3.), (20.+3*i, 30.+4*i), 0.5*i) for i in range(6)]
+  op = bob.ip.base.SIFT((60, 80), 3, 3, 0)
+  references = [op.compute_descriptor(image, keypoints) for image in images]
+  results = [[] for image in images]
+  def compute(i):
+    for repetition in range(5):
+      results[i].append(op.compute_descriptor(images[i], keypoints))
+  threads = [threading.Thread(target=compute, args=(i,)) for i in range(len(images))]
+  for thread in threads: thread.start()
+  for thread in threads: thread.join()
+  for reference, result in zip(references, results):
+    nose.tools.eq_(len(result), 5)
+    for descriptors in result:
+      assert numpy.array_equal(descriptors, reference)
+
+
 def test_comparison():
   # Comparisons tests
   op1 = bob.ip.base.SIFT((200,250),3,4,-1,0.5,1.6,4.)
@@ -101,6 +234,7 @@ def test_comparison():
   op7 = bob.ip.base.SIFT((200,250),3,4,-1,0.75,1.6,4.)
   op8 = bob.ip.base.SIFT((200,250),3,4,-1,0.5,1.8,4.)
   op9 = bob.ip.base.SIFT((200,250),3,4,-1,0.5,1.6,3.)
+  op10 = bob.ip.base.SIFT((200,250),3,4,-1,0.5,1.6,4.,single_precision=True)
   assert op1 == op1
   assert op1 == op1b
   assert (op1 == op2) is False
@@ -111,6 +245,7 @@ def test_comparison():
   assert (op1 == op7) is False
   assert (op1 == op8) is False
   assert (op1 == op9) is False
+  assert (op1 == op10) is False
   assert (op1 != op1) is False
   assert (op1 != op1b) is False
   assert op1 != op2
@@ -121,3 +256,4 @@ def test_comparison():
   assert op1 != op7
   assert op1 != op8
   assert op1 != op9
+  assert op1 != op10
@@ -60,6 +60,37 @@ def test_processing():
   assert numpy.allclose(a_out2, a_sqi_ref, eps, eps)
 
 
+def test_scales():
+  # all scales share the extrapolated image, which is invisible in the output
+  image = numpy.random.RandomState(7).randint(0, 256, (30, 40)).astype(numpy.uint8)
+  op = bob.ip.base.SelfQuotientImage(3,1,2,1.)
+  reference = numpy.zeros(image.shape)
+  for s in range(3):
+    size = 1 + 2*s
+    weighted_gaussian = bob.ip.base.WeightedGaussian((float(size), float(size)), (size, size))
+    reference += numpy.log(image + 1.) - numpy.log(weighted_gaussian(image) + 1.)
+  reference /= 3.
+  output = op(image)
+  assert numpy.allclose(output, reference)
+  # the scales can be processed in parallel
+  assert numpy.array_equal(op(image, threads=4), output)
+
+
+def test_workspaces():
+  # the shared extrapolated image and the smoothed scales of the calling thread are reused for images of different sizes,
+  # which must not change any result
+  random = numpy.random.RandomState(3)
+  images = [random.randint(0, 256, shape).astype(numpy.float64) for shape in ((40, 50), (23, 31), (2, 3), (3, 23, 31))]
+  images.append(random.randint(0, 256, (17, 60)).astype(numpy.uint8))
+  op = bob.ip.base.SelfQuotientImage(3,1,2,1.)
+  first = [op(image) for image in images]
+  for image, reference in reversed(list(zip(images, first))):
+    assert numpy.array_equal(op(image), reference)
+    assert numpy.array_equal(op(image, threads=4), reference)
+  for plane, reference in zip(images[3], first[3]):
+    assert numpy.array_equal(op(plane), reference)
+
+
 def test_comparison():
   # Comparisons tests
   op1 = bob.ip.base.SelfQuotientImage(1,1,1,0.5)
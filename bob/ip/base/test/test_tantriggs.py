@@ -136,3 +136,51 @@ def test_comparison():
   assert op1 != op6
   assert op1 != op7
   assert op1 != op8
+
+
+def test_workspaces():
+  # the intermediate images and the Gaussian workspace of the calling thread are reused for images of different sizes,
+  # which must not change any result
+  random = numpy.random.RandomState(3)
+  images = [random.randint(0, 256, shape).astype(numpy.float64) for shape in ((40, 50), (23, 31), (2, 3))]
+  images.append(random.randint(0, 256, (17, 60)).astype(numpy.uint8))
+  for op in (bob.ip.base.TanTriggs(), bob.ip.base.TanTriggs(radius=5)):
+    first = [op(image) for image in images]
+    for image, reference in reversed(list(zip(images, first))):
+      assert numpy.array_equal(op(image), reference)
+
+
+def _tan_triggs_reference(image, tt, mode):
+  # gamma correction, full 2D convolution with the DoG kernel and contrast equalization, computed pixel by pixel
+  img = numpy.power(image.astype(numpy.float64), tt.gamma)
+  kernel = tt.kernel
+  r = tt.radius
+  padded = numpy.pad(img, r, mode)
+  dog = numpy.zeros(img.shape)
+  for i in range(kernel.shape[0]):
+    for j in range(kernel.shape[1]):
+      dog += kernel[i,j] * padded[i:i+img.shape[0], j:j+img.shape[1]]
+
+  dog /= numpy.mean(numpy.abs(dog) ** tt.alpha) ** (1. / tt.alpha)
+  dog /= numpy.mean(numpy.minimum(tt.threshold ** tt.alpha, numpy.abs(dog) ** tt.alpha)) ** (1. / tt.alpha)
+  return tt.threshold * numpy.tanh(dog / tt.threshold)
+
+
+def test_separable_dog():
+  # the separable DoG filter and the fused contrast equalization must give the result of the full 2D DoG kernel
+  numpy.random.seed(42)
+  image = (numpy.random.random((23,17)) * 255).astype(numpy.uint8)
+  # the Constant border type is handled as Mirror
+  modes = {
+    bob.sp.BorderType.Zero : 'constant',
+    bob.sp.BorderType.Constant : 'symmetric',
+    bob.sp.BorderType.NearestNeighbour : 'edge',
+    bob.sp.BorderType.Circular : 'wrap',
+    bob.sp.BorderType.Mirror : 'symmetric',
+  }
+  for border, mode in modes.items():
+    for radius in (2, 5):
+      tt = bob.ip.base.TanTriggs(0.2, 1., 2., radius, 10., 0.1, border)
+      processed = tt(image)
+      reference = _tan_triggs_reference(image, tt, mode)
+      assert numpy.allclose(processed, reference, rtol=0., atol=1e-10), "border %s, radius %d: max difference %g" % (border, radius, numpy.max(numpy.abs(processed - reference)))
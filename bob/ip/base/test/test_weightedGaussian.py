@@ -72,6 +72,27 @@ def test_image():
   reference = bob.io.base.load(bob.io.base.test_utils.datafile("image_WeightedGaussian.hdf5", "bob.ip.base", "data/filter")).astype(numpy.float64)
   assert numpy.allclose(processed, reference)
 
+  # bands of rows processed in parallel give the same result
+  assert numpy.array_equal(gaussian(image, threads=4), processed)
+
+
+def test_workspaces():
+  # the extrapolated and integral images of the calling thread are reused for images of different sizes,
+  # which must not change any result; the rows of dst are only written after src was extrapolated
+  random = numpy.random.RandomState(3)
+  images = [random.rand(*shape) for shape in ((40, 50), (23, 31), (2, 3), (3, 23, 31))]
+  images.append(random.randint(0, 256, (17, 60)).astype(numpy.uint8))
+  op = bob.ip.base.WeightedGaussian((1.5, 2.), (4, 6))
+  first = [op(image) for image in images]
+  for image, reference in reversed(list(zip(images, first))):
+    assert numpy.array_equal(op(image), reference)
+    assert numpy.array_equal(op(image, threads=3), reference)
+  for plane, reference in zip(images[3], first[3]):
+    assert numpy.array_equal(op(plane), reference)
+  in_place = images[0].copy()
+  op(in_place, in_place, threads=3)
+  assert numpy.array_equal(in_place, first[0])
+
 
 def test_comparison():
   # Comparisons tests
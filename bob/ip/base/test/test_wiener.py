@@ -97,6 +97,31 @@ def test_filter():
   assert numpy.allclose(sample_filtered4, sample_filtered_py)
 
 
+def test_filter_stack():
+  # a trained filter is symmetric, so that the half spectrum is filtered
+  training_set = numpy.random.randn(20, 5, 6)
+  m = bob.ip.base.Wiener(training_set, 0.5)
+
+  samples = numpy.random.randn(7, 5, 6)
+  filtered = m.filter(samples, threads = 3)
+  for sample, result in zip(samples, filtered):
+    sample_fft = bob.sp.fft(sample.astype(numpy.complex128))
+    assert numpy.allclose(result, numpy.absolute(bob.sp.ifft(sample_fft * m.w)))
+    assert numpy.allclose(result, m(sample))
+
+
+def test_workspaces():
+  # the FFT plans and spectra of the calling thread are reused by filters of different sizes,
+  # which must not change any result
+  random = numpy.random.RandomState(3)
+  filters = [bob.ip.base.Wiener(0.2 + numpy.fabs(random.randn(*shape)), 0.5) for shape in ((5, 6), (8, 3), (5, 6))]
+  samples = [random.randn(*m.w.shape) for m in filters]
+  for repetition in range(2):
+    for m, sample in zip(filters, samples):
+      sample_fft = bob.sp.fft(sample.astype(numpy.complex128))
+      assert numpy.allclose(m(sample), numpy.absolute(bob.sp.ifft(sample_fft * m.w)))
+
+
 def test_train():
 
   def train_wiener_ps(training_set):
@@ -138,3 +163,13 @@ def test_train():
 
   assert numpy.allclose(var_ps, m2.Ps)
 
+
+  # incremental training, with chunks of images given by a generator
+  m3 = bob.ip.base.Wiener((2,2), 0.5)
+  m3.train((training_set[i:i+3] for i in range(0, n_samples, 3)), threads = 2)
+  nose.tools.eq_(m3.size, (height, width))
+  assert numpy.allclose(var_ps, m3.Ps)
+
+  # ... and with a list of single images
+  m3.train(list(training_set))
+  assert numpy.allclose(var_ps, m3.Ps)
@@ -34,6 +34,10 @@ static PyObject* build_version_dictionary() {
 #if HAVE_VLFEAT
   if (!dict_steal(retval, "VLFeat", vlfeat_version())) return 0;
 #endif // HAVE_VLFEAT
+#ifdef __AVX2__
+  // the vectorized kernels are enabled with BOB_IP_BASE_AVX2=1 at build time
+  if (!dict_steal(retval, "AVX2", Py_BuildValue("s", "enabled"))) return 0;
+#endif // __AVX2__
 
   return Py_BuildValue("O", retval);
 }
@@ -0,0 +1,356 @@
+/**
+ * @author Manuel Guenther <manuel.guenther@idiap.ch>
+ * @date Fri Oct 16 10:12:45 CEST 2026
+ *
+ * @brief Binds the WarpMap class to python
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include "main.h"
+
+/******************************************************************/
+/************ Constructor Section *********************************/
+/******************************************************************/
+
+static auto WarpMap_doc = bob::extension::ClassDoc(
+  BOB_EXT_MODULE_PREFIX ".WarpMap",
+  "A precomputed geometric normalization, which can be applied to many images of the same size",
+  "For each pixel of the normalized image, the position of the source pixels and their (fixed-point) bi-linear interpolation weights are computed once, at construction time. "
+  "Applying the map is then a pure look-up, which makes it much faster than :py:meth:`GeomNorm.process` or :py:meth:`FaceEyesNorm.extract`, "
+  "when the same normalization is applied to several images, e.g., to all frames of a video with a fixed face location.\n\n"
+  ".. note::\n\n  The source positions are identical to the ones of :py:class:`GeomNorm`. "
+  "Due to the fixed-point weights, the results might differ by up to :math:`2^{-15}` times the range of the image values."
+).add_constructor(
+  bob::extension::FunctionDoc(
+    "__init__",
+    "Constructs a WarpMap object for the given geometric normalization and images of the given shape",
+    0,
+    true
+  )
+  .add_prototype("geom_norm, source_shape, center", "")
+  .add_prototype("face_eyes_norm, source_shape, right_eye, left_eye", "")
+  .add_prototype("other", "")
+  .add_parameter("geom_norm", ":py:class:`GeomNorm`", "The geometric normalization to precompute")
+  .add_parameter("face_eyes_norm", ":py:class:`FaceEyesNorm`", "The face normalization to precompute")
+  .add_parameter("source_shape", "(int, int)", "The shape of the (2D) images that the map will be applied to")
+  .add_parameter("center", "(float, float)", "The transformation center in the source images, see :py:meth:`GeomNorm.process`")
+  .add_parameter("right_eye", "(float, float)", "The location of the right eye in the source images, see :py:meth:`FaceEyesNorm.extract`")
+  .add_parameter("left_eye", "(float, float)", "The location of the left eye in the source images, see :py:meth:`FaceEyesNorm.extract`")
+  .add_parameter("other", ":py:class:`WarpMap`", "Another WarpMap object to copy")
+);
+
+
+static int PyBobIpBaseWarpMap_init(PyBobIpBaseWarpMapObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist1 = WarpMap_doc.kwlist(0);
+  char** kwlist2 = WarpMap_doc.kwlist(1);
+  char** kwlist3 = WarpMap_doc.kwlist(2);
+
+  // get the number of command line arguments
+  Py_ssize_t nargs = (args?PyTuple_Size(args):0) + (kwargs?PyDict_Size(kwargs):0);
+
+  switch (nargs){
+    case 1:{
+      // copy constructor
+      PyBobIpBaseWarpMapObject* warpMap;
+      if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!", kwlist3, &PyBobIpBaseWarpMap_Type, &warpMap)){
+        WarpMap_doc.print_usage();
+        return -1;
+      }
+      self->cxx.reset(new bob::ip::base::WarpMap(*warpMap->cxx));
+      return 0;
+    } // nargs == 1
+    case 3:{
+      // with GeomNorm
+      PyBobIpBaseGeomNormObject* geomNorm;
+      blitz::TinyVector<int,2> shape;
+      blitz::TinyVector<double,2> center;
+      if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!(ii)(dd)", kwlist1, &PyBobIpBaseGeomNorm_Type, &geomNorm, &shape[0], &shape[1], &center[0], &center[1])){
+        WarpMap_doc.print_usage();
+        return -1;
+      }
+      self->cxx.reset(new bob::ip::base::WarpMap(*geomNorm->cxx, shape, center));
+      return 0;
+    }
+    case 4:{
+      // with FaceEyesNorm
+      PyBobIpBaseFaceEyesNormObject* faceEyesNorm;
+      blitz::TinyVector<int,2> shape;
+      blitz::TinyVector<double,2> right, left;
+      if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!(ii)(dd)(dd)", kwlist2, &PyBobIpBaseFaceEyesNorm_Type, &faceEyesNorm, &shape[0], &shape[1], &right[0], &right[1], &left[0], &left[1])){
+        WarpMap_doc.print_usage();
+        return -1;
+      }
+      self->cxx.reset(new bob::ip::base::WarpMap(*faceEyesNorm->cxx, shape, right, left));
+      return 0;
+    }
+    default:
+      // unknown
+      WarpMap_doc.print_usage();
+      PyErr_Format(PyExc_TypeError, "`%s' got an unsupported number of parameters", Py_TYPE(self)->tp_name);
+      return -1;
+  }
+
+  BOB_CATCH_MEMBER("cannot create WarpMap object", -1)
+}
+
+static void PyBobIpBaseWarpMap_delete(PyBobIpBaseWarpMapObject* self) {
+  self->cxx.reset();
+  Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+int PyBobIpBaseWarpMap_Check(PyObject* o) {
+  return PyObject_IsInstance(o, reinterpret_cast<PyObject*>(&PyBobIpBaseWarpMap_Type));
+}
+
+static PyObject* PyBobIpBaseWarpMap_RichCompare(PyBobIpBaseWarpMapObject* self, PyObject* other, int op) {
+  BOB_TRY
+
+  if (!PyBobIpBaseWarpMap_Check(other)) {
+    PyErr_Format(PyExc_TypeError, "cannot compare `%s' with `%s'", Py_TYPE(self)->tp_name, Py_TYPE(other)->tp_name);
+    return 0;
+  }
+  auto other_ = reinterpret_cast<PyBobIpBaseWarpMapObject*>(other);
+  switch (op) {
+    case Py_EQ:
+      if (*self->cxx==*other_->cxx) Py_RETURN_TRUE; else Py_RETURN_FALSE;
+    case Py_NE:
+      if (*self->cxx==*other_->cxx) Py_RETURN_FALSE; else Py_RETURN_TRUE;
+    default:
+      Py_INCREF(Py_NotImplemented);
+      return Py_NotImplemented;
+  }
+  BOB_CATCH_MEMBER("cannot compare WarpMap objects", 0)
+}
+
+
+/******************************************************************/
+/************ Variables Section ***********************************/
+/******************************************************************/
+
+static auto sourceShape = bob::extension::VariableDoc(
+  "source_shape",
+  "(int, int)",
+  "The shape of the images that this map can be applied to, read access only"
+);
+PyObject* PyBobIpBaseWarpMap_getSourceShape(PyBobIpBaseWarpMapObject* self, void*){
+  BOB_TRY
+  auto r = self->cxx->getSourceShape();
+  return Py_BuildValue("(ii)", r[0], r[1]);
+  BOB_CATCH_MEMBER("source_shape could not be read", 0)
+}
+
+static auto targetShape = bob::extension::VariableDoc(
+  "target_shape",
+  "(int, int)",
+  "The shape of the normalized images, read access only"
+);
+PyObject* PyBobIpBaseWarpMap_getTargetShape(PyBobIpBaseWarpMapObject* self, void*){
+  BOB_TRY
+  auto r = self->cxx->getTargetShape();
+  return Py_BuildValue("(ii)", r[0], r[1]);
+  BOB_CATCH_MEMBER("target_shape could not be read", 0)
+}
+
+static PyGetSetDef PyBobIpBaseWarpMap_getseters[] = {
+    {
+      sourceShape.name(),
+      (getter)PyBobIpBaseWarpMap_getSourceShape,
+      0,
+      sourceShape.doc(),
+      0
+    },
+    {
+      targetShape.name(),
+      (getter)PyBobIpBaseWarpMap_getTargetShape,
+      0,
+      targetShape.doc(),
+      0
+    },
+    {0}  /* Sentinel */
+};
+
+
+/******************************************************************/
+/************ Functions Section ***********************************/
+/******************************************************************/
+
+static auto remap = bob::extension::FunctionDoc(
+  "remap",
+  "Applies the precomputed geometric normalization to the given image(s)",
+  "A 3D ``input`` is interpreted as a stack of images of shape :py:attr:`source_shape`, e.g., the frames of a video or the color planes of a color image, which are all normalized with the same map. "
+  "In this case, the masks are 2D and shared by all images.\n\n"
+  ".. note::\n\n  The `__call__` function is an alias for this method.",
+  true
+)
+.add_prototype("input, [output]", "output")
+.add_prototype("input, input_mask, output, output_mask")
+.add_parameter("input", "array_like (2D or 3D)", "The input image(s) of shape :py:attr:`source_shape`")
+.add_parameter("input_mask", "array_like (bool, 2D)", "An input mask of valid pixels, must be of shape :py:attr:`source_shape`")
+.add_parameter("output", "array_like (2D or 3D, float)", "The output image(s) of shape :py:attr:`target_shape`; if not given, it will be generated")
+.add_parameter("output_mask", "array_like (bool, 2D)", "The output mask of valid pixels after geometric normalization, must be of shape :py:attr:`target_shape`")
+.add_return("output", "array_like (2D or 3D, float)", "The resulting normalized image(s), same as ``output`` if given")
+;
+
+template <typename T, int N>
+static PyObject* remap_inner(PyBobIpBaseWarpMapObject* self, PyBlitzArrayObject* input, PyBlitzArrayObject* input_mask, PyBlitzArrayObject* output, PyBlitzArrayObject* output_mask){
+  if (input_mask && output_mask){
+    self->cxx->remap(*PyBlitzArrayCxx_AsBlitz<T,N>(input), *PyBlitzArrayCxx_AsBlitz<bool,2>(input_mask), *PyBlitzArrayCxx_AsBlitz<double,N>(output), *PyBlitzArrayCxx_AsBlitz<bool,2>(output_mask));
+    Py_RETURN_NONE;
+  }
+  self->cxx->remap(*PyBlitzArrayCxx_AsBlitz<T,N>(input), *PyBlitzArrayCxx_AsBlitz<double,N>(output));
+  return PyBlitzArray_AsNumpyArray(output, 0);
+}
+
+template <typename T>
+static PyObject* remap_inner1(PyBobIpBaseWarpMapObject* self, PyBlitzArrayObject* input, PyBlitzArrayObject* input_mask, PyBlitzArrayObject* output, PyBlitzArrayObject* output_mask){
+  switch (input->ndim){
+    case 2: return remap_inner<T,2>(self, input, input_mask, output, output_mask);
+    case 3: return remap_inner<T,3>(self, input, input_mask, output, output_mask);
+    default: return 0;// already handled
+  }
+}
+
+static PyObject* PyBobIpBaseWarpMap_remap(PyBobIpBaseWarpMapObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+  char** kwlist1 = remap.kwlist(0);
+  char** kwlist2 = remap.kwlist(1);
+
+  // get the number of command line arguments
+  Py_ssize_t nargs = (args?PyTuple_Size(args):0) + (kwargs?PyDict_Size(kwargs):0);
+
+  PyBlitzArrayObject* input = 0,* input_mask = 0,* output = 0,* output_mask = 0;
+
+  switch (nargs){
+    case 1:
+    case 2:{
+      if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|O&", kwlist1, &PyBlitzArray_Converter, &input, &PyBlitzArray_OutputConverter, &output)){
+        remap.print_usage();
+        return 0;
+      }
+      break;
+    }
+    case 4:{
+      // with mask
+      if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&O&O&O&", kwlist2, &PyBlitzArray_Converter, &input, &PyBlitzArray_Converter, &input_mask, &PyBlitzArray_OutputConverter, &output, &PyBlitzArray_OutputConverter, &output_mask)){
+        remap.print_usage();
+        return 0;
+      }
+      break;
+    }
+    default:{
+      remap.print_usage();
+      PyErr_Format(PyExc_TypeError, "`%s' remap called with wrong number of parameters", Py_TYPE(self)->tp_name);
+      return 0;
+    }
+  } // switch
+
+  auto input_ = make_safe(input);
+  auto output_ = make_xsafe(output);
+  auto input_mask_ = make_xsafe(input_mask), output_mask_ = make_xsafe(output_mask);
+
+  // perform checks on input and output image
+  if (input->ndim != 2 && input->ndim != 3){
+    PyErr_Format(PyExc_TypeError, "`%s' only processes 2D or 3D arrays", Py_TYPE(self)->tp_name);
+    remap.print_usage();
+    return 0;
+  }
+
+  if (output){
+    if (output->ndim != input->ndim){
+      PyErr_Format(PyExc_TypeError, "`%s' processes only input and output arrays with the same number of dimensions", Py_TYPE(self)->tp_name);
+      remap.print_usage();
+      return 0;
+    }
+    if (output->type_num != NPY_FLOAT64){
+      PyErr_Format(PyExc_TypeError, "`%s' processes only output arrays of type float", Py_TYPE(self)->tp_name);
+      remap.print_usage();
+      return 0;
+    }
+  } else {
+    // create output in the target shape
+    auto shape = self->cxx->getTargetShape();
+    if (input->ndim == 2){
+      Py_ssize_t n[] = {shape[0], shape[1]};
+      output = reinterpret_cast<PyBlitzArrayObject*>(PyBlitzArray_SimpleNew(NPY_FLOAT64, 2, n));
+    } else {
+      Py_ssize_t n[] = {input->shape[0], shape[0], shape[1]};
+      output = reinterpret_cast<PyBlitzArrayObject*>(PyBlitzArray_SimpleNew(NPY_FLOAT64, 3, n));
+    }
+    output_ = make_safe(output);
+  }
+
+  if (input_mask && output_mask){
+    if (input_mask->ndim != 2 || output_mask->ndim != 2){
+      PyErr_Format(PyExc_TypeError, "`%s' masks must be 2D", Py_TYPE(self)->tp_name);
+      remap.print_usage();
+      return 0;
+    }
+    if (input_mask->type_num != NPY_BOOL || output_mask->type_num != NPY_BOOL){
+      PyErr_Format(PyExc_TypeError, "`%s' masks must be of boolean type", Py_TYPE(self)->tp_name);
+      remap.print_usage();
+      return 0;
+    }
+  }
+
+  // finally, process the data
+  switch (input->type_num){
+    case NPY_UINT8:   return remap_inner1<uint8_t>(self, input, input_mask, output, output_mask);
+    case NPY_UINT16:  return remap_inner1<uint16_t>(self, input, input_mask, output, output_mask);
+    case NPY_FLOAT64: return remap_inner1<double>(self, input, input_mask, output, output_mask);
+    default:
+      PyErr_Format(PyExc_TypeError, "`%s' input array of type %s are currently not supported", Py_TYPE(self)->tp_name, PyBlitzArray_TypenumAsString(input->type_num));
+      remap.print_usage();
+      return 0;
+  }
+
+  BOB_CATCH_MEMBER("cannot remap image", 0)
+}
+
+static PyMethodDef PyBobIpBaseWarpMap_methods[] = {
+  {
+    remap.name(),
+    (PyCFunction)PyBobIpBaseWarpMap_remap,
+    METH_VARARGS|METH_KEYWORDS,
+    remap.doc()
+  },
+  {0} /* Sentinel */
+};
+
+
+/******************************************************************/
+/************ Module Section **************************************/
+/******************************************************************/
+
+// Define the WarpMap type struct; will be initialized later
+PyTypeObject PyBobIpBaseWarpMap_Type = {
+  PyVarObject_HEAD_INIT(0,0)
+  0
+};
+
+bool init_BobIpBaseWarpMap(PyObject* module)
+{
+  // initialize the type struct
+  PyBobIpBaseWarpMap_Type.tp_name = WarpMap_doc.name();
+  PyBobIpBaseWarpMap_Type.tp_basicsize = sizeof(PyBobIpBaseWarpMapObject);
+  PyBobIpBaseWarpMap_Type.tp_flags = Py_TPFLAGS_DEFAULT;
+  PyBobIpBaseWarpMap_Type.tp_doc = WarpMap_doc.doc();
+
+  // set the functions
+  PyBobIpBaseWarpMap_Type.tp_new = PyType_GenericNew;
+  PyBobIpBaseWarpMap_Type.tp_init = reinterpret_cast<initproc>(PyBobIpBaseWarpMap_init);
+  PyBobIpBaseWarpMap_Type.tp_dealloc = reinterpret_cast<destructor>(PyBobIpBaseWarpMap_delete);
+  PyBobIpBaseWarpMap_Type.tp_richcompare = reinterpret_cast<richcmpfunc>(PyBobIpBaseWarpMap_RichCompare);
+  PyBobIpBaseWarpMap_Type.tp_methods = PyBobIpBaseWarpMap_methods;
+  PyBobIpBaseWarpMap_Type.tp_getset = PyBobIpBaseWarpMap_getseters;
+  PyBobIpBaseWarpMap_Type.tp_call = reinterpret_cast<ternaryfunc>(PyBobIpBaseWarpMap_remap);
+
+  // check that everything is fine
+  if (PyType_Ready(&PyBobIpBaseWarpMap_Type) < 0) return false;
+
+  // add the type to the module
+  Py_INCREF(&PyBobIpBaseWarpMap_Type);
+  return PyModule_AddObject(module, "WarpMap", (PyObject*)&PyBobIpBaseWarpMap_Type) >= 0;
+}
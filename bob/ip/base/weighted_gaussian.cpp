@@ -208,15 +208,16 @@ static auto filter = bob::extension::FunctionDoc(
   ".. note::\n\n  The `__call__` function is an alias for this method.",
   true
 )
-.add_prototype("src, [dst]", "dst")
+.add_prototype("src, [dst], [threads]", "dst")
 .add_parameter("src", "array_like (2D)", "The input image which should be smoothed")
 .add_parameter("dst", "array_like (2D, float)", "[default: ``None``] If given, the output will be saved into this image; must be of the same shape as ``src``")
+.add_parameter("threads", "int", "[default: 1] The number of threads that process bands of image rows; ``0`` uses one thread per CPU core")
 .add_return("dst", "array_like (2D, float)", "The resulting output image, which is the same as ``dst`` (if given)")
 ;
 
 template <typename T, int D>
-static PyObject* filter_inner(PyBobIpBaseWeightedGaussianObject* self, PyBlitzArrayObject* input, PyBlitzArrayObject* output){
-  self->cxx->filter(*PyBlitzArrayCxx_AsBlitz<T,D>(input), *PyBlitzArrayCxx_AsBlitz<double,D>(output));
+static PyObject* filter_inner(PyBobIpBaseWeightedGaussianObject* self, PyBlitzArrayObject* input, PyBlitzArrayObject* output, int threads){
+  self->cxx->filter(*PyBlitzArrayCxx_AsBlitz<T,D>(input), *PyBlitzArrayCxx_AsBlitz<double,D>(output), threads);
   return PyBlitzArray_AsNumpyArray(output, 0);
 }
 
@@ -225,8 +226,9 @@ static PyObject* PyBobIpBaseWeightedGaussian_filter(PyBobIpBaseWeightedGaussianO
   char** kwlist = filter.kwlist();
 
   PyBlitzArrayObject* src,* dst = 0;
+  int threads = 1;
 
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|O&", kwlist, &PyBlitzArray_Converter, &src, &PyBlitzArray_OutputConverter, &dst)) return 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|O&i", kwlist, &PyBlitzArray_Converter, &src, &PyBlitzArray_OutputConverter, &dst, &threads)) return 0;
 
   auto src_ = make_safe(src), dst_ = make_xsafe(dst);
 
@@ -256,9 +258,9 @@ static PyObject* PyBobIpBaseWeightedGaussian_filter(PyBobIpBaseWeightedGaussianO
 
   // finally, extract the features
   switch (src->type_num){
-    case NPY_UINT8:   if (src->ndim == 2) return filter_inner<uint8_t,2>(self, src, dst);  else return filter_inner<uint8_t,3>(self, src, dst);
-    case NPY_UINT16:  if (src->ndim == 2) return filter_inner<uint16_t,2>(self, src, dst); else return filter_inner<uint16_t,3>(self, src, dst);
-    case NPY_FLOAT64: if (src->ndim == 2) return filter_inner<double,2>(self, src, dst);   else return filter_inner<double,3>(self, src, dst);
+    case NPY_UINT8:   if (src->ndim == 2) return filter_inner<uint8_t,2>(self, src, dst, threads);  else return filter_inner<uint8_t,3>(self, src, dst, threads);
+    case NPY_UINT16:  if (src->ndim == 2) return filter_inner<uint16_t,2>(self, src, dst, threads); else return filter_inner<uint16_t,3>(self, src, dst, threads);
+    case NPY_FLOAT64: if (src->ndim == 2) return filter_inner<double,2>(self, src, dst, threads);   else return filter_inner<double,3>(self, src, dst, threads);
     default:
       filter.print_usage();
       PyErr_Format(PyExc_TypeError, "`%s' processes only images of types uint8, uint16 or float, and not from %s", Py_TYPE(self)->tp_name, PyBlitzArray_TypenumAsString(src->type_num));
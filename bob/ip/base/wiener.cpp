@@ -296,14 +296,16 @@ static PyGetSetDef PyBobIpBaseWiener_getseters[] = {
 static auto filter = bob::extension::FunctionDoc(
   "filter",
   "Filters the input image",
-  "If given, the dst array should have the expected type (numpy.float64) and the same size as the src array.\n\n"
+  "If given, the dst array should have the expected type (numpy.float64) and the same size as the src array. "
+  "A 3D ``src`` array is processed as a stack of images, which are distributed over the given number of ``threads``.\n\n"
   ".. note::\n\n  The `__call__` function is an alias for this method.",
   true
 )
-.add_prototype("src, [dst]", "dst")
-.add_parameter("src", "array_like (2D)", "The input image which should be smoothed")
-.add_parameter("dst", "array_like (2D, float)", "[default: ``None``] If given, the output will be saved into this image; must be of the same shape as ``src``")
-.add_return("dst", "array_like (2D, float)", "The resulting output image, which is the same as ``dst`` (if given)")
+.add_prototype("src, [dst], [threads]", "dst")
+.add_parameter("src", "array_like (2D or 3D)", "The input image (or stack of images) which should be smoothed")
+.add_parameter("dst", "array_like (2D or 3D, float)", "[default: ``None``] If given, the output will be saved into this image; must be of the same shape as ``src``")
+.add_parameter("threads", "int", "[default: 1] The number of threads to use for a stack of images; ``0`` uses one thread per CPU core")
+.add_return("dst", "array_like (2D or 3D, float)", "The resulting output image, which is the same as ``dst`` (if given)")
 ;
 
 static PyObject* PyBobIpBaseWiener_filter(PyBobIpBaseWienerObject* self, PyObject* args, PyObject* kwargs) {
@@ -311,13 +313,14 @@ static PyObject* PyBobIpBaseWiener_filter(PyBobIpBaseWienerObject* self, PyObjec
   char** kwlist = filter.kwlist();
 
   PyBlitzArrayObject* src,* dst = 0;
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|O&", kwlist, &PyBlitzArray_Converter, &src, &PyBlitzArray_OutputConverter, &dst)) return 0;
+  int threads = 1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|O&i", kwlist, &PyBlitzArray_Converter, &src, &PyBlitzArray_OutputConverter, &dst, &threads)) return 0;
 
   auto src_ = make_safe(src), dst_ = make_xsafe(dst);
 
   // perform checks on input and output image
-  if (src->ndim != 2){
-    PyErr_Format(PyExc_TypeError, "`%s' only processes 2D arrays", Py_TYPE(self)->tp_name);
+  if (src->ndim != 2 && src->ndim != 3){
+    PyErr_Format(PyExc_TypeError, "`%s' only processes 2D or 3D arrays", Py_TYPE(self)->tp_name);
     filter.print_usage();
     return 0;
   }
@@ -339,8 +342,11 @@ static PyObject* PyBobIpBaseWiener_filter(PyBobIpBaseWienerObject* self, PyObjec
     dst_ = make_safe(dst);
   }
 
-  // finally, filter the given image
-  self->cxx->filter(*PyBlitzArrayCxx_AsBlitz<double,2>(src), *PyBlitzArrayCxx_AsBlitz<double,2>(dst));
+  // finally, filter the given image(s)
+  if (src->ndim == 2)
+    self->cxx->filter(*PyBlitzArrayCxx_AsBlitz<double,2>(src), *PyBlitzArrayCxx_AsBlitz<double,2>(dst));
+  else
+    self->cxx->filter(*PyBlitzArrayCxx_AsBlitz<double,3>(src), *PyBlitzArrayCxx_AsBlitz<double,3>(dst), threads);
 
   // and return the result
   return Py_BuildValue("O", dst);
@@ -348,6 +354,78 @@ static PyObject* PyBobIpBaseWiener_filter(PyBobIpBaseWienerObject* self, PyObjec
   BOB_CATCH_MEMBER("cannot perform Wiener filtering in image", 0)
 }
 
+static auto train = bob::extension::FunctionDoc(
+  "train",
+  "Trains the Wiener filter with the given training images",
+  "The training images can be given as a 3D stack, or as a list, tuple, iterator or generator of 2D images and/or 3D stacks of images, e.g., reading chunks of images from an HDF5 file. "
+  "The mean and the variance of the absolute FFT of the images are accumulated image by image (using Welford's algorithm), so that the memory does not depend on the number of training images. "
+  "The images of each 3D stack are distributed over the given number of ``threads``; the accumulated statistics of all threads are merged afterwards.\n\n"
+  "The size of the filter is set to the size of the training images, and ``Ps`` is set to the variance of the absolute FFT.",
+  true
+)
+.add_prototype("data, [threads]")
+.add_parameter("data", "array_like (3D, float) or iterable of array_like (2D or 3D, float)", "The training images")
+.add_parameter("threads", "int", "[default: 1] The number of threads to use; ``0`` uses one thread per CPU core")
+;
+
+// adds the given training image(s) to the trainer, which is created for the first training image
+static bool _add_training_data(PyBobIpBaseWienerObject* self, boost::shared_ptr<bob::ip::base::WienerTrainer>& trainer, PyObject* data, const int threads){
+  PyBlitzArrayObject* array;
+  if (!PyBlitzArray_Converter(data, &array)) return false;
+  auto array_ = make_safe(array);
+
+  if (array->type_num != NPY_FLOAT64 || (array->ndim != 2 && array->ndim != 3)){
+    PyErr_Format(PyExc_TypeError, "`%s' train requires training images as 2D or 3D arrays of type float, but got a %dD array of type %s", Py_TYPE(self)->tp_name, (int)array->ndim, PyBlitzArray_TypenumAsString(array->type_num));
+    return false;
+  }
+
+  if (!trainer)
+    trainer.reset(new bob::ip::base::WienerTrainer(blitz::TinyVector<int,2>(array->shape[array->ndim-2], array->shape[array->ndim-1])));
+
+  if (array->ndim == 2)
+    trainer->add(*PyBlitzArrayCxx_AsBlitz<double,2>(array));
+  else
+    trainer->add(*PyBlitzArrayCxx_AsBlitz<double,3>(array), threads);
+  return true;
+}
+
+static PyObject* PyBobIpBaseWiener_train(PyBobIpBaseWienerObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+  char** kwlist = train.kwlist();
+
+  PyObject* data;
+  int threads = 1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|i", kwlist, &data, &threads)){
+    train.print_usage();
+    return 0;
+  }
+
+  boost::shared_ptr<bob::ip::base::WienerTrainer> trainer;
+  if (PyList_Check(data) || PyTuple_Check(data) || PyIter_Check(data)){
+    // accumulate the training images one item at a time
+    PyObject* iterator = PyObject_GetIter(data);
+    if (!iterator) return 0;
+    auto iterator_ = make_safe(iterator);
+    while (PyObject* item = PyIter_Next(iterator)){
+      auto item_ = make_safe(item);
+      if (!_add_training_data(self, trainer, item, threads)) return 0;
+    }
+    if (PyErr_Occurred()) return 0;
+  } else {
+    if (!_add_training_data(self, trainer, data, threads)) return 0;
+  }
+
+  if (!trainer || !trainer->getCount()){
+    PyErr_Format(PyExc_ValueError, "`%s' train requires at least one training image", Py_TYPE(self)->tp_name);
+    return 0;
+  }
+
+  self->cxx->train(*trainer);
+  Py_RETURN_NONE;
+
+  BOB_CATCH_MEMBER("cannot train the Wiener filter", 0)
+}
+
 static auto load = bob::extension::FunctionDoc(
   "load",
   "Loads the configuration of the Wiener filter from the given HDF5 file",
@@ -442,6 +520,12 @@ static PyMethodDef PyBobIpBaseWiener_methods[] = {
     METH_VARARGS|METH_KEYWORDS,
     filter.doc()
   },
+  {
+    train.name(),
+    (PyCFunction)PyBobIpBaseWiener_train,
+    METH_VARARGS|METH_KEYWORDS,
+    train.doc()
+  },
   {
     load.name(),
     (PyCFunction)PyBobIpBaseWiener_load,
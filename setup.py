@@ -79,6 +79,11 @@ vl_pkg = vl()
 
 system_include_dirs = vl_pkg.include_directories
 
+# The vectorized kernels (e.g., of the bi-linear interpolation in Affine.h) are only compiled on request,
+# since the resulting binaries do not run on CPUs without AVX2 support.
+# Set the environment variable BOB_IP_BASE_AVX2=1 to enable them.
+simd_flags = ['-mavx2'] if os.environ.get('BOB_IP_BASE_AVX2', '0') not in ('', '0') else []
+
 
 setup(
 
@@ -110,12 +115,14 @@ setup(
         packages = packages,
         boost_modules = boost_modules,
         version = version,
+        extra_compile_args = simd_flags,
       ),
 
       Library("bob.ip.base.bob_ip_base",
         [
           "bob/ip/base/cpp/GeomNorm.cpp",
           "bob/ip/base/cpp/FaceEyesNorm.cpp",
+          "bob/ip/base/cpp/WarpMap.cpp",
           "bob/ip/base/cpp/Affine.cpp",
           "bob/ip/base/cpp/LBP.cpp",
           "bob/ip/base/cpp/LBPTop.cpp",
@@ -139,6 +146,7 @@ setup(
         library_dirs = vl_pkg.library_directories,
         libraries = vl_pkg.libraries,
         define_macros = vl_pkg.macros,
+        extra_compile_args = simd_flags,
       ),
 
       Extension("bob.ip.base._library",
@@ -146,6 +154,7 @@ setup(
           "bob/ip/base/auxiliary.cpp",
           "bob/ip/base/geom_norm.cpp",
           "bob/ip/base/face_eyes_norm.cpp",
+          "bob/ip/base/warp_map.cpp",
           "bob/ip/base/affine.cpp",
           "bob/ip/base/lbp.cpp",
           "bob/ip/base/lbp_top.cpp",
@@ -172,6 +181,7 @@ setup(
         library_dirs = vl_pkg.library_directories,
         libraries = vl_pkg.libraries,
         define_macros = vl_pkg.macros,
+        extra_compile_args = simd_flags,
       ),
     ],
 